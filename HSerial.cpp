@@ -89,7 +89,7 @@ namespace hserial {
         return _isLockedActive;
     }
 
-    void HSerial::makeActive() {
+    void HSerial::makeActive(int priority) {
         // todo: review these comments for up-to-dateness and transfer to documentation
         //  ---------------------------------------------------------------------------------------
         // | Before            | After              | Analysis
@@ -118,7 +118,22 @@ namespace hserial {
         //  ---------------------------------------------------------------------------------------
         AccessManagementGuard guard(*this);
         setIsLockedActive = false;
-        HSerialController::makeActive();
+        HSerialController::makeActive(priority);
+    }
+
+    bool HSerial::makeActive(const std::chrono::steady_clock::time_point& deadline, int priority) {
+        // The analysis for makeActive applies. If the deadline passes nothing happens.
+        AccessManagementGuard guard(*this);
+        setIsLockedActive = false;
+        return HSerialController::makeActive(deadline, priority);
+    }
+
+    bool HSerial::tryMakeActive(int priority) {
+        return makeActive(std::chrono::steady_clock::now(), priority);
+    }
+
+    bool HSerial::makeActiveFor(const std::chrono::milliseconds& timeout, int priority) {
+        return makeActive(std::chrono::steady_clock::now() + timeout, priority);
     }
 
     void HSerial::makeInactive() {
@@ -177,7 +192,31 @@ namespace hserial {
         HSerialController::makeInactive();
     }
 
-    void HSerial::makeLockedActive() {
+    void HSerial::park() {
+        // isLocked only changes in guarded functions and in transition callbacks, and there is no
+        //  transition that could make this controller active or locked while the guard is held.
+        //  So an unlocked controller stays unlocked, and the deferred transition's
+        //  willMakeInactive won't refuse. A reclaim doesn't call didMakeActive, but none is
+        //  needed since isLocked and _isLockedActive are already false (or are set by
+        //  makeLockedActive itself).
+        AccessManagementGuard guard(*this);
+        bool isLockedNow;
+        {
+            std::lock_guard<std::mutex> lock(isLockedMutex);
+            isLockedNow = isLocked;
+        }
+        if (isLockedNow) {
+            HSerialController::makeInactive();
+        } else {
+            HSerialController::park();
+        }
+    }
+
+    void HSerial::makeLockedActive(int priority) {
+        makeLockedActive(std::chrono::steady_clock::time_point::max(), priority);
+    }
+
+    bool HSerial::makeLockedActive(const std::chrono::steady_clock::time_point& deadline, int priority) {
 
         // See the documentation for extensive analysis of this code's logic.
 
@@ -191,9 +230,10 @@ namespace hserial {
             isLocked = true;
         }
 
+        bool wasMadeActive;
         try {
             // Make Active Request
-            HSerialController::makeActive();
+            wasMadeActive = HSerialController::makeActive(deadline, priority);
         } catch (...) {
             // Request Failure
             if (!HSerialController::isActive()) {
@@ -203,11 +243,30 @@ namespace hserial {
             throw;
         }
 
+        if (!wasMadeActive) {
+            // Deadline Passed
+            // No controller change happened, so the tentative lock is undone. _isLockedActive
+            //  still tells whether the controller was locked active before the request (only this
+            //  class changes it while the controller is active, and the guard excludes that).
+            std::lock_guard<std::mutex> lock(isLockedMutex);
+            isLocked = _isLockedActive;
+            return false;
+        }
+
         // Post-Request
         {
             std::lock_guard<std::mutex> lock(isLockedMutex);
             _isLockedActive = true;
         }
+        return true;
+    }
+
+    bool HSerial::tryMakeLockedActive(int priority) {
+        return makeLockedActive(std::chrono::steady_clock::now(), priority);
+    }
+
+    bool HSerial::makeLockedActiveFor(const std::chrono::milliseconds& timeout, int priority) {
+        return makeLockedActive(std::chrono::steady_clock::now() + timeout, priority);
     }
 
     void HSerial::unlockActive() {
@@ -230,6 +289,13 @@ namespace hserial {
         _isLockedActive = false;
     }
 
+    bool HSerial::yieldIfRequested() {
+        // The analysis for makeInactive applies: the change is initiated by this controller, so
+        //  willMakeInactive ignores isLocked, and didMakeInactive unlocks.
+        AccessManagementGuard guard(*this);
+        return HSerialController::yieldIfRequested();
+    }
+
     void HSerial::removeFromAccess() {
         // todo: review these comments for up-to-dateness and transfer to documentation
         // The analysis is the same as for makeInactive. The only differences in behavior would
@@ -323,6 +389,12 @@ namespace hserial {
         isLockedMutex.unlock();
     }
 
+    bool HSerial::canSkipActivation() const noexcept {
+        // A locked activation can't be skipped, since the controller must be locked active if
+        //  makeLockedActive returns. setIsLockedActive was set by the calling (guarded) function.
+        return !setIsLockedActive;
+    }
+
 
 #pragma mark - Miscellaneous
 
@@ -119,12 +119,43 @@ namespace hserial {
          
          Calling code should always catch ControllerRefuses.
 
+         \param priority Determines when the change goes if other controller changes are waiting
+         for the port (see hserial::priority).
          \throws hserial::ControllerRefuses Thrown if the current controller (or any controller
          delegated to by the current controller) refuses to give up the active role. In this case
          the controller is not active.
          \see makeLockedActive
          */
-        void makeActive();
+        void makeActive(int priority = priority::normal);
+
+        /*!
+         \brief Makes the controller active if it is not already, unless that means waiting past
+         `deadline` for other controller changes on the port.
+
+         Once the change starts it runs to completion.
+
+         \returns `false` if the deadline passed before the change could start. Nothing is done
+         in that case.
+         \throws (the exceptions of makeActive)
+         \see tryMakeActive, makeActiveFor
+         */
+        bool makeActive(const std::chrono::steady_clock::time_point& deadline, int priority = priority::normal);
+
+        /*!
+         \brief Makes the controller active if it is not already, unless that means waiting for
+         another controller change.
+
+         \see makeActive(const std::chrono::steady_clock::time_point& deadline, int priority)
+         */
+        bool tryMakeActive(int priority = priority::normal);
+
+        /*!
+         \brief Makes the controller active if it is not already, unless that means waiting more
+         than `timeout` for other controller changes.
+
+         \see makeActive(const std::chrono::steady_clock::time_point& deadline, int priority)
+         */
+        bool makeActiveFor(const std::chrono::milliseconds& timeout, int priority = priority::normal);
 
         /*!
          \brief Makes the controller inactive if it is not already.
@@ -144,6 +175,19 @@ namespace hserial {
          */
         void makeInactive();
 
+        /*!
+         \brief Makes the controller inactive, deferring the transition until another
+         controller wants the port.
+
+         If the controller calls makeActive (or makeLockedActive) before then it gets the port
+         back without a transition. A locked active controller can't be parked, since it would
+         refuse the deferred transition, so in that case this function calls makeInactive.
+
+         \throws (the exceptions of makeInactive)
+         \see HSerialController::park
+         */
+        void park();
+
         /*!
          \brief Makes the contoller locked active if not already.
 
@@ -155,12 +199,43 @@ namespace hserial {
 
          Calling code should always catch ControllerRefuses.
 
+         \param priority Determines when the change goes if other controller changes are waiting
+         for the port (see hserial::priority).
          \throws hserial::ControllerRefuses Thrown if the current controller (or any controller
          delegated to by the current controller) refuses to give up the active role. In this case
          the controller is not active.
          \see unlockActive, makeInactive
          */
-        void makeLockedActive();
+        void makeLockedActive(int priority = priority::normal);
+
+        /*!
+         \brief Makes the controller locked active if not already, unless that means waiting past
+         `deadline` for other controller changes on the port.
+
+         Once the change starts it runs to completion.
+
+         \returns `false` if the deadline passed before the change could start. Nothing is done
+         in that case: an active controller stays active, and stays locked only if it was locked.
+         \throws (the exceptions of makeLockedActive)
+         \see tryMakeLockedActive, makeLockedActiveFor
+         */
+        bool makeLockedActive(const std::chrono::steady_clock::time_point& deadline, int priority = priority::normal);
+
+        /*!
+         \brief Makes the controller locked active if not already, unless that means waiting for
+         another controller change.
+
+         \see makeLockedActive(const std::chrono::steady_clock::time_point& deadline, int priority)
+         */
+        bool tryMakeLockedActive(int priority = priority::normal);
+
+        /*!
+         \brief Makes the controller locked active if not already, unless that means waiting more
+         than `timeout` for other controller changes.
+
+         \see makeLockedActive(const std::chrono::steady_clock::time_point& deadline, int priority)
+         */
+        bool makeLockedActiveFor(const std::chrono::milliseconds& timeout, int priority = priority::normal);
 
         /*!
          \brief Unlocks the controller if locked.
@@ -172,6 +247,20 @@ namespace hserial {
          \see makeInactive, makeLockedActive
          */
         void unlockActive();
+
+        using HSerialController::isTransitionRequested;
+
+        /*!
+         \brief Makes the controller inactive (unlocking it) if another controller wants the
+         port.
+
+         A locked active controller can use this to hand the port over at a point it chooses.
+
+         \returns `true` if the controller was made inactive.
+         \throws hserial::ControllerRefuses (see makeInactive)
+         \see HSerialController::yieldIfRequested
+         */
+        bool yieldIfRequested();
         
         /// \} /Access Management
 
@@ -212,6 +301,8 @@ namespace hserial {
         using HSerialController::getStopbits;
         using HSerialController::setFlowcontrol;
         using HSerialController::getFlowcontrol;
+        using HSerialController::applySettings;
+        using HSerialController::getSettings;
 
         /*! \copydoc HSerialController:setSettings() */
         void setSettings(uint32_t baudrate = 9600,
@@ -234,7 +325,14 @@ namespace hserial {
 
         using HSerialController::read;
         using HSerialController::readline;
+        using HSerialController::readlineView;
         using HSerialController::readlines;
+        using HSerialController::forEachLine;
+        using HSerialController::enableReadBuffering;
+        using HSerialController::disableReadBuffering;
+        using HSerialController::isReadBufferingEnabled;
+        using HSerialController::setReadCRC;
+        using HSerialController::getReadCRC;
 
         /// \} /Reading from the Port
 
@@ -247,6 +345,10 @@ namespace hserial {
         /// \{
 
         using HSerialController::write;
+        using HSerialController::enqueueWrite;
+        using HSerialController::waitForQueuedWrite;
+        using HSerialController::waitForQueuedWrites;
+        using HSerialController::cancelQueuedWrites;
 
         /// \} /Writing to the Port
 
@@ -298,6 +400,25 @@ namespace hserial {
 
         /// \} /Working with the Control Lines
 
+#if defined(__linux__) && defined(__cpp_impl_coroutine)
+
+        /*!
+         \name Asynchronous Operations
+
+         Coroutine versions of the access functions, performed by an HSerialReactor (see
+         HSerialAwaitable.hpp). These may throw NotActiveController.
+         */
+        /// \{
+
+        using HSerialController::asyncRead;
+        using HSerialController::asyncReadline;
+        using HSerialController::asyncWrite;
+        using HSerialController::asyncWaitForChange;
+
+        /// \} /Asynchronous Operations
+
+#endif /* __linux__ && __cpp_impl_coroutine */
+
 
     protected:
 
@@ -312,6 +433,7 @@ namespace hserial {
         virtual void didCancelMakeInactive() noexcept;
         virtual void willMakeActive() noexcept;
         virtual void didMakeActive();
+        virtual bool canSkipActivation() const noexcept;
         /// \} /Internal: Transition Callbacks
 
 
@@ -10,14 +10,86 @@
 
 #include <algorithm>
 #include <cassert>
-
+#include <cstdint>
+#include <cstring>
+#include <limits>
 
 #include "HSerialController.hpp"
+#include "HSerialCRC.hpp"
 #include "HSerialExceptions.hpp"
 
 
 namespace hserial {
 
+    namespace {
+        // The most bytes the read pump (or a line read) takes from the port with one read.
+        const size_t readChunkSize = 4096;
+
+        // The capacity of the read buffer created for line reads if read buffering was never
+        //  enabled.
+        const size_t lineReadBufferCapacity = 65536;
+
+        // How long the read pump sleeps when the port has nothing to read and waitReadable
+        //  returned immediately (which happens when the read timeout is zero).
+        const std::chrono::milliseconds readPumpPollInterval(1);
+
+        // enqueueWrite blocks while this many bytes are pending (unless the queue is empty).
+        const size_t writeQueueCapacity = 1 << 20;
+
+        // A queued controller change gains one priority level for each interval it waits, so that
+        //  a steady stream of higher priority changes can't starve it.
+        const std::chrono::milliseconds transitionAgingInterval(10);
+
+        int effectiveTransitionPriority(int priority, std::chrono::steady_clock::time_point enqueueTime, std::chrono::steady_clock::time_point now) {
+            int64_t gained = (now - enqueueTime) / transitionAgingInterval;
+            int64_t result = int64_t(priority) + gained;
+            return int(std::min<int64_t>(result, std::numeric_limits<int>::max()));
+        }
+
+        // A parked controller is stored in state_activeController with the low bit set, so that
+        //  it compares unequal to every controller (see HSerialAccess::park). Controllers are
+        //  pointer aligned, so the bit is otherwise always clear.
+        const uintptr_t parkedFlag = 1;
+
+        HSerialController* parkedValue(HSerialController* controller) {
+            return reinterpret_cast<HSerialController*>(reinterpret_cast<uintptr_t>(controller) | parkedFlag);
+        }
+
+        bool isParkedValue(HSerialController* value) {
+            return (reinterpret_cast<uintptr_t>(value) & parkedFlag) != 0;
+        }
+
+        HSerialController* unparkedValue(HSerialController* value) {
+            return reinterpret_cast<HSerialController*>(reinterpret_cast<uintptr_t>(value) & ~parkedFlag);
+        }
+
+        // Destinations for bufferedReadline. Each returns where the next `count` line bytes go.
+
+        class StringAppender {
+        public:
+            StringAppender(std::string& _buffer) : buffer(_buffer) {}
+            uint8_t* operator()(size_t count) {
+                size_t oldSize = buffer.size();
+                buffer.resize(oldSize + count);
+                return reinterpret_cast<uint8_t*>(&buffer[0]) + oldSize;
+            }
+        private:
+            std::string& buffer;
+        };
+
+        class BufferAppender {
+        public:
+            BufferAppender(uint8_t* _buffer) : next(_buffer) {}
+            uint8_t* operator()(size_t count) {
+                uint8_t* result = next;
+                next += count;
+                return result;
+            }
+        private:
+            uint8_t* next;
+        };
+    }
+
     // HSerialAccess::setTimeout uses this operator.
     bool operator!=(const serial::Timeout& A, const serial::Timeout& B) {
         if (A.inter_byte_timeout != B.inter_byte_timeout) return true;
@@ -34,15 +106,29 @@ namespace hserial {
      \brief Queues and serializes controller changes by blocking threads.
 
      Only one TransitionBlocker instance exists at a time (others are blocked in the constructor).
-     This prevents concurrent controller changes unless this mechanism is explicitly bypassed, as
-     occurs for active controller changes initiated from willRemove and didCancelRemove callbacks
-     (see shouldPerformConcurrentActiveControllerChange()).
+     Blocked instances are let through one at a time in order of effective priority: the
+     requested priority plus one level for each transitionAgingInterval waited. Instances of equal
+     effective priority are let through in arrival order. This prevents concurrent controller
+     changes unless this mechanism is explicitly bypassed, as occurs for active controller changes
+     initiated from willRemove and didCancelRemove callbacks (see
+     shouldPerformConcurrentActiveControllerChange()).
+
+     If transition coalescing is enabled (see HSerialPort::setTransitionCoalescing) an activation
+     that would be followed immediately by another controller's activation is skipped: its
+     instance is attached to the later one instead of getting a turn. If the later activation
+     succeeds the skipped instances are released without a turn (see hasTurn). Otherwise they
+     go back into the queue in their original places. A skipped instance with a deadline still
+     leaves when the deadline passes.
 
      The TransitionBlocker object is also responsible for setting the following 
      HSerialAccess state variables:
      - state_transitionInProgress
      - state_concurrentActiveControllerChangeAllowed (set to false)
      - state_transitionThread
+     - the closed flag of state_accessGate
+
+     It also unparks a parked controller (see park), so that transitions always start from the
+     real active controller.
      
      \see shouldPerformConcurrentActiveControllerChange
      */
@@ -53,14 +139,57 @@ namespace hserial {
          
          Transitions are queued and serialized by using a TransitionBlocker object. Only one
          TransitionBlocker object exists at a time -- any others are blocked in their constructors.
+
+         `controller` is recorded for HSerialPort::getTransitionQueue, and for coalescing.
+         `isActivation` indicates that the transition is for makeActive, which is the only kind
+         that can be coalesced.
+
+         If `deadline` passes while queued, or while attached to a later activation, the instance
+         leaves without getting a turn (see hasTurn). `time_point::max()` means no deadline.
          */
-        TransitionBlocker(HSerialAccess& _access) : access(_access) {
+        TransitionBlocker(HSerialAccess& _access, const HSerialController& controller, int priority,
+                          const std::chrono::steady_clock::time_point& deadline = std::chrono::steady_clock::time_point::max(),
+                          bool isActivation = false) : access(_access) {
+            waiter.priority = priority;
+            waiter.enqueueTime = std::chrono::steady_clock::now();
+            waiter.controller = &controller;
+            waiter.thread = std::this_thread::get_id();
+            waiter.isActivation = isActivation;
+            waiter.isSkippable = isActivation && controller.canSkipActivation();
+
             std::unique_lock<std::mutex> lock(access.tb_mutex);
-            uint32_t number = access.tb_nextNumber++;
-            auto predicate = [number, this]() {
-                return number == access.tb_readyNumber;
-            };
-            access.tb_readyCondition.wait(lock, predicate);
+            waiter.sequence = access.tb_nextSequence++;
+            access.tb_waiters.push_back(&waiter);
+            access.tb_numWaiting.store(uint32_t(access.tb_waiters.size()));
+            if (!access.tb_isBusy) {
+                access.grantNextTransition();
+            }
+            bool hasDeadline = (deadline != std::chrono::steady_clock::time_point::max());
+            while (waiter.state != TransitionWaiter::State::granted && waiter.state != TransitionWaiter::State::skipped) {
+                if (hasDeadline) {
+                    if (std::chrono::steady_clock::now() >= deadline) {
+                        // Leaving doesn't affect the other waiters' turns, so no one needs to be
+                        //  woken.
+                        if (waiter.state == TransitionWaiter::State::queued) {
+                            access.tb_waiters.erase(std::find(access.tb_waiters.begin(), access.tb_waiters.end(), &waiter));
+                            access.tb_numWaiting.store(uint32_t(access.tb_waiters.size()));
+                        } else {
+                            // The holder has the turn, so it is alive until it settles its list.
+                            std::vector<TransitionWaiter*>& list = waiter.supersededBy->superseded;
+                            list.erase(std::find(list.begin(), list.end(), &waiter));
+                        }
+                        _hasTurn = false;
+                        return;
+                    }
+                    access.tb_readyCondition.wait_until(lock, deadline);
+                } else {
+                    access.tb_readyCondition.wait(lock);
+                }
+            }
+            if (waiter.state == TransitionWaiter::State::skipped) {
+                _hasTurn = false;
+                return;
+            }
             lock.unlock();
 
             // Initiate transition.
@@ -68,28 +197,158 @@ namespace hserial {
             access.state_transitionInProgress = true;
             access.state_concurrentActiveControllerChangeAllowed.store(false);
             access.state_transitionThread = std::this_thread::get_id();
+
+            // Closing the gate forces new access calls onto the AccessGuard's slow path. Calls
+            //  that entered through the fast path before this point are still counted.
+            access.state_accessGate.fetch_or(accessGateClosedFlag);
+
+            // A parked controller is still active as far as it knows, so the transition must
+            //  deactivate it in the usual way. Reclaiming it at the same time stores the same
+            //  value, and park can't run now since state_transitionInProgress is set.
+            HSerialController* activeController = access.state_activeController.load();
+            if (isParkedValue(activeController)) {
+                access.state_activeController.store(unparkedValue(activeController));
+            }
         }
         /*!
          \brief Ends the transition, allowing the next queued transition.
          */
         ~TransitionBlocker() {
+            if (!_hasTurn) {
+                return;
+            }
 
             // Terminate transition.
             {
                 std::lock_guard<std::mutex> stateLock(access.stateMutex);
                 access.state_transitionInProgress = false;
+                // Reopen the gate in the next epoch. Calls may leave concurrently.
+                uint64_t gate = access.state_accessGate.load();
+                uint64_t reopened;
+                do {
+                    reopened = ((gate + accessGateEpochUnit) & accessGateEpochMask) | (gate & accessGateCountMask);
+                } while (!access.state_accessGate.compare_exchange_weak(gate, reopened));
             }
             access.accessUnblockedCondition.notify_all();
 
-            std::unique_lock<std::mutex> lock(access.tb_mutex);
-            access.tb_readyNumber += 1;
-            lock.unlock();
+            std::lock_guard<std::mutex> lock(access.tb_mutex);
+            if (!waiter.superseded.empty()) {
+                // The skipped activations took effect only if this one did.
+                bool succeeded = (access.state_activeController.load() == waiter.controller);
+                for (TransitionWaiter* skipped : waiter.superseded) {
+                    skipped->state = succeeded ? TransitionWaiter::State::skipped : TransitionWaiter::State::queued;
+                    skipped->supersededBy = nullptr;
+                    if (!succeeded) {
+                        access.tb_waiters.push_back(skipped);
+                    }
+                }
+                if (!succeeded) {
+                    // Back in their original places (tb_waiters is in arrival order).
+                    std::sort(access.tb_waiters.begin(), access.tb_waiters.end(), [](const TransitionWaiter* a, const TransitionWaiter* b) {
+                        return a->sequence < b->sequence;
+                    });
+                    access.tb_numWaiting.store(uint32_t(access.tb_waiters.size()));
+                }
+            }
+            access.tb_isBusy = false;
+            access.grantNextTransition();
             access.tb_readyCondition.notify_all();
         }
+        /*!
+         \brief Indicates if the thread may perform a transition. False if the deadline passed
+         while waiting, or if the transition was skipped.
+         */
+        bool hasTurn() const {
+            return _hasTurn;
+        }
     private:
         HSerialAccess& access;
+        TransitionWaiter waiter;
+        bool _hasTurn = true;
     };
 
+    void HSerialAccess::grantNextTransition() {
+        if (tb_waiters.empty()) {
+            return;
+        }
+        // Effective priorities change with time, so the waiters aren't kept sorted. The list is
+        //  short, and sorting it is cheap next to a controller change.
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        std::vector<std::pair<int, TransitionWaiter*>> order;
+        order.reserve(tb_waiters.size());
+        for (TransitionWaiter* waiter : tb_waiters) {
+            order.emplace_back(effectiveTransitionPriority(waiter->priority, waiter->enqueueTime, now), waiter);
+        }
+        // tb_waiters is in arrival order, so a stable sort keeps ties first-come first-served.
+        std::stable_sort(order.begin(), order.end(), [](const std::pair<int, TransitionWaiter*>& a, const std::pair<int, TransitionWaiter*>& b) {
+            return a.first > b.first;
+        });
+
+        size_t next = 0;
+        if (tb_isCoalescing) {
+            // Skip activations that another controller's activation would immediately undo. Each
+            //  skipped waiter (and any it was holding) is handed to the one after it.
+            while (next + 1 < order.size()) {
+                TransitionWaiter* waiter = order[next].second;
+                TransitionWaiter* after = order[next + 1].second;
+                if (!waiter->isSkippable || !after->isActivation || after->controller == waiter->controller) {
+                    break;
+                }
+                waiter->state = TransitionWaiter::State::superseded;
+                after->superseded.push_back(waiter);
+                after->superseded.insert(after->superseded.end(), waiter->superseded.begin(), waiter->superseded.end());
+                waiter->superseded.clear();
+                for (TransitionWaiter* held : after->superseded) {
+                    held->supersededBy = after;
+                }
+                tb_waiters.erase(std::find(tb_waiters.begin(), tb_waiters.end(), waiter));
+                next += 1;
+            }
+        }
+
+        TransitionWaiter* granted = order[next].second;
+        granted->state = TransitionWaiter::State::granted;
+        tb_waiters.erase(std::find(tb_waiters.begin(), tb_waiters.end(), granted));
+        tb_numWaiting.store(uint32_t(tb_waiters.size()));
+        tb_isBusy = true;
+        // The predicates differ per waiter, so all must be woken.
+        tb_readyCondition.notify_all();
+    }
+
+    void HSerialAccess::setTransitionCoalescing(bool enabled) {
+        std::lock_guard<std::mutex> lock(tb_mutex);
+        tb_isCoalescing = enabled;
+    }
+
+    bool HSerialAccess::isTransitionRequested(const HSerialController& controller) const {
+        // Waiters include any queued by the active controller itself (e.g. a redundant
+        //  makeActive on another thread). Telling them apart would need tb_mutex.
+        return &controller == state_activeController.load()
+            && (tb_numWaiting.load() > 0 || state_transitionRefused.load());
+    }
+
+    HSerialTransitionQueue HSerialAccess::getTransitionQueue() {
+        HSerialTransitionQueue queue;
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(tb_mutex);
+        queue.isTransitionInProgress = tb_isBusy;
+        queue.waiters.reserve(tb_waiters.size());
+        for (const TransitionWaiter* waiter : tb_waiters) {
+            HSerialTransitionWaiter info;
+            info.controller = waiter->controller;
+            info.thread = waiter->thread;
+            info.priority = waiter->priority;
+            info.effectivePriority = effectiveTransitionPriority(waiter->priority, waiter->enqueueTime, now);
+            info.waitTime = std::chrono::duration_cast<std::chrono::microseconds>(now - waiter->enqueueTime);
+            queue.waiters.push_back(info);
+        }
+        // The order grantNextTransition would pick them in, as of now.
+        std::stable_sort(queue.waiters.begin(), queue.waiters.end(), [](const HSerialTransitionWaiter& a, const HSerialTransitionWaiter& b) {
+            return a.effectivePriority > b.effectivePriority;
+        });
+        return queue;
+    }
+
 
 #pragma mark - AccessUnblocker
 
@@ -122,6 +381,7 @@ namespace hserial {
             std::unique_lock<std::mutex> lock(access.stateMutex);
             if (!access.state_accessIsUnblocked) {
                 access.state_accessIsUnblocked = true;
+                access.state_interruptingThread.store(std::thread::id());
                 lock.unlock();
                 access.accessUnblockedCondition.notify_all();
             }
@@ -144,14 +404,23 @@ namespace hserial {
      controller).
      - It increments and decrements the unreturned access calls counter, which allows code on other
      threads to know if the controller is using the serial port.
-     - If the access call was the last access call to return it broadcasts that fact.
+     - If the access call was the last access call to return during a transition it broadcasts
+     that fact.
 
      The AccessGuard allows concurrent access calls. Serializing access calls requires a
      separate mechanism (see `accessSerializingMutex`).
 
-     When there isn't a transition being performed access calls are always unblocked.
+     When there isn't a transition being performed access calls are always unblocked. In that
+     case the guard takes a lock-free fast path: it checks that its controller is active, enters
+     the access gate with a single compare-exchange (which fails if a transition has closed the
+     gate since the check) and leaves with a single decrement. stateMutex is never locked on the
+     fast path.
 
      During a transition access calls may be blocked on threads other than the transition thread.
+     Calls made while the gate is closed take the slow path, which is the original mutex and
+     condition variable based implementation.
+
+     \see state_accessGate
      */
     class HSerialAccess::AccessGuard {
     public:
@@ -164,6 +433,29 @@ namespace hserial {
          - increments the counter of unreturned access calls.
          */
         AccessGuard(const HSerialAccess& _access, const HSerialController& controller, const char* funcName) : access(_access) {
+
+            // Fast path. The increment succeeds only if the gate word hasn't changed since the
+            //  active controller was checked. Every transition closes the gate and reopens it in a
+            //  new epoch, so the check still holds, and the call is never counted after a
+            //  transition has started. If the increment succeeds then the active controller
+            //  cannot change until the call leaves, since performTransition requires that there be
+            //  no unreturned access calls. (park may mark the controller parked meanwhile, which
+            //  is fine -- the call counts as one made before parking.)
+            // Calls from inactive controllers aren't counted even briefly, since a
+            //  willMakeInactive that doesn't wait for access calls could see them.
+            uint64_t gate = access.state_accessGate.load();
+            while ((gate & accessGateClosedFlag) == 0) {
+                if (&controller != access.state_activeController.load()) {
+                    // Let the slow path make the authoritative check (and throw) with stateMutex
+                    //  locked.
+                    break;
+                }
+                if (access.state_accessGate.compare_exchange_weak(gate, gate + 1)) {
+                    return;
+                }
+            }
+
+            // Slow path.
             auto predicate = [this]() {
                 // Returns true when the given access call may proceed (is unblocked).
                 if (access.state_transitionInProgress) {
@@ -182,7 +474,7 @@ namespace hserial {
             std::unique_lock<std::mutex> lock(access.stateMutex);
             access.accessUnblockedCondition.wait(lock, predicate);
             access.throwIfNotActiveController(controller, funcName);
-            access.state_numUnreturnedAccessCalls += 1;
+            access.state_accessGate.fetch_add(1);
         }
         /*!
          \brief Officially ends an access call.
@@ -192,25 +484,113 @@ namespace hserial {
          - notifies waiting threads if all access calls have returned.
          */
         ~AccessGuard() {
-            std::unique_lock<std::mutex> lock(access.stateMutex);
-            int n = --access.state_numUnreturnedAccessCalls;
-            lock.unlock();
-            if (n == 0) {
-                // It is OK if numUnreturnedAccessCalls is incremented after unlocking -- all the
-                //  condition variable signifies is that the number reached zero at some point.
-                //  Guaranteeing that the number of access calls stays at zero requires call
-                //  blocking.
-                // Consider: this condition is only waited on in waitForAllAccessCallsToReturn,
-                //  which is only allowed to execute during a transition. Should this notification
-                //  only occur during transitions? (It should be harmless as is.)
-                access.allAccessCallsReturnedCondition.notify_all();
-            }
+            access.leaveAccessGate();
         }
     private:
         const HSerialAccess& access;
     };
 
 
+#pragma mark - ReadPumpHold
+
+    /*!
+     \brief Keeps the read pump thread out of the transport.
+
+     The pump thread calls the transport without holding rx_mutex. A ReadPumpHold waits for any
+     such call to finish and prevents new ones for its lifetime. It is used when closing the
+     port, since closing the descriptor underneath a blocked read is not safe.
+
+     This may block for up to the port's read timeout, since that is how long the pump's
+     waitReadable call can take.
+
+     Internal use only.
+     */
+    class HSerialAccess::ReadPumpHold {
+    public:
+        ReadPumpHold(HSerialAccess& _access) : access(_access) {
+            std::unique_lock<std::mutex> lock(access.rx_mutex);
+            access.rx_pumpHold = true;
+            access.rx_condition.wait(lock, [this]() {return !access.rx_pumpBusy;});
+        }
+        ~ReadPumpHold() {
+            {
+                std::lock_guard<std::mutex> lock(access.rx_mutex);
+                access.rx_pumpHold = false;
+            }
+            access.rx_condition.notify_all();
+        }
+    private:
+        HSerialAccess& access;
+    };
+
+
+#pragma mark - WriteQueueHold
+
+    /*!
+     \brief Keeps queued writes out of the transport.
+
+     A WriteQueueHold waits until every byte already queued has been written, and makes
+     enqueueWrite wait for its lifetime, so no queued bytes are written to (or discarded
+     because of) a port that is being closed and reopened.
+
+     The wait for the queue to drain is interruptible.
+
+     \throws hserial::AccessInterrupted from the constructor if interrupted while waiting.
+
+     Internal use only.
+     */
+    class HSerialAccess::WriteQueueHold {
+    public:
+        WriteQueueHold(HSerialAccess& _access) : access(_access) {
+            std::unique_lock<std::mutex> lock(access.tx_mutex);
+            access.tx_isHeld = true;
+            uint64_t ticket = access.tx_enqueuedCount;
+            access.tx_condition.wait(lock, [this, ticket]() {
+                return access.tx_completedCount >= ticket || access.areWaitsInterrupted();
+            });
+            if (access.tx_completedCount < ticket) {
+                access.tx_isHeld = false;
+                lock.unlock();
+                access.tx_condition.notify_all();
+                access.throwAccessInterrupted("applySettings");
+            }
+        }
+        ~WriteQueueHold() {
+            {
+                std::lock_guard<std::mutex> lock(access.tx_mutex);
+                access.tx_isHeld = false;
+            }
+            access.tx_condition.notify_all();
+        }
+    private:
+        HSerialAccess& access;
+    };
+
+
+#pragma mark - SettingsPublisher
+
+    /*!
+     \brief Republishes the port's settings to settingsCache when it goes out of scope.
+
+     serial::Serial stores a new setting before it reconfigures the port, so a setter that throws
+     may still have changed the setting. Reading the settings back from the transport afterwards,
+     whether or not the setter threw, keeps settingsCache in agreement with the transport.
+
+     Must be used with accessSerializingMutex locked.
+
+     Internal use only.
+     */
+    class HSerialAccess::SettingsPublisher {
+    public:
+        SettingsPublisher(HSerialAccess& _access) : access(_access) {}
+        ~SettingsPublisher() {
+            access.settingsCache.store(access.readSettingsFromPort());
+        }
+    private:
+        HSerialAccess& access;
+    };
+
+
 #pragma mark - Controller Access Management
 
     bool HSerialAccess::isActive(const HSerialController& controller) const {
@@ -219,7 +599,15 @@ namespace hserial {
         return &controller == state_activeController.load();
     }
 
-    void HSerialAccess::makeActive(HSerialController& controller) {
+    bool HSerialAccess::makeActive(HSerialController& controller, int priority, const std::chrono::steady_clock::time_point& deadline) {
+        // Fast path: reclaim the port if the controller parked it and no one else has asked for
+        //  it since (see park). A change that has already been granted is unaffected, since
+        //  the TransitionBlocker unparks the controller before deciding what to do.
+        HSerialController* parked = parkedValue(&controller);
+        if (tb_numWaiting.load() == 0 && state_activeController.compare_exchange_strong(parked, &controller)) {
+            return true;
+        }
+
         if (shouldPerformConcurrentActiveControllerChange(controller)) {
             // There can't be more than one thread at a time meeting this condition since
             //  shouldPerform* returns true only when called on the transition thread during
@@ -230,7 +618,12 @@ namespace hserial {
             }
         } else {
             // Need to perform a queued and serialized transition.
-            TransitionBlocker blocker(*this);
+            TransitionBlocker blocker(*this, controller, priority, deadline, true);
+            if (!blocker.hasTurn()) {
+                // Either the deadline passed or the activation was skipped. In both cases the
+                //  controller wasn't made active.
+                return false;
+            }
 
             // After blocker's constructor is finished the thread has exclusive control of
             //  controller changes for the lifetime of the blocker object.
@@ -243,22 +636,35 @@ namespace hserial {
             //  in the queue since the access list or active controller may have changed.
             // The access list won't change during the call to isInAccessList due to the blocker
             //  object.
-            if (isInAccessList(controller)) {
-                // If the controller is in the access list then perform an active controller change,
-                //  but only if not redundant.
-                if (&controller != state_activeController.load()) {
-                    performActiveControllerChange(&controller);
+            try {
+                if (isInAccessList(controller)) {
+                    // If the controller is in the access list then perform an active controller
+                    //  change, but only if not redundant.
+                    if (&controller != state_activeController.load()) {
+                        performActiveControllerChange(&controller);
+                    }
+                } else {
+                    // The controller is not in the access list so a current controller change is
+                    //  required to make it active. This case include the access list being empty --
+                    //  i.e. the current controller being NULL.
+                    performCurrentControllerChange(&controller);
                 }
-            } else {
-                // The controller is not in the access list so a current controller change is
-                //  required to make it active. This case include the access list being empty --
-                //  i.e. the current controller being NULL.
-                performCurrentControllerChange(&controller);
+            } catch (const ControllerRefuses& e) {
+                // Let the active controller know someone wants the port, so that it can hand it
+                //  over when convenient (see HSerialController::yieldIfRequested). The blocker
+                //  keeps the active controller from being removed during the callback.
+                state_transitionRefused.store(true);
+                HSerialController* activeController = state_activeController.load();
+                if (activeController && activeController != &controller) {
+                    activeController->transitionRequested(); // noexcept
+                }
+                throw;
             }
         }
+        return true;
     }
 
-    void HSerialAccess::makeInactive(HSerialController& controller) {
+    void HSerialAccess::makeInactive(HSerialController& controller, int priority) {
         // If this controller is the active controller then it sets the active controller to NULL.
         //  Otherwise it does nothing. This function does not change the access list -- it never
         //  requires a current controller change.
@@ -268,17 +674,42 @@ namespace hserial {
                 performActiveControllerChange(NULL);
             }
         } else {
-            TransitionBlocker blocker(*this);
+            TransitionBlocker blocker(*this, controller, priority);
             if (&controller == state_activeController.load()) {
                 performActiveControllerChange(NULL);
             }
         }
     }
 
+    void HSerialAccess::park(HSerialController& controller) {
+        bool isParked = false;
+        bool isTransitionInProgress;
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            isTransitionInProgress = state_transitionInProgress;
+            if (!isTransitionInProgress && &controller == state_activeController.load()) {
+                // With no transition in progress only a reclaim can change the value, and a
+                //  reclaim only changes a parked value. A refused requester can now have the port.
+                state_activeController.store(parkedValue(&controller));
+                state_transitionRefused.store(false);
+                isParked = true;
+            }
+        }
+        if (isParked) {
+            // The controller's pending asynchronous operations can be failed, as after a
+            //  transition.
+            notifyEventObservers(transitionEvent);
+        } else if (isTransitionInProgress) {
+            // The change can't be deferred while another one is under way (or if this is a
+            //  concurrent change from a willRemove or didCancelRemove callback).
+            makeInactive(controller, priority::normal);
+        }
+    }
+
     void HSerialAccess::removeFromAccess(HSerialController& controller) {
         // Removing the controller from the access requires a current controller change, which
         //  must always be queued.
-        TransitionBlocker blocker(*this);
+        TransitionBlocker blocker(*this, controller, priority::normal);
         // The blocker object makes the call to isInAccessList safe.
         if (isInAccessList(controller)) {
             if (&controller == state_currentController.load()) {
@@ -303,301 +734,1215 @@ namespace hserial {
     void HSerialAccess::open(const HSerialController& controller) {
         AccessGuard guard(*this, controller, __func__);
         std::lock_guard<std::mutex> lock(accessSerializingMutex);
-        serial.open();
+        transport->open();
+        // Wake the read pump, which idles while the port is closed. An error from the previous
+        //  session no longer applies.
+        {
+            std::lock_guard<std::mutex> rxLock(rx_mutex);
+            rx_pumpError = nullptr;
+        }
+        rx_condition.notify_all();
+        // Bytes may have arrived between the transport reporting readable and the drain in
+        //  open, and a reactor only rearms the handle while the port is open.
+        notifyEventObservers(readableEvent);
     }
 
     void HSerialAccess::ensureOpen(const HSerialController& controller) {
         AccessGuard guard(*this, controller, __func__);
         std::lock_guard<std::mutex> lock(accessSerializingMutex);
-        if (!serial.isOpen()) {
-            serial.open();
+        if (!transport->isOpen()) {
+            transport->open();
+            {
+                std::lock_guard<std::mutex> rxLock(rx_mutex);
+                rx_pumpError = nullptr;
+            }
+            rx_condition.notify_all();
+            notifyEventObservers(readableEvent);
         }
     }
 
     bool HSerialAccess::isOpen(const HSerialController& controller) const {
         AccessGuard guard(*this, controller, __func__);
         std::lock_guard<std::mutex> lock(accessSerializingMutex);
-        return serial.isOpen();
+        return transport->isOpen();
     }
 
     void HSerialAccess::close(const HSerialController& controller) {
         AccessGuard guard(*this, controller, __func__);
         std::lock_guard<std::mutex> lock(accessSerializingMutex);
-        serial.close();
+        discardQueuedWrites(true);
+        ReadPumpHold hold(*this);
+        transport->close();
+        flushReadBuffer();
     }
 
     size_t HSerialAccess::available(const HSerialController& controller) {
         AccessGuard guard(*this, controller, __func__);
+        size_t count = 0;
+        if (rx_inUse.load()) {
+            std::lock_guard<std::mutex> rxLock(rx_mutex);
+            count = rx_buffer->getSize();
+            if (rx_pumpEnabled) {
+                // The pump drains the port, so the buffer is the whole story.
+                return count;
+            }
+        }
         std::lock_guard<std::mutex> lock(accessSerializingMutex);
-        return serial.available();
+        return count + transport->available();
     }
 
     bool HSerialAccess::waitReadable(const HSerialController& controller) {
         AccessGuard guard(*this, controller, __func__);
         // Waiting functions are not serialized.
-        return serial.waitReadable();
+        if (rx_inUse.load()) {
+            serial::Timeout timeout = getCachedTimeout();
+            std::unique_lock<std::mutex> rxLock(rx_mutex);
+            if (!rx_buffer->isEmpty()) {
+                return true;
+            }
+            if (rx_pumpEnabled) {
+                auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout.read_timeout_constant);
+                rx_condition.wait_until(rxLock, deadline, [this]() {
+                    return !rx_buffer->isEmpty() || !rx_pumpEnabled || rx_pumpError || areWaitsInterrupted();
+                });
+                if (rx_buffer->isEmpty() && areWaitsInterrupted()) {
+                    throwAccessInterrupted(__func__);
+                }
+                return !rx_buffer->isEmpty();
+            }
+        }
+        return transport->waitReadable();
     }
 
     void HSerialAccess::waitByteTimes(const HSerialController& controller, size_t count) {
         AccessGuard guard(*this, controller, __func__);
         // Waiting functions are not serialized.
-        serial.waitByteTimes(count);
+        transport->waitByteTimes(count);
     }
 
     size_t HSerialAccess::read(const HSerialController& controller, uint8_t* buffer, size_t size) {
         AccessGuard guard(*this, controller, __func__);
         // Reading functions are not serialized.
-        return serial.read(buffer, size);
+        size_t count = rx_inUse.load() ? bufferedRead(buffer, size) : transport->read(buffer, size);
+        updateReadCRC(controller, buffer, count);
+        return count;
     }
 
     size_t HSerialAccess::read(const HSerialController& controller, std::vector<uint8_t>& buffer, size_t size) {
         AccessGuard guard(*this, controller, __func__);
         // Reading functions are not serialized.
-        return serial.read(buffer, size);
+        size_t oldSize = buffer.size();
+        size_t count;
+        if (rx_inUse.load()) {
+            buffer.resize(oldSize + size);
+            count = bufferedRead(buffer.data() + oldSize, size);
+            buffer.resize(oldSize + count);
+        } else {
+            count = transport->read(buffer, size);
+        }
+        updateReadCRC(controller, buffer.data() + oldSize, count);
+        return count;
     }
 
     size_t HSerialAccess::read(const HSerialController& controller, std::string& buffer, size_t size) {
         AccessGuard guard(*this, controller, __func__);
         // Reading functions are not serialized.
-        return serial.read(buffer, size);
+        size_t oldSize = buffer.size();
+        size_t count;
+        if (rx_inUse.load()) {
+            buffer.resize(oldSize + size);
+            count = bufferedRead(reinterpret_cast<uint8_t*>(&buffer[oldSize]), size);
+            buffer.resize(oldSize + count);
+        } else {
+            count = transport->read(buffer, size);
+        }
+        updateReadCRC(controller, reinterpret_cast<const uint8_t*>(buffer.data()) + oldSize, count);
+        return count;
     }
 
     std::string HSerialAccess::read(const HSerialController& controller, size_t size) {
         AccessGuard guard(*this, controller, __func__);
         // Reading functions are not serialized.
-        return serial.read(size);
+        std::string buffer;
+        if (rx_inUse.load()) {
+            buffer.resize(size);
+            buffer.resize(bufferedRead(reinterpret_cast<uint8_t*>(&buffer[0]), size));
+        } else {
+            buffer = transport->read(size);
+        }
+        updateReadCRC(controller, reinterpret_cast<const uint8_t*>(buffer.data()), buffer.size());
+        return buffer;
+    }
+
+    // The line reading functions always go through rx_buffer, even if read buffering is not
+    //  enabled, so that the port can be read in chunks instead of one byte at a time. Bytes
+    //  after the end of the line stay in rx_buffer for the next reading call.
+
+    size_t HSerialAccess::readline(const HSerialController& controller, std::string& buffer, size_t size, const std::string& eol) {
+        AccessGuard guard(*this, controller, __func__);
+        // Reading functions are not serialized.
+        ensureReadBuffer();
+        size_t oldSize = buffer.size();
+        size_t count = bufferedReadline(StringAppender(buffer), size, eol);
+        updateReadCRC(controller, reinterpret_cast<const uint8_t*>(buffer.data()) + oldSize, count);
+        return count;
     }
 
-    size_t HSerialAccess::readline(const HSerialController& controller, std::string& buffer, size_t size, std::string eol) {
+    size_t HSerialAccess::readline(const HSerialController& controller, uint8_t* buffer, size_t size, const HSerialByteView& eol) {
         AccessGuard guard(*this, controller, __func__);
         // Reading functions are not serialized.
-        return serial.readline(buffer, size, eol);
+        ensureReadBuffer();
+        size_t count = bufferedReadline(BufferAppender(buffer), size, eol);
+        updateReadCRC(controller, buffer, count);
+        return count;
     }
 
-    std::string HSerialAccess::readline(const HSerialController& controller, size_t size, std::string eol) {
+    std::string HSerialAccess::readline(const HSerialController& controller, size_t size, const std::string& eol) {
         AccessGuard guard(*this, controller, __func__);
         // Reading functions are not serialized.
-        return serial.readline(size, eol);
+        ensureReadBuffer();
+        std::string buffer;
+        bufferedReadline(StringAppender(buffer), size, eol);
+        updateReadCRC(controller, reinterpret_cast<const uint8_t*>(buffer.data()), buffer.size());
+        return buffer;
     }
 
-    std::vector<std::string> HSerialAccess::readlines(const HSerialController& controller, size_t size, std::string eol) {
+    std::vector<std::string> HSerialAccess::readlines(const HSerialController& controller, size_t size, const std::string& eol) {
         AccessGuard guard(*this, controller, __func__);
         // Reading functions are not serialized.
-        return serial.readlines(size, eol);
+        ensureReadBuffer();
+        std::vector<std::string> lines = bufferedReadlines(size, eol);
+        for (const std::string& line : lines) {
+            updateReadCRC(controller, reinterpret_cast<const uint8_t*>(line.data()), line.size());
+        }
+        return lines;
     }
 
     size_t HSerialAccess::write(const HSerialController& controller, const uint8_t* data, size_t size) {
         AccessGuard guard(*this, controller, __func__);
         // Writing functions are not serialized.
-        return serial.write(data, size);
+        if (tx_inUse.load()) waitForWriteQueueToDrain();
+        return transport->write(data, size);
     }
 
     size_t HSerialAccess::write(const HSerialController& controller, const std::vector<uint8_t>& data) {
         AccessGuard guard(*this, controller, __func__);
         // Writing functions are not serialized.
-        return serial.write(data);
+        if (tx_inUse.load()) waitForWriteQueueToDrain();
+        return transport->write(data);
     }
 
     size_t HSerialAccess::write(const HSerialController& controller, const std::string &data) {
         AccessGuard guard(*this, controller, __func__);
         // Writing functions are not serialized.
-        return serial.write(data);
+        if (tx_inUse.load()) waitForWriteQueueToDrain();
+        return transport->write(data);
     }
 
     void HSerialAccess::setBaudrate(const HSerialController& controller, uint32_t baudrate, bool onlyIfDifferent) {
         AccessGuard guard(*this, controller, __func__);
-        std::lock_guard<std::mutex> lock(accessSerializingMutex);
-        if (!onlyIfDifferent || baudrate != serial.getBaudrate()) {
-            serial.setBaudrate(baudrate);
+        // settingsCache is authoritative, so an unchanged setting doesn't need the mutex.
+        if (onlyIfDifferent && baudrate == settingsCache.getBaudrate()) {
+            return;
         }
+        std::lock_guard<std::mutex> lock(accessSerializingMutex);
+        SettingsPublisher publisher(*this);
+        transport->setBaudrate(baudrate);
     }
 
     uint32_t HSerialAccess::getBaudrate(const HSerialController& controller) const {
         AccessGuard guard(*this, controller, __func__);
-        std::lock_guard<std::mutex> lock(accessSerializingMutex);
-        return serial.getBaudrate();
+        return settingsCache.getBaudrate();
     }
 
     void HSerialAccess::setTimeout(const HSerialController& controller, serial::Timeout& timeout, bool onlyIfDifferent) {
         AccessGuard guard(*this, controller, __func__);
-        std::lock_guard<std::mutex> lock(accessSerializingMutex);
-        if (!onlyIfDifferent || timeout != serial.getTimeout()) {
-            serial.setTimeout(timeout);
+        if (onlyIfDifferent && !(timeout != settingsCache.load().timeout)) {
+            return;
         }
+        std::lock_guard<std::mutex> lock(accessSerializingMutex);
+        SettingsPublisher publisher(*this);
+        transport->setTimeout(timeout);
     }
 
     serial::Timeout HSerialAccess::getTimeout(const HSerialController& controller) const {
         AccessGuard guard(*this, controller, __func__);
-        std::lock_guard<std::mutex> lock(accessSerializingMutex);
-        return serial.getTimeout();
+        return settingsCache.load().timeout;
     }
 
     void HSerialAccess::setBytesize(const HSerialController& controller, serial::bytesize_t bytesize, bool onlyIfDifferent) {
         AccessGuard guard(*this, controller, __func__);
-        std::lock_guard<std::mutex> lock(accessSerializingMutex);
-        if (!onlyIfDifferent || bytesize != serial.getBytesize()) {
-            serial.setBytesize(bytesize);
+        if (onlyIfDifferent && bytesize == settingsCache.load().bytesize) {
+            return;
         }
+        std::lock_guard<std::mutex> lock(accessSerializingMutex);
+        SettingsPublisher publisher(*this);
+        transport->setBytesize(bytesize);
     }
 
     serial::bytesize_t HSerialAccess::getBytesize(const HSerialController& controller) const {
         AccessGuard guard(*this, controller, __func__);
-        std::lock_guard<std::mutex> lock(accessSerializingMutex);
-        return serial.getBytesize();
+        return settingsCache.load().bytesize;
     }
 
     void HSerialAccess::setParity(const HSerialController& controller, serial::parity_t parity, bool onlyIfDifferent) {
         AccessGuard guard(*this, controller, __func__);
-        std::lock_guard<std::mutex> lock(accessSerializingMutex);
-        if (!onlyIfDifferent || parity != serial.getParity()) {
-            serial.setParity(parity);
+        if (onlyIfDifferent && parity == settingsCache.load().parity) {
+            return;
         }
+        std::lock_guard<std::mutex> lock(accessSerializingMutex);
+        SettingsPublisher publisher(*this);
+        transport->setParity(parity);
     }
 
     serial::parity_t HSerialAccess::getParity(const HSerialController& controller) const {
         AccessGuard guard(*this, controller, __func__);
-        std::lock_guard<std::mutex> lock(accessSerializingMutex);
-        return serial.getParity();
+        return settingsCache.load().parity;
     }
 
     void HSerialAccess::setStopbits(const HSerialController& controller, serial::stopbits_t stopbits, bool onlyIfDifferent) {
         AccessGuard guard(*this, controller, __func__);
-        std::lock_guard<std::mutex> lock(accessSerializingMutex);
-        if (!onlyIfDifferent || stopbits != serial.getStopbits()) {
-            serial.setStopbits(stopbits);
+        if (onlyIfDifferent && stopbits == settingsCache.load().stopbits) {
+            return;
         }
+        std::lock_guard<std::mutex> lock(accessSerializingMutex);
+        SettingsPublisher publisher(*this);
+        transport->setStopbits(stopbits);
     }
 
     serial::stopbits_t HSerialAccess::getStopbits(const HSerialController& controller) const {
         AccessGuard guard(*this, controller, __func__);
-        std::lock_guard<std::mutex> lock(accessSerializingMutex);
-        return serial.getStopbits();
+        return settingsCache.load().stopbits;
     }
 
     void HSerialAccess::setFlowcontrol(const HSerialController& controller, serial::flowcontrol_t flowcontrol, bool onlyIfDifferent) {
         AccessGuard guard(*this, controller, __func__);
-        std::lock_guard<std::mutex> lock(accessSerializingMutex);
-        if (!onlyIfDifferent || flowcontrol != serial.getFlowcontrol()) {
-            serial.setFlowcontrol(flowcontrol);
+        if (onlyIfDifferent && flowcontrol == settingsCache.load().flowcontrol) {
+            return;
         }
+        std::lock_guard<std::mutex> lock(accessSerializingMutex);
+        SettingsPublisher publisher(*this);
+        transport->setFlowcontrol(flowcontrol);
     }
 
     serial::flowcontrol_t HSerialAccess::getFlowcontrol(const HSerialController& controller) const {
         AccessGuard guard(*this, controller, __func__);
-        std::lock_guard<std::mutex> lock(accessSerializingMutex);
-        return serial.getFlowcontrol();
+        return settingsCache.load().flowcontrol;
     }
 
     void HSerialAccess::setSettings(const HSerialController& controller, uint32_t baudrate, serial::Timeout timeout, serial::bytesize_t bytesize,
                                     serial::parity_t parity, serial::stopbits_t stopbits, serial::flowcontrol_t flowcontrol, bool onlyIfDifferent) {
         AccessGuard guard(*this, controller, __func__);
         std::lock_guard<std::mutex> lock(accessSerializingMutex);
+        SettingsPublisher publisher(*this);
+        HSerialSettings current = settingsCache.load();
 
-        if (!onlyIfDifferent || baudrate != serial.getBaudrate()) {
-            serial.setBaudrate(baudrate);
+        if (!onlyIfDifferent || baudrate != current.baudrate) {
+            transport->setBaudrate(baudrate);
         }
 
-        if (!onlyIfDifferent || timeout != serial.getTimeout()) {
-            serial.setTimeout(timeout);
+        if (!onlyIfDifferent || timeout != current.timeout) {
+            transport->setTimeout(timeout);
         }
 
-        if (!onlyIfDifferent || bytesize != serial.getBytesize()) {
-            serial.setBytesize(bytesize);
+        if (!onlyIfDifferent || bytesize != current.bytesize) {
+            transport->setBytesize(bytesize);
         }
 
-        if (!onlyIfDifferent || parity != serial.getParity()) {
-            serial.setParity(parity);
+        if (!onlyIfDifferent || parity != current.parity) {
+            transport->setParity(parity);
         }
 
-        if (!onlyIfDifferent || stopbits != serial.getStopbits()) {
-            serial.setStopbits(stopbits);
+        if (!onlyIfDifferent || stopbits != current.stopbits) {
+            transport->setStopbits(stopbits);
         }
 
-        if (!onlyIfDifferent || flowcontrol != serial.getFlowcontrol()) {
-            serial.setFlowcontrol(flowcontrol);
+        if (!onlyIfDifferent || flowcontrol != current.flowcontrol) {
+            transport->setFlowcontrol(flowcontrol);
         }
     }
 
+    HSerialSettingsReport HSerialAccess::applySettings(const HSerialController& controller, const HSerialSettings& settings, const HSerialSettingsOptions& options) {
+        AccessGuard guard(*this, controller, __func__);
+
+        HSerialSettingsReport report;
+        auto start = std::chrono::steady_clock::now();
+
+        std::lock_guard<std::mutex> lock(accessSerializingMutex);
+
+        // The comparison is made with the lock held, so it matches the port being changed.
+        HSerialSettings current = readSettingsFromPort();
+        unsigned numLineChanges = (settings.baudrate != current.baudrate)
+                                + (settings.bytesize != current.bytesize)
+                                + (settings.parity != current.parity)
+                                + (settings.stopbits != current.stopbits)
+                                + (settings.flowcontrol != current.flowcontrol);
+        bool shouldReopen = options.reopenForMultipleChanges && numLineChanges > 1 && transport->isOpen();
+
+        // Before reopening, the queued bytes are written and new ones are held back until the
+        //  port is open again, since the writer can't use a closed port. The pump must also be
+        //  out of the transport, which can take up to the read timeout. Both waits happen before
+        //  the switch is timed.
+        std::unique_ptr<WriteQueueHold> writeHold;
+        std::unique_ptr<ReadPumpHold> readHold;
+        if (shouldReopen) {
+            writeHold.reset(new WriteQueueHold(*this));
+        } else if (options.drainOutput && tx_inUse.load()) {
+            waitForWriteQueueToDrain();
+        }
+
+        if (options.drainOutput && transport->isOpen()) {
+            // serial::Serial's flush waits for the driver's output buffer to be transmitted
+            //  (tcdrain on POSIX).
+            transport->flush();
+        }
+
+        if (shouldReopen) {
+            readHold.reset(new ReadPumpHold(*this));
+        }
+
+        auto switchStart = std::chrono::steady_clock::now();
+        report.drainDuration = std::chrono::duration_cast<std::chrono::microseconds>(switchStart - start);
+
+        SettingsPublisher publisher(*this);
+
+        // Changing the timeout never reconfigures the port.
+        if (settings.timeout != current.timeout) {
+            serial::Timeout timeout = settings.timeout;
+            transport->setTimeout(timeout);
+        }
+
+        auto applyLineSettings = [this](const HSerialSettings& settings, const HSerialSettings& current) {
+            if (settings.bytesize != current.bytesize) transport->setBytesize(settings.bytesize);
+            if (settings.parity != current.parity) transport->setParity(settings.parity);
+            if (settings.stopbits != current.stopbits) transport->setStopbits(settings.stopbits);
+            if (settings.flowcontrol != current.flowcontrol) transport->setFlowcontrol(settings.flowcontrol);
+            if (settings.baudrate != current.baudrate) transport->setBaudrate(settings.baudrate);
+        };
+
+        if (shouldReopen) {
+            // A closed serial::Serial only stores the settings, and open() configures the port
+            //  once with all of them. The read buffer is kept.
+            transport->close();
+            try {
+                applyLineSettings(settings, current);
+                transport->open();
+            } catch (...) {
+                // The new settings were rejected, so the port is reopened as it was. If that
+                //  fails too it is left closed. Either way the original error is reported.
+                try {
+                    applyLineSettings(current, readSettingsFromPort());
+                    transport->open();
+                } catch (...) {}
+                throw;
+            }
+            report.numReconfigurations = 1;
+            report.didReopen = true;
+            notifyEventObservers(readableEvent);
+        } else {
+            applyLineSettings(settings, current);
+            report.numReconfigurations = transport->isOpen() ? numLineChanges : 0;
+        }
+
+        report.switchDuration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - switchStart);
+        return report;
+    }
+
+    HSerialSettings HSerialAccess::getSettings(const HSerialController& controller) const {
+        AccessGuard guard(*this, controller, __func__);
+        return settingsCache.load();
+    }
+
     void HSerialAccess::flush(const HSerialController& controller) {
         AccessGuard guard(*this, controller, __func__);
         // Flushing functions are not serialized.
-        serial.flush();
+        discardQueuedWrites(false);
+        transport->flush();
+        flushReadBuffer();
     }
 
     void HSerialAccess::flushInput(const HSerialController& controller) {
         AccessGuard guard(*this, controller, __func__);
         // Flushing functions are not serialized.
-        serial.flushInput();
+        transport->flushInput();
+        flushReadBuffer();
     }
 
     void HSerialAccess::flushOutput(const HSerialController& controller) {
         AccessGuard guard(*this, controller, __func__);
         // Flushing functions are not serialized.
-        serial.flushOutput();
+        discardQueuedWrites(false);
+        transport->flushOutput();
     }
 
     void HSerialAccess::sendBreak(const HSerialController& controller, int duration) {
         AccessGuard guard(*this, controller, __func__);
         std::lock_guard<std::mutex> lock(accessSerializingMutex);
-        serial.sendBreak(duration);
+        transport->sendBreak(duration);
     }
 
     void HSerialAccess::setBreak(const HSerialController& controller, bool level) {
         AccessGuard guard(*this, controller, __func__);
         std::lock_guard<std::mutex> lock(accessSerializingMutex);
-        serial.setBreak(level);
+        transport->setBreak(level);
     }
 
     void HSerialAccess::setRTS(const HSerialController& controller, bool level) {
         AccessGuard guard(*this, controller, __func__);
         std::lock_guard<std::mutex> lock(accessSerializingMutex);
-        serial.setRTS(level);
+        transport->setRTS(level);
     }
 
     void HSerialAccess::setDTR(const HSerialController& controller, bool level) {
         AccessGuard guard(*this, controller, __func__);
         std::lock_guard<std::mutex> lock(accessSerializingMutex);
-        serial.setDTR(level);
+        transport->setDTR(level);
     }
 
     bool HSerialAccess::waitForChange(const HSerialController& controller) {
         AccessGuard guard(*this, controller, __func__);
         // Waiting functions are not serialized.
-        return serial.waitForChange();
+        return transport->waitForChange();
     }
 
     bool HSerialAccess::getCTS(const HSerialController& controller) {
         AccessGuard guard(*this, controller, __func__);
         std::lock_guard<std::mutex> lock(accessSerializingMutex);
-        return serial.getCTS();
+        return transport->getCTS();
     }
 
     bool HSerialAccess::getDSR(const HSerialController& controller) {
         AccessGuard guard(*this, controller, __func__);
         std::lock_guard<std::mutex> lock(accessSerializingMutex);
-        return serial.getDSR();
+        return transport->getDSR();
     }
 
     bool HSerialAccess::getRI(const HSerialController& controller) {
         AccessGuard guard(*this, controller, __func__);
         std::lock_guard<std::mutex> lock(accessSerializingMutex);
-        return serial.getRI();
+        return transport->getRI();
     }
 
     bool HSerialAccess::getCD(const HSerialController& controller) {
         AccessGuard guard(*this, controller, __func__);
         std::lock_guard<std::mutex> lock(accessSerializingMutex);
-        return serial.getCD();
+        return transport->getCD();
+    }
+
+    void HSerialAccess::enableReadBuffering(const HSerialController& controller, size_t capacity) {
+        AccessGuard guard(*this, controller, __func__);
+        if (capacity == 0) throw std::invalid_argument("The read buffer capacity must not be zero.");
+        std::lock_guard<std::mutex> lock(accessSerializingMutex);
+        {
+            std::lock_guard<std::mutex> rxLock(rx_mutex);
+            if (rx_pumpEnabled && rx_buffer->getCapacity() == capacity) {
+                return;
+            }
+        }
+        stopReadPump();
+        std::lock_guard<std::mutex> rxLock(rx_mutex);
+        if (!rx_buffer || rx_buffer->getCapacity() != capacity) {
+            // Carry over any unread bytes. The new buffer is never made too small to hold them.
+            std::unique_ptr<HSerialRingBuffer> newBuffer(new HSerialRingBuffer(std::max(capacity, rx_buffer ? rx_buffer->getSize() : 0)));
+            if (rx_buffer) {
+                std::vector<uint8_t> unread(rx_buffer->getSize());
+                rx_buffer->read(unread.data(), unread.size());
+                newBuffer->write(unread.data(), unread.size());
+            }
+            rx_buffer = std::move(newBuffer);
+        }
+        rx_pumpEnabled = true;
+        rx_pumpStop = false;
+        rx_inUse.store(true);
+        rx_pumpThread = std::thread(&HSerialAccess::runReadPump, this);
+    }
+
+    void HSerialAccess::disableReadBuffering(const HSerialController& controller) {
+        AccessGuard guard(*this, controller, __func__);
+        std::lock_guard<std::mutex> lock(accessSerializingMutex);
+        stopReadPump();
+    }
+
+    bool HSerialAccess::isReadBufferingEnabled(const HSerialController& controller) const {
+        AccessGuard guard(*this, controller, __func__);
+        std::lock_guard<std::mutex> rxLock(rx_mutex);
+        return rx_pumpEnabled;
+    }
+
+    uint64_t HSerialAccess::enqueueWrite(const HSerialController& controller, const uint8_t* data, size_t size) {
+        return enqueueWrite(controller, size, [data, size](uint8_t* buffer) {
+            std::memcpy(buffer, data, size);
+            return size;
+        });
+    }
+
+    uint64_t HSerialAccess::enqueueWrite(const HSerialController& controller, size_t maxSize, const std::function<size_t(uint8_t* buffer)>& fill) {
+        AccessGuard guard(*this, controller, __func__);
+        // Queued writes are not serialized.
+
+        std::unique_lock<std::mutex> lock(tx_mutex);
+        if (tx_error) rethrowWriteError();
+        if (maxSize == 0) return tx_enqueuedCount;
+
+        // While held (see WriteQueueHold) the port is being reopened.
+        tx_condition.wait(lock, [this, maxSize]() {
+            return (!tx_isHeld && (tx_pending.empty() || tx_pending.size() + maxSize <= writeQueueCapacity)) || tx_error || areWaitsInterrupted();
+        });
+        if (tx_error) rethrowWriteError();
+        if (tx_isHeld || (!tx_pending.empty() && tx_pending.size() + maxSize > writeQueueCapacity)) {
+            throwAccessInterrupted(__func__);
+        }
+        if (!transport->isOpen()) throw serial::PortNotOpenedException("HSerialAccess::enqueueWrite");
+
+        if (!tx_writerThread.joinable()) {
+            tx_writerThread = std::thread(&HSerialAccess::runWriter, this);
+        }
+
+        // The bytes are produced in place, at the end of the queue.
+        size_t oldSize = tx_pending.size();
+        tx_pending.resize(oldSize + maxSize);
+        size_t size;
+        try {
+            size = std::min(fill(tx_pending.data() + oldSize), maxSize);
+        } catch (...) {
+            tx_pending.resize(oldSize);
+            throw;
+        }
+        tx_pending.resize(oldSize + size);
+        if (size == 0) return tx_enqueuedCount;
+        tx_enqueuedCount += size;
+        uint64_t ticket = tx_enqueuedCount;
+
+        // Cleared in runWriter or discardQueuedWrites once the queue is empty again.
+        tx_inUse.store(true);
+
+        lock.unlock();
+        tx_condition.notify_all();
+        return ticket;
+    }
+
+    uint64_t HSerialAccess::enqueueWrite(const HSerialController& controller, const std::vector<uint8_t>& data) {
+        return enqueueWrite(controller, data.data(), data.size());
+    }
+
+    uint64_t HSerialAccess::enqueueWrite(const HSerialController& controller, const std::string& data) {
+        return enqueueWrite(controller, reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    }
+
+    bool HSerialAccess::waitForQueuedWrites(const HSerialController& controller, uint64_t ticket, const std::chrono::milliseconds& timeout) {
+        AccessGuard guard(*this, controller, __func__);
+        // Waiting functions are not serialized.
+        std::unique_lock<std::mutex> lock(tx_mutex);
+        ticket = std::min(ticket, tx_enqueuedCount);
+        bool isComplete = tx_condition.wait_for(lock, timeout, [this, ticket]() {
+            return tx_completedCount >= ticket || areWaitsInterrupted();
+        }) && tx_completedCount >= ticket;
+        if (tx_error) rethrowWriteError();
+        if (!isComplete && areWaitsInterrupted()) {
+            throwAccessInterrupted(__func__);
+        }
+        return isComplete;
+    }
+
+    size_t HSerialAccess::cancelQueuedWrites(const HSerialController& controller) {
+        AccessGuard guard(*this, controller, __func__);
+        return discardQueuedWrites(false);
+    }
+
+
+#pragma mark - Read Buffering
+
+    void HSerialAccess::runReadPump() {
+        // The chunk is allocated once. Bytes are read into it with rx_mutex unlocked and then
+        //  copied into rx_buffer, which makes racing with flushReadBuffer harmless (see rx_epoch).
+        std::unique_lock<std::mutex> lock(rx_mutex);
+        std::vector<uint8_t> chunk(std::min(readChunkSize, rx_buffer->getCapacity()));
+
+        while (!rx_pumpStop) {
+
+            if (rx_pumpHold || rx_pumpError || rx_buffer->isFull()) {
+                rx_condition.wait(lock);
+                continue;
+            }
+
+            uint64_t epoch = rx_epoch;
+            size_t space = std::min(chunk.size(), rx_buffer->getFree());
+            size_t count = 0;
+            bool isClosed = false;
+            bool idle = false;
+
+            rx_pumpBusy = true;
+            lock.unlock();
+            try {
+                if (!transport->isOpen()) {
+                    isClosed = true;
+                } else {
+                    bool readable = transport->waitReadable();
+                    size_t available = transport->available();
+                    if (available > 0) {
+                        // The bytes are already available, so this read does not block.
+                        count = transport->read(chunk.data(), std::min(space, available));
+                    } else if (!readable) {
+                        // waitReadable returns immediately if the read timeout is zero. Polling
+                        //  keeps the pump from spinning in that case.
+                        idle = true;
+                    }
+                }
+                lock.lock();
+            } catch (...) {
+                lock.lock();
+                rx_pumpError = std::current_exception();
+            }
+            rx_pumpBusy = false;
+
+            if (count > 0 && epoch == rx_epoch) {
+                rx_buffer->write(chunk.data(), count);
+                notifyEventObservers(readableEvent);
+            } else if (rx_pumpError) {
+                // The error is delivered by the next read.
+                notifyEventObservers(readableEvent);
+            }
+            rx_condition.notify_all();
+
+            if (isClosed) {
+                // Opening the port (or stopping the pump) notifies the condition. Checking
+                //  isOpen again with rx_mutex locked ensures that notification can't be missed.
+                rx_condition.wait(lock, [this]() {return rx_pumpStop || transport->isOpen();});
+            } else if (idle) {
+                rx_condition.wait_for(lock, readPumpPollInterval);
+            }
+        }
+    }
+
+    void HSerialAccess::stopReadPump() {
+        // Assumes accessSerializingMutex is locked (or that the object is being destroyed).
+        {
+            std::lock_guard<std::mutex> rxLock(rx_mutex);
+            if (!rx_pumpEnabled) {
+                return;
+            }
+            rx_pumpEnabled = false;
+            rx_pumpStop = true;
+        }
+        rx_condition.notify_all();
+        rx_pumpThread.join();
+        std::lock_guard<std::mutex> rxLock(rx_mutex);
+        updateReadBufferInUse();
+    }
+
+    serial::Timeout HSerialAccess::getCachedTimeout() const {
+        return settingsCache.load().timeout;
+    }
+
+    size_t HSerialAccess::bufferedRead(uint8_t* buffer, size_t size) {
+
+        serial::Timeout timeout = getCachedTimeout();
+
+        std::unique_lock<std::mutex> lock(rx_mutex);
+
+        if (!rx_pumpEnabled) {
+            // Leftover bytes are returned first, then the port is read directly.
+            size_t count = rx_buffer->read(buffer, size);
+            updateReadBufferInUse();
+            lock.unlock();
+            if (count < size) {
+                if (areWaitsInterrupted()) {
+                    // serial::Serial's own waits can't be interrupted, so don't start one.
+                    if (count > 0) return count;
+                    throwAccessInterrupted("read");
+                }
+                count += transport->read(buffer + count, size - count);
+            }
+            return count;
+        }
+
+        if (!transport->isOpen() && rx_buffer->isEmpty()) {
+            throw serial::PortNotOpenedException("HSerialAccess::read");
+        }
+
+        // These are the same rules serial::Serial uses: the total timeout is the constant plus the
+        //  multiplier for each requested byte, and the inter byte timeout applies once at least
+        //  one byte has been read.
+        auto now = std::chrono::steady_clock::now();
+        auto deadline = now + std::chrono::milliseconds(timeout.read_timeout_constant + uint64_t(timeout.read_timeout_multiplier) * size);
+        bool useInterByteTimeout = timeout.inter_byte_timeout != serial::Timeout::max();
+        auto lastByteTime = now;
+
+        size_t total = 0;
+        while (true) {
+            bool wasFull = rx_buffer->isFull();
+            size_t count = rx_buffer->read(buffer + total, size - total);
+            if (count > 0) {
+                total += count;
+                lastByteTime = std::chrono::steady_clock::now();
+                if (wasFull) {
+                    // The pump may be waiting for space.
+                    rx_condition.notify_all();
+                }
+            }
+            if (total == size || !rx_pumpEnabled) {
+                break;
+            }
+            if (rx_pumpError) {
+                if (total > 0) break;
+                rethrowPumpError();
+            }
+            if (areWaitsInterrupted()) {
+                if (total > 0) break;
+                throwAccessInterrupted("read");
+            }
+            auto limit = deadline;
+            if (useInterByteTimeout && total > 0) {
+                limit = std::min(limit, lastByteTime + std::chrono::milliseconds(timeout.inter_byte_timeout));
+            }
+            if (std::chrono::steady_clock::now() >= limit) {
+                break;
+            }
+            rx_condition.wait_until(lock, limit, [this]() {
+                return !rx_buffer->isEmpty() || !rx_pumpEnabled || rx_pumpError || areWaitsInterrupted();
+            });
+        }
+
+        return total;
+    }
+
+    template <typename Reserve>
+    size_t HSerialAccess::bufferedReadline(Reserve&& reserve, size_t size, const HSerialByteView& eol) {
+
+        if (eol.empty()) {
+            // serial::Serial treats every byte as the end of a line in this case.
+            uint8_t byte;
+            size_t count = size > 0 ? bufferedRead(&byte, 1) : 0;
+            if (count > 0) *reserve(1) = byte;
+            return count;
+        }
+
+        // serial::Serial reads lines one byte at a time, so its timeout applies per byte.
+        serial::Timeout timeout = getCachedTimeout();
+        auto perByteTimeout = std::chrono::milliseconds(timeout.read_timeout_constant + uint64_t(timeout.read_timeout_multiplier));
+
+        const uint8_t* pattern = eol.data;
+        const size_t patternSize = eol.size;
+
+        std::unique_lock<std::mutex> lock(rx_mutex);
+
+        // Moves bytes from the front of rx_buffer to the end of the line.
+        auto take = [this, &reserve](size_t count) {
+            bool wasFull = rx_buffer->isFull();
+            if (count > 0) rx_buffer->read(reserve(count), count);
+            if (wasFull && count > 0) rx_condition.notify_all();
+            return count;
+        };
+
+        size_t total = 0;
+        size_t scanFrom = 0;
+        auto deadline = std::chrono::steady_clock::now() + perByteTimeout;
+
+        while (true) {
+
+            size_t limit = size - total;
+            size_t found = rx_buffer->find(pattern, patternSize, scanFrom);
+
+            if (found != HSerialRingBuffer::npos && found + patternSize <= limit) {
+                total += take(found + patternSize);
+                break;
+            }
+
+            if (rx_buffer->getSize() >= limit) {
+                total += take(limit);
+                break;
+            }
+
+            if (rx_buffer->isFull()) {
+                // The line is longer than the buffer. Move out everything except what could be
+                //  the start of a split eol.
+                total += take(rx_buffer->getSize() - (patternSize - 1));
+            }
+
+            // Bytes already scanned don't need to be scanned again, except for the last few
+            //  which could be the start of an eol.
+            scanFrom = rx_buffer->getSize() >= patternSize ? rx_buffer->getSize() - (patternSize - 1) : 0;
+
+            if (rx_pumpError && rx_buffer->isEmpty()) {
+                if (total > 0) break;
+                rethrowPumpError();
+            }
+
+            if (!fillReadBuffer(lock, deadline)) {
+                if (total == 0 && areWaitsInterrupted()) {
+                    // Any partial line stays in rx_buffer for the next reader.
+                    throwAccessInterrupted("readline");
+                }
+                // Timed out (or interrupted after part of a long line was taken). Return the
+                //  partial line.
+                total += take(std::min(rx_buffer->getSize(), size - total));
+                break;
+            }
+            deadline = std::chrono::steady_clock::now() + perByteTimeout;
+        }
+
+        updateReadBufferInUse();
+        return total;
+    }
+
+    std::vector<std::string> HSerialAccess::bufferedReadlines(size_t size, const std::string& eol) {
+        // Same logic as serial::Serial: read lines until a line is cut short (by timeout) or the
+        //  size limit is reached.
+        std::vector<std::string> lines;
+        size_t total = 0;
+        while (total < size) {
+            std::string line;
+            size_t count;
+            try {
+                count = bufferedReadline(StringAppender(line), size - total, eol);
+            } catch (const AccessInterrupted&) {
+                // Lines already read have been taken from rx_buffer, so return them.
+                if (lines.empty()) throw;
+                break;
+            }
+            if (count == 0) {
+                break;
+            }
+            total += count;
+            bool isComplete = line.size() >= eol.size() && line.compare(line.size() - eol.size(), eol.size(), eol) == 0;
+            lines.push_back(std::move(line));
+            if (!isComplete) {
+                break;
+            }
+        }
+        return lines;
+    }
+
+    void HSerialAccess::ensureReadBuffer() {
+        std::lock_guard<std::mutex> rxLock(rx_mutex);
+        if (!rx_buffer) {
+            rx_buffer.reset(new HSerialRingBuffer(lineReadBufferCapacity));
+        }
+    }
+
+    bool HSerialAccess::fillReadBuffer(std::unique_lock<std::mutex>& lock, const std::chrono::steady_clock::time_point& deadline) {
+        // Assumes lock holds rx_mutex.
+
+        size_t oldSize = rx_buffer->getSize();
+
+        if (rx_pumpEnabled) {
+            rx_condition.wait_until(lock, deadline, [this, oldSize]() {
+                return rx_buffer->getSize() > oldSize || !rx_pumpEnabled || rx_pumpError || areWaitsInterrupted();
+            });
+            if (rx_buffer->getSize() > oldSize) {
+                return true;
+            }
+            if (!rx_pumpEnabled && std::chrono::steady_clock::now() < deadline && !areWaitsInterrupted()) {
+                // Buffering was disabled while waiting. Continue reading directly.
+                return fillReadBuffer(lock, deadline);
+            }
+            return false;
+        }
+
+        // Without the pump, take everything the driver already has (up to a chunk), or else wait
+        //  for a single byte. serial::Serial applies the timeout in the latter case, which is the
+        //  same per byte timeout its own readline uses. That wait can't be interrupted, so it isn't
+        //  started once waits are interrupted.
+        if (areWaitsInterrupted()) {
+            return false;
+        }
+        size_t space = std::min(readChunkSize, rx_buffer->getFree());
+        if (space == 0) {
+            // Only a reader can make room, and a byte read now would have nowhere to go.
+            return false;
+        }
+        uint64_t epoch = rx_epoch;
+        uint8_t chunk[readChunkSize];
+        lock.unlock();
+        size_t available = transport->available();
+        size_t count = transport->read(chunk, std::max<size_t>(1, std::min(space, available)));
+        lock.lock();
+        if (count > 0 && epoch == rx_epoch) {
+            // A flush while reading discards the chunk, just like with the pump.
+            rx_buffer->write(chunk, count);
+            // Other reading calls must now see the bytes, even if this call ends with an exception.
+            updateReadBufferInUse();
+            return true;
+        }
+        return count > 0;
+    }
+
+    void HSerialAccess::rethrowPumpError() {
+        // Assumes rx_mutex is locked.
+        std::exception_ptr error = rx_pumpError;
+        rx_pumpError = nullptr;
+        // The pump waits for the error to be delivered before using the port again.
+        rx_condition.notify_all();
+        std::rethrow_exception(error);
+    }
+
+    void HSerialAccess::updateReadBufferInUse() {
+        // Assumes rx_mutex is locked.
+        rx_inUse.store(rx_pumpEnabled || (rx_buffer && !rx_buffer->isEmpty()));
+    }
+
+    void HSerialAccess::flushReadBuffer() {
+        {
+            std::lock_guard<std::mutex> rxLock(rx_mutex);
+            if (!rx_buffer) {
+                return;
+            }
+            rx_buffer->clear();
+            rx_epoch += 1;
+            updateReadBufferInUse();
+        }
+        // The pump may be waiting for space.
+        rx_condition.notify_all();
+    }
+
+    void HSerialAccess::updateReadCRC(const HSerialController& controller, const uint8_t* data, size_t size) const {
+        if (controller.readCRC != nullptr && size > 0) {
+            controller.readCRC->update(data, size);
+        }
+    }
+
+
+#pragma mark - Write Queue
+
+    void HSerialAccess::runWriter() {
+
+        // Swapping this with tx_pending means both vectors keep their capacity.
+        std::vector<uint8_t> batch;
+
+        std::unique_lock<std::mutex> lock(tx_mutex);
+        while (true) {
+
+            tx_condition.wait(lock, [this]() {return tx_stop || !tx_pending.empty();});
+            if (tx_stop) {
+                break;
+            }
+
+            batch.clear();
+            batch.swap(tx_pending);
+            tx_writerBusy = true;
+            lock.unlock();
+
+            // Room was made for blocked enqueueWrite calls.
+            tx_condition.notify_all();
+
+            std::exception_ptr error;
+            try {
+                size_t written = 0;
+                while (written < batch.size()) {
+                    size_t count = transport->write(batch.data() + written, batch.size() - written);
+                    if (count == 0) {
+                        // serial::Serial returns early only when the write timeout expires.
+                        throw serial::SerialException("A queued write timed out.");
+                    }
+                    written += count;
+                }
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            lock.lock();
+            tx_writerBusy = false;
+            tx_completedCount += batch.size();
+            if (error) {
+                tx_error = error;
+                tx_completedCount += tx_pending.size();
+                tx_pending.clear();
+            }
+            if (tx_pending.empty()) {
+                tx_inUse.store(false);
+            }
+            lock.unlock();
+
+            tx_condition.notify_all();
+            notifyEventObservers(writableEvent);
+
+            lock.lock();
+        }
+    }
+
+    size_t HSerialAccess::discardQueuedWrites(bool waitForBatch) {
+        std::unique_lock<std::mutex> lock(tx_mutex);
+        size_t count = tx_pending.size();
+        tx_completedCount += count;
+        tx_pending.clear();
+        if (waitForBatch) {
+            tx_condition.wait(lock, [this]() {return !tx_writerBusy;});
+        }
+        // If a batch is in flight the writer clears tx_inUse when it finishes.
+        if (!tx_writerBusy) {
+            tx_inUse.store(false);
+        }
+        lock.unlock();
+        tx_condition.notify_all();
+        return count;
+    }
+
+    void HSerialAccess::drainWriteQueue() {
+        // Unlike waitForWriteQueueToDrain this ignores interruption, since the transition thread
+        //  may itself have interrupted waits (see blockAccessCalls). The wait is bounded: each
+        //  batch either completes or fails within the write timeout, and a failure discards the
+        //  rest of the queue.
+        std::unique_lock<std::mutex> lock(tx_mutex);
+        uint64_t ticket = tx_enqueuedCount;
+        tx_condition.wait(lock, [this, ticket]() {return tx_completedCount >= ticket;});
+    }
+
+    void HSerialAccess::waitForWriteQueueToDrain() {
+        std::unique_lock<std::mutex> lock(tx_mutex);
+        uint64_t ticket = tx_enqueuedCount;
+        tx_condition.wait(lock, [this, ticket]() {return tx_completedCount >= ticket || areWaitsInterrupted();});
+        if (tx_completedCount < ticket) {
+            throwAccessInterrupted("write");
+        }
+    }
+
+    void HSerialAccess::rethrowWriteError() {
+        // Assumes tx_mutex is locked.
+        std::exception_ptr error = tx_error;
+        tx_error = nullptr;
+        std::rethrow_exception(error);
+    }
+
+
+#pragma mark - Readiness Notification
+
+    uint64_t HSerialAccess::addEventObserver(std::function<void(uint32_t)> observer) {
+        uint32_t initialEvents = writableEvent;
+        if (transport->getNativeHandle() >= 0) {
+            // The observer can't know what the handle reported before it was watching.
+            initialEvents |= readableEvent;
+        }
+        {
+            std::lock_guard<std::mutex> rxLock(rx_mutex);
+            if ((rx_buffer && !rx_buffer->isEmpty()) || rx_pumpError) {
+                initialEvents |= readableEvent;
+            }
+        }
+        std::lock_guard<std::mutex> lock(ev_mutex);
+        uint64_t observerID = ev_nextObserverID++;
+        ev_observers.emplace_back(observerID, std::move(observer));
+        ev_observers.back().second(initialEvents);
+        return observerID;
+    }
+
+    void HSerialAccess::removeEventObserver(uint64_t observerID) {
+        std::lock_guard<std::mutex> lock(ev_mutex);
+        for (auto it = ev_observers.begin(); it != ev_observers.end(); ++it) {
+            if (it->first == observerID) {
+                ev_observers.erase(it);
+                return;
+            }
+        }
+    }
+
+    void HSerialAccess::notifyEventObservers(uint32_t events) {
+        std::lock_guard<std::mutex> lock(ev_mutex);
+        for (const auto& entry : ev_observers) {
+            entry.second(events);
+        }
+    }
+
+    int HSerialAccess::getNativeHandle() const {
+        return transport->getNativeHandle();
+    }
+
+    bool HSerialAccess::isTransportOpen() const {
+        return transport->isOpen();
+    }
+
+    void HSerialAccess::pullAvailableBytes() {
+        // Assumes rx_mutex is locked.
+        if (!rx_buffer) {
+            rx_buffer.reset(new HSerialRingBuffer(lineReadBufferCapacity));
+        }
+        if (transport->getNativeHandle() < 0) {
+            // Without a handle nothing would report the bytes, so they are left to the pump.
+            return;
+        }
+        size_t space = std::min(readChunkSize, rx_buffer->getFree());
+        if (space == 0) {
+            return;
+        }
+        size_t available = transport->available();
+        if (available == 0) {
+            return;
+        }
+        uint8_t chunk[readChunkSize];
+        size_t count = transport->read(chunk, std::min(space, available));
+        rx_buffer->write(chunk, count);
+        updateReadBufferInUse();
+    }
+
+    size_t HSerialAccess::tryRead(const HSerialController& controller, uint8_t* buffer, size_t size) {
+        AccessGuard guard(*this, controller, __func__);
+        std::lock_guard<std::mutex> rxLock(rx_mutex);
+        if (!rx_pumpEnabled) {
+            pullAvailableBytes();
+        }
+        if (rx_buffer->isEmpty()) {
+            if (rx_pumpError) rethrowPumpError();
+            if (!rx_pumpEnabled && transport->getNativeHandle() < 0) {
+                throw std::logic_error("Read buffering must be enabled for tryRead unless the transport has a native handle.");
+            }
+            return 0;
+        }
+        bool wasFull = rx_buffer->isFull();
+        size_t count = rx_buffer->read(buffer, size);
+        if (wasFull) rx_condition.notify_all();
+        updateReadBufferInUse();
+        updateReadCRC(controller, buffer, count);
+        return count;
+    }
+
+    bool HSerialAccess::tryReadline(const HSerialController& controller, std::string& buffer, size_t size, const HSerialByteView& eol) {
+        AccessGuard guard(*this, controller, __func__);
+        std::lock_guard<std::mutex> rxLock(rx_mutex);
+        if (!rx_pumpEnabled) {
+            pullAvailableBytes();
+        }
+        if (rx_buffer->isEmpty()) {
+            if (rx_pumpError) rethrowPumpError();
+            if (!rx_pumpEnabled && transport->getNativeHandle() < 0) {
+                throw std::logic_error("Read buffering must be enabled for tryReadline unless the transport has a native handle.");
+            }
+            return false;
+        }
+        size_t count;
+        size_t found = eol.empty() ? HSerialRingBuffer::npos : rx_buffer->find(eol.data, eol.size);
+        if (eol.empty()) {
+            // Like readline, every byte is a line in this case.
+            count = std::min<size_t>(1, size);
+        } else if (found != HSerialRingBuffer::npos && found + eol.size <= size) {
+            count = found + eol.size;
+        } else if (rx_buffer->getSize() >= size || rx_buffer->isFull()) {
+            // The line is too long for the size limit, or for the buffer.
+            count = std::min(size, rx_buffer->getSize());
+        } else {
+            return false;
+        }
+        bool wasFull = rx_buffer->isFull();
+        size_t oldSize = buffer.size();
+        buffer.resize(oldSize + count);
+        rx_buffer->read(reinterpret_cast<uint8_t*>(&buffer[oldSize]), count);
+        if (wasFull) rx_condition.notify_all();
+        updateReadBufferInUse();
+        updateReadCRC(controller, reinterpret_cast<const uint8_t*>(&buffer[oldSize]), count);
+        return true;
     }
 
 
 #pragma mark - Controller Access Blocking
 
     void HSerialAccess::blockAccessCalls(const HSerialController& controller) {
-        std::lock_guard<std::mutex> lock(stateMutex);
-        throwIfNotTransitionCorrect(controller, __func__);
-        throwIfNotActiveController(controller, __func__);
-        state_accessIsUnblocked = false;
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            throwIfNotTransitionCorrect(controller, __func__);
+            throwIfNotActiveController(controller, __func__);
+            state_accessIsUnblocked = false;
+        }
+        // Calls already waiting for bytes or queue space would otherwise hold up the transition
+        //  until their timeouts.
+        interruptWaits();
     }
 
     void HSerialAccess::unblockAccessCalls(const HSerialController& controller) {
@@ -605,6 +1950,7 @@ namespace hserial {
         throwIfNotTransitionCorrect(controller, __func__);
         throwIfNotActiveController(controller, __func__);
         state_accessIsUnblocked = true;
+        state_interruptingThread.store(std::thread::id());
         lock.unlock();
         accessUnblockedCondition.notify_all();
     }
@@ -613,7 +1959,7 @@ namespace hserial {
         std::unique_lock<std::mutex> lock(stateMutex);
         throwIfNotTransitionCorrect(controller, __func__);
         throwIfNotActiveController(controller, __func__);
-        return allAccessCallsReturnedCondition.wait_for(lock, timeout, [this]() {return state_numUnreturnedAccessCalls == 0;});
+        return allAccessCallsReturnedCondition.wait_for(lock, timeout, [this]() {return (state_accessGate.load() & accessGateCountMask) == 0;});
     }
 
 
@@ -773,10 +2119,16 @@ namespace hserial {
         //  - ensure all access calls have returned.
         if (oldActiveController) {
             oldActiveController->willMakeInactive(); // may throw
+
+            // Queued writes belong to the old controller, so they go out before anyone else gets
+            //  the port. (A controller that would rather drop them calls cancelQueuedWrites in
+            //  willMakeInactive.) The queue isn't an access call, so this doesn't count against
+            //  willMakeInactive's wait for access calls.
+            drainWriteQueue();
         }
 
         {
-            std::lock_guard<std::mutex> lock(stateMutex);
+            std::unique_lock<std::mutex> lock(stateMutex);
 
             // Ensure requirements are met for a safe transition. Namely:
             //  - access calls are blocked, and
@@ -796,16 +2148,20 @@ namespace hserial {
                 }
 
                 // There must be no unreturned access calls during the transition.
-                if (state_numUnreturnedAccessCalls > 0) {
+                uint64_t numUnreturned = state_accessGate.load() & accessGateCountMask;
+                if (numUnreturned > 0) {
                     if (oldActiveController) {
                         std::stringstream ss;
-                        ss << "There are " << state_numUnreturnedAccessCalls
+                        ss << "There are " << numUnreturned
                             << " unreturned access calls after willMakeInactive was called. Controller: "
                             << oldActiveController->getDescription() << ".";
                         throw std::logic_error(ss.str());
                     } else {
-                        // This should not happen.
-                        throw std::logic_error("There are unreturned access calls for a NULL controller.");
+                        // With no active controller the only counted calls are fast path calls
+                        //  from inactive controllers that entered just before the gate closed.
+                        //  They are about to leave and throw NotActiveController, so waiting is
+                        //  safe.
+                        allAccessCallsReturnedCondition.wait(lock, [this]() {return (state_accessGate.load() & accessGateCountMask) == 0;});
                     }
                 }
 
@@ -822,6 +2178,7 @@ namespace hserial {
 
             // Perform the transition.
             state_activeController.store(newController);
+            state_transitionRefused.store(false);
             if (alsoSetAsCurrentController) {
                 state_currentController.store(newController);
             }
@@ -830,11 +2187,29 @@ namespace hserial {
         if (oldActiveController) {
             oldActiveController->didMakeInactive(); // noexcept
         }
+
+        notifyEventObservers(transitionEvent);
     }
 
 
 #pragma mark - Other Internal Stuff
 
+    void HSerialAccess::leaveAccessGate() const {
+        uint64_t previous = state_accessGate.fetch_sub(1);
+        if ((previous & (accessGateClosedFlag | accessGateCountMask)) == (accessGateClosedFlag | 1)) {
+            // The count reached zero while a transition is in progress, so
+            //  waitForAllAccessCallsToReturn may be waiting. Locking stateMutex before notifying
+            //  ensures the waiter has either seen the zero count or is waiting on the condition.
+            // It is OK if the count is incremented after this point -- all the condition variable
+            //  signifies is that the number reached zero at some point. Guaranteeing that the
+            //  number of access calls stays at zero requires call blocking.
+            {
+                std::lock_guard<std::mutex> lock(stateMutex);
+            }
+            allAccessCallsReturnedCondition.notify_all();
+        }
+    }
+
     void HSerialAccess::throwIfNotActiveController(const HSerialController& controller, const char* funcName) const {
         // Assumes stateMutex is locked.
         if (&controller != state_activeController.load()) {
@@ -855,28 +2230,74 @@ namespace hserial {
         }
     }
 
+    bool HSerialAccess::areWaitsInterrupted() const {
+        std::thread::id thread = state_interruptingThread.load();
+        return thread != std::thread::id() && thread != std::this_thread::get_id();
+    }
+
+    void HSerialAccess::interruptWaits() {
+        state_interruptingThread.store(std::this_thread::get_id());
+        {
+            std::lock_guard<std::mutex> rxLock(rx_mutex);
+        }
+        rx_condition.notify_all();
+        {
+            std::lock_guard<std::mutex> txLock(tx_mutex);
+        }
+        tx_condition.notify_all();
+    }
+
+    void HSerialAccess::throwAccessInterrupted(const char* funcName) const {
+        std::stringstream ss;
+        ss << "The " << (funcName ? funcName : "NULL") << " call was interrupted because access calls were blocked for a transition.";
+        throw AccessInterrupted(ss.str());
+    }
+
+    HSerialSettings HSerialAccess::readSettingsFromPort() const {
+        HSerialSettings settings;
+        settings.baudrate = transport->getBaudrate();
+        settings.timeout = transport->getTimeout();
+        settings.bytesize = transport->getBytesize();
+        settings.parity = transport->getParity();
+        settings.stopbits = transport->getStopbits();
+        settings.flowcontrol = transport->getFlowcontrol();
+        return settings;
+    }
+
 
 #pragma mark - shared_ptr Creation
 
     /*! \copydoc HSerialDevice::MakeSharedEnabler */
     struct HSerialAccess::MakeSharedEnabler : public HSerialAccess {
-        MakeSharedEnabler(const std::string& deviceName) : HSerialAccess(deviceName) {}
+        MakeSharedEnabler(const std::string& deviceName, std::unique_ptr<HSerialTransport> transport) : HSerialAccess(deviceName, std::move(transport)) {}
     };
 
-    std::shared_ptr<HSerialAccess> HSerialAccess::createShared(const std::string& deviceName) {
-        return std::make_shared<MakeSharedEnabler>(deviceName);
+    std::shared_ptr<HSerialAccess> HSerialAccess::createShared(const std::string& deviceName, std::unique_ptr<HSerialTransport> transport) {
+        return std::make_shared<MakeSharedEnabler>(deviceName, std::move(transport));
     }
 
 
 #pragma mark - Construction/Destruction
 
-    HSerialAccess::HSerialAccess(const std::string& deviceName) {
-        // Setting the port here (instead of putting the serial object in the initializer list with
-        //  the deviceName as a parameter) means that the port stays closed until explicitly opened
-        //  by the user.
-        serial.setPort(deviceName);
+    HSerialAccess::HSerialAccess(const std::string& deviceName, std::unique_ptr<HSerialTransport> _transport) : transport(std::move(_transport)) {
+        // Transports are created closed, so the port stays closed until explicitly opened by the
+        //  user.
+        if (!transport) {
+            transport.reset(new HSerialSerialTransport(deviceName));
+        }
+        settingsCache.store(readSettingsFromPort());
     }
 
-    HSerialAccess::~HSerialAccess() {}
+    HSerialAccess::~HSerialAccess() {
+        stopReadPump();
+        {
+            std::lock_guard<std::mutex> lock(tx_mutex);
+            tx_stop = true;
+        }
+        tx_condition.notify_all();
+        if (tx_writerThread.joinable()) {
+            tx_writerThread.join();
+        }
+    }
 
 }
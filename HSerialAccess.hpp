@@ -13,11 +13,21 @@
 #include <memory>
 #include <vector>
 #include <mutex>
+#include <condition_variable>
 #include <chrono>
 #include <thread>
+#include <exception>
+#include <functional>
 
 #include <serial/serial.h>
 
+#include "HSerialRingBuffer.hpp"
+#include "HSerialByteView.hpp"
+#include "HSerialSettings.hpp"
+#include "HSerialSettingsCache.hpp"
+#include "HSerialTransport.hpp"
+#include "HSerialPort.hpp"
+
 
 namespace hserial {
 
@@ -30,12 +40,13 @@ namespace hserial {
      
      HSerialController instances rely on the access object to interact with the serial port.
 
-     An access object acts as a proxy for a `serial::Serial` object. It is
+     An access object acts as a proxy for a transport (by default, a `serial::Serial` object; see
+     HSerialTransport). It is
      created as needed by the HSerialDevice instance. If no objects need to use the serial port
      (i.e. there are no controllers) then there will be no access object.
 
      The access object also acts as a gatekeeper. It allows only one controller at a time (the 
-     active controller) to use the underlying Serial object.
+     active controller) to use the underlying transport.
      
      Access objects are owned by HSerialController instances. HSerialDevice keeps a weak reference
      to its access object, and it is from the device object that the controller gets
@@ -45,6 +56,9 @@ namespace hserial {
 
         friend class HSerialController; // uses the access
         friend class HSerialDevice; // creates the access as needed
+        friend class HSerialReactor; // observes readiness events
+        friend class HSerialFramer; // reads and writes for a controller
+        friend class HSerialScheduler; // makes controllers active
 
     public:
 
@@ -70,11 +84,13 @@ namespace hserial {
          HSerialDevice calls this function when it determines that an access object needs to be
          created.
 
+         If `transport` is `nullptr` the access uses an HSerialSerialTransport for `deviceName`.
+
          Note: HSerialController obtains its access object by calling HSerialDevice::getAccess().
 
          \see HSerialDevice::getAccess()
          */
-        static std::shared_ptr<HSerialAccess> createShared(const std::string& deviceName);
+        static std::shared_ptr<HSerialAccess> createShared(const std::string& deviceName, std::unique_ptr<HSerialTransport> transport);
         
         /// \} /Creating an Access Object
 
@@ -90,10 +106,51 @@ namespace hserial {
         /// \{
 
         bool isActive(const HSerialController& controller) const;
-        void makeActive(HSerialController& controller);
-        void makeInactive(HSerialController& controller);
+
+        /*!
+         \brief Returns false if `deadline` passed before the change could start, in which case
+         nothing was done. `time_point::max()` means no deadline.
+         */
+        bool makeActive(HSerialController& controller, int priority, const std::chrono::steady_clock::time_point& deadline);
+
+        void makeInactive(HSerialController& controller, int priority);
+
+        /*!
+         \brief Makes the controller inactive without a transition, if possible.
+
+         A parked controller is stored in state_activeController in a marked form, so it isn't
+         active to anyone, but its willMakeInactive callback hasn't run. The next transition
+         unparks it (in the TransitionBlocker constructor) and then deactivates it in the usual
+         way, unless it is the controller's own makeActive, which reclaims the port with a
+         single compare-exchange if no changes are waiting.
+
+         If a transition is in progress this calls makeInactive instead.
+
+         \see HSerialController::park
+         */
+        void park(HSerialController& controller);
+
         void removeFromAccess(HSerialController& controller);
 
+        /*!
+         \brief Lock-free.
+         */
+        bool isTransitionRequested(const HSerialController& controller) const;
+
+        /*!
+         \brief Returns the controller changes waiting for the port.
+
+         \see HSerialPort::getTransitionQueue
+         */
+        HSerialTransitionQueue getTransitionQueue();
+
+        /*!
+         \brief Enables or disables coalescing of queued activations.
+
+         \see HSerialPort::setTransitionCoalescing
+         */
+        void setTransitionCoalescing(bool enabled);
+
         /// \} /Controller Access Management
         
 
@@ -118,9 +175,10 @@ namespace hserial {
         size_t read(const HSerialController& controller, std::vector<uint8_t>& buffer, size_t size);
         size_t read(const HSerialController& controller, std::string& buffer, size_t size);
         std::string read(const HSerialController& controller, size_t size);
-        size_t readline(const HSerialController& controller, std::string& buffer, size_t size, std::string eol);
-        std::string readline(const HSerialController& controller, size_t size, std::string eol);
-        std::vector<std::string> readlines(const HSerialController& controller, size_t size, std::string eol);
+        size_t readline(const HSerialController& controller, std::string& buffer, size_t size, const std::string& eol);
+        size_t readline(const HSerialController& controller, uint8_t* buffer, size_t size, const HSerialByteView& eol);
+        std::string readline(const HSerialController& controller, size_t size, const std::string& eol);
+        std::vector<std::string> readlines(const HSerialController& controller, size_t size, const std::string& eol);
         size_t write(const HSerialController& controller, const uint8_t* data, size_t size);
         size_t write(const HSerialController& controller, const std::vector<uint8_t>& data);
         size_t write(const HSerialController& controller, const std::string &data);
@@ -138,6 +196,8 @@ namespace hserial {
         serial::flowcontrol_t getFlowcontrol(const HSerialController& controller) const;
         void setSettings(const HSerialController& controller, uint32_t baudrate, serial::Timeout timeout, serial::bytesize_t bytesize,
                          serial::parity_t parity, serial::stopbits_t stopbits, serial::flowcontrol_t flowcontrol, bool onlyIfDifferent);
+        HSerialSettingsReport applySettings(const HSerialController& controller, const HSerialSettings& settings, const HSerialSettingsOptions& options);
+        HSerialSettings getSettings(const HSerialController& controller) const;
         void flush(const HSerialController& controller);
         void flushInput(const HSerialController& controller);
         void flushOutput(const HSerialController& controller);
@@ -150,6 +210,15 @@ namespace hserial {
         bool getDSR(const HSerialController& controller);
         bool getRI(const HSerialController& controller);
         bool getCD(const HSerialController& controller);
+        void enableReadBuffering(const HSerialController& controller, size_t capacity);
+        void disableReadBuffering(const HSerialController& controller);
+        bool isReadBufferingEnabled(const HSerialController& controller) const;
+        uint64_t enqueueWrite(const HSerialController& controller, const uint8_t* data, size_t size);
+        uint64_t enqueueWrite(const HSerialController& controller, const std::vector<uint8_t>& data);
+        uint64_t enqueueWrite(const HSerialController& controller, const std::string& data);
+        uint64_t enqueueWrite(const HSerialController& controller, size_t maxSize, const std::function<size_t(uint8_t* buffer)>& fill);
+        bool waitForQueuedWrites(const HSerialController& controller, uint64_t ticket, const std::chrono::milliseconds& timeout);
+        size_t cancelQueuedWrites(const HSerialController& controller);
 
 
         /// \} /Controller Access Functions
@@ -181,7 +250,9 @@ namespace hserial {
          
          Used in waitForAllAccessCallsToReturn.
          
-         state_numUnreturnedAccessCalls is used for the predicate. Uses stateMutex.
+         The count portion of state_accessGate is used for the predicate. Uses stateMutex.
+         Notifications are made only while the gate is closed (i.e. during a transition), since
+         that is the only time anything waits on this condition.
          
          Internal use only.
          
@@ -265,13 +336,35 @@ namespace hserial {
 
          activeController is atomic so that other threads can read the instantaneous value
          without having to use a mutex.
+
+         While a controller is parked this holds its address with the low bit set (see park),
+         which doesn't compare equal to any controller. Only park, makeActive's reclaim, and the
+         TransitionBlocker constructor deal with the marked value. Everywhere else the value is
+         only compared, except during transitions, when it is never marked.
          */
         std::atomic<HSerialController*> state_activeController {NULL};
 
         /*!
-         \brief [Internal] This is the number of unreturned access calls.
-
-         Used as the predicate of allAccessCallsReturnedCondition. Protected by stateMutex.
+         \brief [Internal] The access gate: the number of unreturned access calls, a flag
+         indicating whether the gate is closed, and a transition epoch.
+
+         The low bits (accessGateCountMask) hold the number of unreturned access calls. The high
+         bit (accessGateClosedFlag) is set by the TransitionBlocker constructor and cleared by its
+         destructor, so the gate is closed exactly when a transition is in progress. The bits in
+         between (accessGateEpochMask) count transitions: the destructor advances them as it
+         reopens the gate.
+
+         This property is atomic so that the AccessGuard can use a lock-free fast path when there
+         is no transition. While the gate is open a guard checks that its controller is active
+         and then enters by atomically incrementing the count if and only if the gate word hasn't
+         changed (a compare-exchange), and leaves with a single decrement. Since every transition
+         closes the gate and advances the epoch, an unchanged gate word means the active
+         controller is still the one checked, so calls from inactive controllers are never
+         counted. Once the gate is closed no call can enter without locking stateMutex, so the
+         count can only go down until the transition thread (or an unblocked call) enters
+         through the slow path. This preserves the guarantees checked by performTransition.
+
+         The count portion is used as the predicate of allAccessCallsReturnedCondition.
 
          Declared mutable to support the const controller access functions. This is reasonable
          since any access function will both increment and decrement this counter -- the net
@@ -279,9 +372,29 @@ namespace hserial {
 
          Internal use only.
 
-         \see allAccessCallsReturnedCondition
+         \see allAccessCallsReturnedCondition, AccessGuard
          */
-        mutable int state_numUnreturnedAccessCalls = 0;
+        mutable std::atomic<uint64_t> state_accessGate {0};
+
+        /*!
+         \brief [Internal] The state_accessGate bit indicating that the gate is closed.
+         */
+        static const uint64_t accessGateClosedFlag = 0x8000000000000000ULL;
+
+        /*!
+         \brief [Internal] The state_accessGate bits holding the transition epoch.
+         */
+        static const uint64_t accessGateEpochMask = 0x7fffffff00000000ULL;
+
+        /*!
+         \brief [Internal] One step of the transition epoch.
+         */
+        static const uint64_t accessGateEpochUnit = 0x0000000100000000ULL;
+
+        /*!
+         \brief [Internal] The state_accessGate bits holding the number of unreturned access calls.
+         */
+        static const uint64_t accessGateCountMask = 0x00000000ffffffffULL;
 
         /*!
          \brief [Internal] Indicates when access is unblocked.
@@ -301,11 +414,12 @@ namespace hserial {
         /*!
          \brief [Internal] Indicates if a transition is in progress.
 
-         This property is changed only by TransitionBlocker objects.
+         This property is changed only by TransitionBlocker objects. The closed flag of
+         state_accessGate is always changed along with it (with stateMutex locked).
          
          Internal use only.
          */
-        bool state_transitionInProgress;
+        bool state_transitionInProgress = false;
 
         /*!
          \brief [Internal] Indicates if a concurrent active controller change is allowed.
@@ -324,6 +438,17 @@ namespace hserial {
          */
         std::atomic_bool state_concurrentActiveControllerChangeAllowed;
 
+        /*!
+         \brief [Internal] Indicates that a makeActive request was refused since the active
+         controller last changed.
+
+         Set by makeActive when the transition throws ControllerRefuses, and cleared by
+         performTransition. Atomic so that isTransitionRequested is lock-free.
+
+         Internal use only.
+         */
+        std::atomic_bool state_transitionRefused {false};
+
         /*!
          \brief [Internal] Identifies the transition thread.
 
@@ -332,6 +457,22 @@ namespace hserial {
          Internal use only.
          */
         std::thread::id state_transitionThread;
+
+        /*!
+         \brief [Internal] The thread that blocked access calls, or a default constructed id if
+         waits are not interrupted.
+
+         Set by blockAccessCalls and cleared whenever access calls are unblocked. While it is set,
+         waits inside access calls made on any other thread end early (see areWaitsInterrupted).
+         The transition thread is excluded since it may keep using the port while access is
+         blocked (e.g. to drain a protocol in willMakeInactive).
+
+         Atomic so that the waits can check it with rx_mutex or tx_mutex locked, without also
+         locking stateMutex.
+
+         Internal use only.
+         */
+        std::atomic<std::thread::id> state_interruptingThread {std::thread::id()};
         
         /// \} /State Variables
 
@@ -353,38 +494,568 @@ namespace hserial {
         std::mutex tb_mutex;
 
         /*!
-         \brief [Internal] Indicates the number of the transition that may proceed.
-         
-         When a TransitionBlocker's assigned number (see tb_nextNumber) equals the ready number
-         then the transition may proceed.
-         
-         Forms the predicate of tb_readyCondition.
-         
+         \brief [Internal] A TransitionBlocker waiting for its turn.
+
+         Lives on the waiting thread's stack.
+         */
+        struct TransitionWaiter {
+            enum class State {
+                queued,     // in tb_waiters
+                superseded, // skipped by coalescing, waiting for the outcome of a later activation
+                granted,    // has the turn
+                skipped     // skipped, and the later activation succeeded
+            };
+            uint64_t sequence;
+            int priority;
+            std::chrono::steady_clock::time_point enqueueTime;
+            const HSerialController* controller;
+            std::thread::id thread;
+            bool isActivation = false;
+            bool isSkippable = false;
+            State state = State::queued;
+
+            /*!
+             \brief The superseded waiters whose outcome depends on this one.
+             */
+            std::vector<TransitionWaiter*> superseded;
+
+            /*!
+             \brief If superseded, the waiter whose superseded list holds this one.
+             */
+            TransitionWaiter* supersededBy = nullptr;
+        };
+
+        /*!
+         \brief [Internal] The TransitionBlocker instances waiting for their turn, in arrival
+         order.
+
          For use by TransitionBlocker instances only.
          */
-        uint32_t tb_readyNumber = 0;
+        std::vector<TransitionWaiter*> tb_waiters;
 
         /*!
-         \brief [Internal] The next available transition number.
-         
-         A TransitionBlocker instance begins by assigning itself a number.
-         
+         \brief [Internal] The size of tb_waiters.
+
+         Changed with tb_mutex locked, but atomic so that isTransitionRequested can read it
+         without locking.
+         */
+        std::atomic<uint32_t> tb_numWaiting {0};
+
+        /*!
+         \brief [Internal] Indicates that a TransitionBlocker has its turn.
+
          For use by TransitionBlocker instances only.
          */
-        uint32_t tb_nextNumber = 0;
+        bool tb_isBusy = false;
 
         /*!
-         \brief [Internal] Indicates when the ready number changes.
-         
-         tb_readyNumber is used in the predicate.
-         
+         \brief [Internal] The sequence number for the next waiter, used to keep arrival order
+         among waiters of equal effective priority.
+
+         For use by TransitionBlocker instances only.
+         */
+        uint64_t tb_nextSequence = 0;
+
+        /*!
+         \brief [Internal] Indicates that queued activations may be coalesced.
+
+         \see HSerialPort::setTransitionCoalescing
+
+         For use by TransitionBlocker instances only.
+         */
+        bool tb_isCoalescing = false;
+
+        /*!
+         \brief [Internal] Indicates when a waiter has been granted its turn.
+
          For use by TransitionBlocker instances only.
          */
         std::condition_variable tb_readyCondition;
 
+        /*!
+         \brief [Internal] Gives the turn to the waiter with the highest effective priority, if
+         there is one.
+
+         Assumes tb_mutex is locked and tb_isBusy is false.
+
+         For use by TransitionBlocker instances only.
+         */
+        void grantNextTransition();
+
         /// \} /TransitionBlocker Variables
 
 
+#pragma mark - Read Buffering Variables
+
+        /*!
+         \name Read Buffering Variables
+
+         The `rx_` variables support read buffering (see enableReadBuffering). When read buffering
+         is enabled a pump thread owned by the access object drains the port into rx_buffer, and
+         the reading functions are served from that buffer.
+
+         The buffer belongs to the port, not to a controller. Like the driver's own input buffer,
+         its contents survive controller transitions and are discarded by flush, flushInput, and
+         close.
+
+         Unless noted otherwise these variables are protected by rx_mutex.
+         */
+        /// \{
+
+        /*!
+         \brief [Internal] Protects the `rx_` variables.
+
+         Declared mutable to support the const controller access functions.
+         */
+        mutable std::mutex rx_mutex;
+
+        /*!
+         \brief [Internal] Notified whenever the contents of rx_buffer or the pump state change.
+
+         Used both by reading functions waiting for data and by the pump thread waiting for space
+         (or for a hold to be released).
+         */
+        std::condition_variable rx_condition;
+
+        /*!
+         \brief [Internal] The received bytes not yet read by a controller.
+
+         Allocated by enableReadBuffering. It is kept after read buffering is disabled so that
+         bytes already taken from the port are not lost -- they are returned by the next reads.
+         */
+        std::unique_ptr<HSerialRingBuffer> rx_buffer;
+
+        /*!
+         \brief [Internal] Indicates that the reading functions must consult rx_buffer.
+
+         This is `true` if the pump is enabled or if rx_buffer still holds bytes. It is atomic
+         (and written with rx_mutex locked) so that the reading functions can skip the buffer
+         without locking rx_mutex in the common unbuffered case.
+         */
+        std::atomic_bool rx_inUse {false};
+
+        /*!
+         \brief [Internal] Indicates if the pump thread is running (or should be).
+         */
+        bool rx_pumpEnabled = false;
+
+        /*!
+         \brief [Internal] Tells the pump thread to exit.
+         */
+        bool rx_pumpStop = false;
+
+        /*!
+         \brief [Internal] Tells the pump thread to stay out of the transport.
+
+         Used by ReadPumpHold while the port is being closed.
+         */
+        bool rx_pumpHold = false;
+
+        /*!
+         \brief [Internal] Indicates that the pump thread is inside a transport call.
+         */
+        bool rx_pumpBusy = false;
+
+        /*!
+         \brief [Internal] Incremented whenever rx_buffer is flushed.
+
+         The pump thread reads into a private chunk with rx_mutex unlocked. It discards the chunk
+         if the epoch changed in the meantime, since those bytes were received before the flush.
+         */
+        uint64_t rx_epoch = 0;
+
+        /*!
+         \brief [Internal] An exception thrown by the transport on the pump thread.
+
+         The exception is rethrown to the next reading function call that finds rx_buffer empty.
+         The pump does not use the port again until the exception has been delivered or the port
+         is reopened.
+         */
+        std::exception_ptr rx_pumpError;
+
+        /*!
+         \brief [Internal] The pump thread.
+
+         Started by enableReadBuffering and joined by stopReadPump. Accessed only by those
+         functions (which are serialized by accessSerializingMutex) and the destructor.
+         */
+        std::thread rx_pumpThread;
+
+        /// \} /Read Buffering Variables
+
+
+#pragma mark - Internal Read Buffering Functions
+
+        /*!
+         \name Internal Read Buffering Functions
+         */
+        /// \{
+
+        /*!
+         \brief [Internal] The pump thread's main function.
+         */
+        void runReadPump();
+
+        /*!
+         \brief [Internal] Stops and joins the pump thread, if it is running.
+
+         Does not discard rx_buffer.
+         */
+        void stopReadPump();
+
+        /*!
+         \brief [Internal] Gets the port's timeout from settingsCache.
+         */
+        serial::Timeout getCachedTimeout() const;
+
+        /*!
+         \brief [Internal] The buffered implementation of the read functions.
+
+         Has the same timeout semantics as `serial::Serial::read`. If the pump is not enabled
+         then leftover bytes in rx_buffer are returned first and the remainder is read from the
+         port directly.
+         */
+        size_t bufferedRead(uint8_t* buffer, size_t size);
+
+        /*!
+         \brief [Internal] The buffered implementation of the readline functions.
+         
+         Has the same semantics as `serial::Serial::readline`, including the timeout being applied
+         per byte.
+
+         Line bytes are moved out of rx_buffer to the pointer returned by `reserve(count)`, which
+         must have room for `count` more bytes. This lets the same implementation fill a
+         std::string or a caller-owned buffer. Defined (and instantiated) in HSerialAccess.cpp.
+         */
+        template <typename Reserve>
+        size_t bufferedReadline(Reserve&& reserve, size_t size, const HSerialByteView& eol);
+
+        /*!
+         \brief [Internal] Creates rx_buffer if read buffering has never been enabled.
+
+         The line reading functions need rx_buffer to hold bytes read past the end of a line.
+         */
+        void ensureReadBuffer();
+
+        /*!
+         \brief [Internal] The buffered implementation of readlines.
+         */
+        std::vector<std::string> bufferedReadlines(size_t size, const std::string& eol);
+
+        /*!
+         \brief [Internal] Adds bytes just returned by a reading function to the controller's
+         read CRC, if it has one (see HSerialController::setReadCRC).
+
+         Called right after the bytes are copied out, while they are still in cache.
+         */
+        void updateReadCRC(const HSerialController& controller, const uint8_t* data, size_t size) const;
+
+        /*!
+         \brief [Internal] Waits for rx_buffer to grow, or reads from the port directly if the
+         pump is not enabled.
+
+         Without the pump, this reads whatever the driver has available (at least one byte, at
+         most a chunk or the free space of rx_buffer) with a single call. Nothing is read if
+         rx_buffer is full.
+
+         Assumes `lock` holds rx_mutex. It may be unlocked and relocked.
+
+         \returns `true` if bytes were added to rx_buffer, `false` on timeout or if rx_buffer is
+         full.
+         */
+        bool fillReadBuffer(std::unique_lock<std::mutex>& lock, const std::chrono::steady_clock::time_point& deadline);
+
+        /*!
+         \brief [Internal] Rethrows and clears rx_pumpError, if set.
+
+         Assumes rx_mutex is locked.
+         */
+        void rethrowPumpError();
+
+        /*!
+         \brief [Internal] Updates rx_inUse after bytes have been taken from rx_buffer.
+
+         Assumes rx_mutex is locked.
+         */
+        void updateReadBufferInUse();
+
+        /*!
+         \brief [Internal] Discards the contents of rx_buffer, along with any chunk the pump
+         thread is currently reading.
+         */
+        void flushReadBuffer();
+
+        /// \} /Internal Read Buffering Functions
+
+
+#pragma mark - Write Queue Variables
+
+        /*!
+         \name Write Queue Variables
+
+         The `tx_` variables support the write queue (see enqueueWrite). Queued bytes are appended
+         to tx_pending, and a writer thread owned by the access object repeatedly takes everything
+         pending and writes it with a single call. Many small writes are thereby coalesced into
+         a few large ones.
+
+         The write queue is not an access call. Instead performTransition drains it after the
+         old controller's willMakeInactive returns (see drainWriteQueue), so the port is never
+         handed to another controller while queued bytes are still going out, however long the
+         queue is. A controller that would rather discard its queued bytes can call
+         cancelQueuedWrites in willMakeInactive.
+
+         Unless noted otherwise these variables are protected by tx_mutex.
+         */
+        /// \{
+
+        /*!
+         \brief [Internal] Protects the `tx_` variables.
+         */
+        std::mutex tx_mutex;
+
+        /*!
+         \brief [Internal] Notified whenever tx_pending or the completion count changes.
+         */
+        std::condition_variable tx_condition;
+
+        /*!
+         \brief [Internal] Bytes queued but not yet taken by the writer thread.
+
+         The writer swaps this vector with its batch vector, so in the steady state neither is
+         reallocated.
+         */
+        std::vector<uint8_t> tx_pending;
+
+        /*!
+         \brief [Internal] The total number of bytes ever queued.
+
+         Tickets returned by enqueueWrite are values of this counter.
+         */
+        uint64_t tx_enqueuedCount = 0;
+
+        /*!
+         \brief [Internal] The total number of queued bytes that have been handed to the driver,
+         discarded, or lost to an error.
+
+         A ticket is complete when this counter reaches it.
+         */
+        uint64_t tx_completedCount = 0;
+
+        /*!
+         \brief [Internal] Indicates that the writer thread has a batch in flight.
+         */
+        bool tx_writerBusy = false;
+
+        /*!
+         \brief [Internal] Makes enqueueWrite wait. Used by WriteQueueHold while the port is
+         being reopened.
+         */
+        bool tx_isHeld = false;
+
+        /*!
+         \brief [Internal] Indicates that the write queue is in use.
+
+         This is `true` exactly when tx_pending is non-empty or a batch is in flight. It is
+         atomic so that write() can check it without locking tx_mutex.
+         */
+        std::atomic_bool tx_inUse {false};
+
+        /*!
+         \brief [Internal] An exception thrown by the transport on the writer thread.
+
+         When a batch fails the rest of the queue is discarded, and the exception is rethrown by
+         the next call to enqueueWrite or waitForQueuedWrites.
+         */
+        std::exception_ptr tx_error;
+
+        /*!
+         \brief [Internal] Tells the writer thread to exit.
+         */
+        bool tx_stop = false;
+
+        /*!
+         \brief [Internal] The writer thread. Started by the first call to enqueueWrite.
+         */
+        std::thread tx_writerThread;
+
+        /// \} /Write Queue Variables
+
+
+#pragma mark - Internal Write Queue Functions
+
+        /*!
+         \name Internal Write Queue Functions
+         */
+        /// \{
+
+        /*!
+         \brief [Internal] The writer thread's main function.
+         */
+        void runWriter();
+
+        /*!
+         \brief [Internal] Discards the pending bytes of the write queue.
+
+         If `waitForBatch` is `true` this also waits for a batch in flight to finish (this is
+         required before closing the port).
+
+         \returns The number of bytes discarded.
+         */
+        size_t discardQueuedWrites(bool waitForBatch);
+
+        /*!
+         \brief [Internal] Waits until every byte queued so far has been completed.
+
+         Used by the synchronous write functions so that they don't overtake queued bytes.
+         */
+        void waitForWriteQueueToDrain();
+
+        /*!
+         \brief [Internal] Waits until every byte queued so far has been completed, even if
+         waits are interrupted.
+
+         Used by performTransition, after the old controller's willMakeInactive.
+         */
+        void drainWriteQueue();
+
+        /*!
+         \brief [Internal] Rethrows and clears tx_error, if set.
+
+         Assumes tx_mutex is locked.
+         */
+        void rethrowWriteError();
+
+        /// \} /Internal Write Queue Functions
+
+
+#pragma mark - Readiness Notification
+
+        /*!
+         \name Readiness Notification
+
+         Event observers (installed by HSerialReactor instances) are told when the port may have
+         become readable or writable, so that they don't need a thread blocked on the port. Any
+         number of observers may be installed.
+
+         If the transport has a native handle (see HSerialTransport::getNativeHandle) an
+         observer can poll it for readability directly, and tryRead and tryReadline take bytes
+         from the transport without waiting, so no read pump is needed. serial::Serial does not
+         expose its file descriptor, so for it readiness is reported by the threads that do touch
+         the port: the read pump reports readableEvent after adding bytes to rx_buffer (or after
+         storing an error). Either way the write queue's writer thread reports writableEvent after
+         finishing a batch, and opening the port reports readableEvent (since the handle isn't
+         watched while the port is closed).
+
+         performTransition reports transitionEvent after the active controller changes, so that
+         pending asynchronous operations of a controller that lost the active role can be failed.
+         */
+        /// \{
+
+        static const uint32_t readableEvent = 0x1;
+        static const uint32_t writableEvent = 0x2;
+        static const uint32_t transitionEvent = 0x4;
+
+        /*!
+         \brief [Internal] Protects ev_observers.
+
+         Observers are called with this mutex locked, so once removeEventObserver returns the
+         observer is guaranteed not to be running. Observers must not call back into the access
+         object.
+
+         May be locked while rx_mutex or tx_mutex is locked, but not the other way around.
+         */
+        std::mutex ev_mutex;
+
+        /*!
+         \brief [Internal] The event observers, with the ids returned by addEventObserver.
+         */
+        std::vector<std::pair<uint64_t, std::function<void(uint32_t)>>> ev_observers;
+
+        uint64_t ev_nextObserverID = 1;
+
+        /*!
+         \brief [Internal] Installs an event observer.
+
+         If rx_buffer already holds bytes (or the transport has a native handle) the new observer
+         is immediately told the port is readable. It is always told the port is writable.
+
+         \returns An id to pass to removeEventObserver.
+         */
+        uint64_t addEventObserver(std::function<void(uint32_t)> observer);
+
+        /*!
+         \brief [Internal] Removes an event observer. Does nothing if the id is unknown.
+         */
+        void removeEventObserver(uint64_t observerID);
+
+        /*!
+         \brief [Internal] Calls the event observers.
+         */
+        void notifyEventObservers(uint32_t events);
+
+        /*!
+         \brief [Internal] Returns the transport's native handle, or -1.
+         \see HSerialTransport::getNativeHandle
+         */
+        int getNativeHandle() const;
+
+        /*!
+         \brief [Internal] Indicates if the transport is open. Unlike isOpen this is not an access
+         call, so the answer is only a hint. Used by HSerialReactor to decide whether to watch
+         the native handle.
+         */
+        bool isTransportOpen() const;
+
+        /*!
+         \brief [Internal] Takes bytes from rx_buffer without waiting.
+
+         Used by HSerialReactor to complete asynchronous reads. Read buffering must be enabled,
+         unless the transport has a native handle, in which case the bytes the transport already
+         has are moved to rx_buffer first (see pullAvailableBytes). Like the other reads, the
+         controller's read CRC is updated with the bytes returned.
+
+         \returns The number of bytes read, which is zero if no bytes are available.
+         \throws hserial::NotActiveController
+         \throws std::logic_error If read buffering is not enabled, the transport has no native
+         handle, and rx_buffer is empty.
+         \throws serial::SerialException Rethrown from the read pump if rx_buffer is empty, or
+         thrown by the transport.
+         */
+        size_t tryRead(const HSerialController& controller, uint8_t* buffer, size_t size);
+
+        /*!
+         \brief [Internal] Takes a line from rx_buffer without waiting.
+
+         A line is complete when rx_buffer contains the eol, or when it holds `size` bytes. Used
+         by HSerialReactor to complete asynchronous line reads. Read buffering must be enabled,
+         unless the transport has a native handle (see tryRead).
+
+         \returns `true` if a line was appended to `buffer`.
+         \throws hserial::NotActiveController
+         \throws std::logic_error If read buffering is not enabled, the transport has no native
+         handle, and rx_buffer is empty.
+         \throws serial::SerialException Rethrown from the read pump if rx_buffer is empty, or
+         thrown by the transport.
+         */
+        bool tryReadline(const HSerialController& controller, std::string& buffer, size_t size, const HSerialByteView& eol);
+
+        /*!
+         \brief [Internal] Moves the bytes the transport already has into rx_buffer, without
+         waiting. Used by tryRead and tryReadline when the pump isn't running.
+
+         Creates rx_buffer if necessary. Does nothing else if the transport has no native
+         handle, since then nothing would report the bytes and the operation would never be
+         tried again.
+
+         Assumes rx_mutex is locked and the pump is not enabled. The transport is called with
+         rx_mutex locked: available() has reported the bytes, so the read returns at once
+         (unless another thread reads them first).
+         */
+        void pullAvailableBytes();
+
+        /// \} /Readiness Notification
+
+
 #pragma mark - Internal Access Management Functions
 
         /*!
@@ -506,6 +1177,18 @@ namespace hserial {
          */
         /// \{
 
+        /*!
+         \brief [Internal] Decrements the unreturned access calls count of state_accessGate.
+
+         If this was the last unreturned call during a transition then
+         allAccessCallsReturnedCondition is notified.
+
+         Used by AccessGuard.
+
+         Internal use only.
+         */
+        void leaveAccessGate() const;
+
         /*!
          \brief [Internal] Throws NotActiveController if the controller is not active.
 
@@ -533,6 +1216,28 @@ namespace hserial {
          */
         void throwIfNotTransitionCorrect(const HSerialController& controller, const char* funcName);
 
+        /*!
+         \brief [Internal] Indicates if waits on the calling thread should end early because
+         access calls have been blocked.
+
+         \see state_interruptingThread
+         */
+        bool areWaitsInterrupted() const;
+
+        /*!
+         \brief [Internal] Sets state_interruptingThread to the calling thread and wakes the waits
+         on rx_condition and tx_condition so that they check it.
+
+         Assumes stateMutex is not locked. rx_mutex and tx_mutex are locked briefly so that a
+         wait can't miss the wakeup.
+         */
+        void interruptWaits();
+
+        /*!
+         \brief [Internal] Throws AccessInterrupted.
+         */
+        [[noreturn]] void throwAccessInterrupted(const char* funcName) const;
+
         /*!
          \brief [Internal] Called by createShared().
 
@@ -540,16 +1245,38 @@ namespace hserial {
 
          \see createShared(), HSerialDevice::getAccess()
          */
-        HSerialAccess(const std::string& deviceName);
+        HSerialAccess(const std::string& deviceName, std::unique_ptr<HSerialTransport> transport);
 
         ~HSerialAccess();
 
         /*!
-         \brief [Internal] The serial::Serial object for actually using the port.
+         \brief [Internal] The transport for actually using the port. Never null, and never
+         replaced.
          
          Internal use only.
          */
-        serial::Serial serial;
+        std::unique_ptr<HSerialTransport> transport;
+
+        /*!
+         \brief [Internal] The port's settings, readable without locking.
+
+         This is the authoritative copy for the getters and for the `onlyIfDifferent`
+         comparisons. It is republished from the transport (by a SettingsPublisher) after every
+         call that changes a setting, even if that call throws, so it never disagrees with the
+         port for longer than the setter call itself.
+
+         Written only with accessSerializingMutex locked.
+
+         Internal use only.
+         */
+        HSerialSettingsCache settingsCache;
+
+        /*!
+         \brief [Internal] Reads the settings from the transport.
+
+         Assumes accessSerializingMutex is locked (or that the object is being constructed).
+         */
+        HSerialSettings readSettingsFromPort() const;
 
         /// \} /Other Internal Stuff
 
@@ -561,6 +1288,9 @@ namespace hserial {
         class AccessGuard; // used to control and monitor access calls
         class AccessUnblocker; // used to automatically unblock access calls after a transition
         class TransitionBlocker; // used to queue and serialize controller changes
+        class ReadPumpHold; // used to keep the read pump out of the transport
+        class WriteQueueHold; // used to keep queued writes out of the transport
+        class SettingsPublisher; // used to update settingsCache after the port is reconfigured
 
     };
 }
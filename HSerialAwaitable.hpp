@@ -0,0 +1,154 @@
+//
+//  HSerialAwaitable.hpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+
+#ifndef HSerialAwaitable_hpp
+#define HSerialAwaitable_hpp
+
+#include "HSerialReactor.hpp"
+#include "HSerialController.hpp"
+
+// The rest of HSerial is C++11, so the awaitables are only defined when the including
+//  translation unit is compiled with coroutine support.
+#if defined(__linux__) && defined(__cpp_impl_coroutine)
+
+#include <coroutine>
+
+
+namespace hserial {
+
+    /// \cond internal_docs
+
+    namespace detail {
+
+        /*!
+         \brief [Internal] The common part of the awaitables. Starting the operation is left to
+         the derived class; the completion callback stores the result and resumes the coroutine
+         on the reactor's thread.
+         */
+        template <typename Result>
+        class ReactorAwaitable {
+
+        public:
+
+            ReactorAwaitable(HSerialReactor& _reactor, HSerialController& _controller) : reactor(_reactor), controller(_controller) {}
+
+            bool await_ready() const noexcept {
+                return false;
+            }
+
+            Result await_resume() {
+                if (error) {
+                    std::rethrow_exception(error);
+                }
+                return std::move(result);
+            }
+
+        protected:
+
+            HSerialReactor& reactor;
+            HSerialController& controller;
+            std::exception_ptr error;
+            Result result {};
+
+            std::function<void(std::exception_ptr, Result)> makeCallback(std::coroutine_handle<> handle) {
+                return [this, handle](std::exception_ptr _error, Result _result) {
+                    error = _error;
+                    result = std::move(_result);
+                    handle.resume();
+                };
+            }
+        };
+    }
+
+    /// \endcond internal_docs
+
+    /*!
+     \brief Awaitable returned by HSerialController::asyncRead.
+     */
+    class ReadAwaitable : public detail::ReactorAwaitable<size_t> {
+    public:
+        ReadAwaitable(HSerialReactor& _reactor, HSerialController& _controller, uint8_t* _buffer, size_t _size)
+        : ReactorAwaitable(_reactor, _controller), buffer(_buffer), size(_size) {}
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            reactor.asyncRead(controller, buffer, size, makeCallback(handle));
+        }
+
+    private:
+        uint8_t* buffer;
+        size_t size;
+    };
+
+    /*!
+     \brief Awaitable returned by HSerialController::asyncReadline.
+     */
+    class ReadlineAwaitable : public detail::ReactorAwaitable<std::string> {
+    public:
+        ReadlineAwaitable(HSerialReactor& _reactor, HSerialController& _controller, size_t _size, const std::string& _eol)
+        : ReactorAwaitable(_reactor, _controller), size(_size), eol(_eol) {}
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            reactor.asyncReadline(controller, size, eol, makeCallback(handle));
+        }
+
+    private:
+        size_t size;
+        std::string eol;
+    };
+
+    /*!
+     \brief Awaitable returned by HSerialController::asyncWrite.
+     */
+    class WriteAwaitable : public detail::ReactorAwaitable<size_t> {
+    public:
+        WriteAwaitable(HSerialReactor& _reactor, HSerialController& _controller, const uint8_t* _data, size_t _size)
+        : ReactorAwaitable(_reactor, _controller), data(_data), size(_size) {}
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            reactor.asyncWrite(controller, data, size, makeCallback(handle));
+        }
+
+    private:
+        const uint8_t* data;
+        size_t size;
+    };
+
+    /*!
+     \brief Awaitable returned by HSerialController::asyncWaitForChange.
+     */
+    class ChangeAwaitable : public detail::ReactorAwaitable<bool> {
+    public:
+        ChangeAwaitable(HSerialReactor& _reactor, HSerialController& _controller)
+        : ReactorAwaitable(_reactor, _controller) {}
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            reactor.asyncWaitForChange(controller, makeCallback(handle));
+        }
+    };
+
+    inline ReadAwaitable HSerialController::asyncRead(HSerialReactor& reactor, uint8_t* buffer, size_t size) {
+        return ReadAwaitable(reactor, *this, buffer, size);
+    }
+
+    inline ReadlineAwaitable HSerialController::asyncReadline(HSerialReactor& reactor, size_t size, const std::string& eol) {
+        return ReadlineAwaitable(reactor, *this, size, eol);
+    }
+
+    inline WriteAwaitable HSerialController::asyncWrite(HSerialReactor& reactor, const uint8_t* data, size_t size) {
+        return WriteAwaitable(reactor, *this, data, size);
+    }
+
+    inline ChangeAwaitable HSerialController::asyncWaitForChange(HSerialReactor& reactor) {
+        return ChangeAwaitable(reactor, *this);
+    }
+
+}
+
+#endif /* __linux__ && __cpp_impl_coroutine */
+
+#endif /* HSerialAwaitable_hpp */
@@ -0,0 +1,65 @@
+//
+//  HSerialByteView.hpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+
+#ifndef HSerialByteView_hpp
+#define HSerialByteView_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+namespace hserial {
+
+    /*!
+     \brief A non-owning reference to a contiguous sequence of bytes.
+
+     This is used by the non-allocating access functions (for example,
+     HSerialController::readline(uint8_t*, size_t, const HSerialByteView&)) to pass delimiters
+     and return results without copying them into a std::string. It can be implicitly constructed
+     from a string literal, a std::string, or a std::vector<uint8_t>.
+
+     A view does not keep the bytes alive. The owner of the bytes must outlive the view.
+     */
+    struct HSerialByteView {
+
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+
+        HSerialByteView() {}
+        HSerialByteView(const uint8_t* _data, size_t _size) : data(_data), size(_size) {}
+        HSerialByteView(const char* _data, size_t _size) : data(reinterpret_cast<const uint8_t*>(_data)), size(_size) {}
+        HSerialByteView(const char* str) : data(reinterpret_cast<const uint8_t*>(str)), size(std::strlen(str)) {}
+        HSerialByteView(const std::string& str) : data(reinterpret_cast<const uint8_t*>(str.data())), size(str.size()) {}
+        HSerialByteView(const std::vector<uint8_t>& bytes) : data(bytes.data()), size(bytes.size()) {}
+
+        const uint8_t* begin() const { return data; }
+        const uint8_t* end() const { return data + size; }
+        bool empty() const { return size == 0; }
+
+        /*!
+         \brief Indicates if the view ends with the given bytes.
+         */
+        bool endsWith(const HSerialByteView& suffix) const {
+            if (suffix.size > size) return false;
+            return suffix.size == 0 || std::memcmp(data + size - suffix.size, suffix.data, suffix.size) == 0;
+        }
+
+        /*!
+         \brief Returns a copy of the bytes as a std::string. This allocates.
+         */
+        std::string toString() const {
+            return std::string(reinterpret_cast<const char*>(data), size);
+        }
+    };
+
+}
+
+#endif /* HSerialByteView_hpp */
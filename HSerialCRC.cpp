@@ -0,0 +1,411 @@
+//
+//  HSerialCRC.cpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+
+#include "HSerialCRC.hpp"
+
+#include <stdexcept>
+
+// The hardware kernels use GCC/Clang builtins and the target attribute, so they are only
+//  compiled with those compilers.
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define HSERIAL_CRC_PCLMUL 1
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+#define HSERIAL_CRC_ARMV8 1
+#include <arm_acle.h>
+#if defined(__linux__)
+#include <sys/auxv.h>
+#endif
+#if defined(__clang__)
+#define HSERIAL_CRC_ARMV8_TARGET __attribute__((target("crc")))
+#else
+#define HSERIAL_CRC_ARMV8_TARGET __attribute__((target("+crc")))
+#endif
+#endif
+
+
+namespace hserial {
+
+    namespace crc {
+
+        namespace {
+
+            typedef uint32_t (*CRCFunction)(uint32_t, const uint8_t*, size_t);
+
+            /*!
+             \brief Slice-by-8 tables. t[k][b] is the effect on the register of byte b followed by
+             k zero bytes.
+             */
+            struct Tables {
+                uint32_t t[8][256];
+            };
+
+            uint32_t reflect(uint32_t value, int width) {
+                uint32_t result = 0;
+                for (int i = 0; i < width; ++i) {
+                    if (value & (uint32_t(1) << i)) {
+                        result |= uint32_t(1) << (width - 1 - i);
+                    }
+                }
+                return result;
+            }
+
+            Tables makeReflectedTables(uint32_t polynomial, int width) {
+                Tables tables;
+                const uint32_t reflectedPolynomial = reflect(polynomial, width);
+                for (uint32_t b = 0; b < 256; ++b) {
+                    uint32_t c = b;
+                    for (int i = 0; i < 8; ++i) {
+                        c = (c & 1) ? (c >> 1) ^ reflectedPolynomial : (c >> 1);
+                    }
+                    tables.t[0][b] = c;
+                }
+                for (int k = 1; k < 8; ++k) {
+                    for (int b = 0; b < 256; ++b) {
+                        uint32_t c = tables.t[k - 1][b];
+                        tables.t[k][b] = (c >> 8) ^ tables.t[0][c & 0xFF];
+                    }
+                }
+                return tables;
+            }
+
+            Tables makeNormalTables(uint32_t polynomial, int width) {
+                Tables tables;
+                const uint32_t mask = (width == 32) ? 0xFFFFFFFF : (uint32_t(1) << width) - 1;
+                const uint32_t top = uint32_t(1) << (width - 1);
+                for (uint32_t b = 0; b < 256; ++b) {
+                    uint32_t c = b << (width - 8);
+                    for (int i = 0; i < 8; ++i) {
+                        c = (c & top) ? ((c << 1) ^ polynomial) : (c << 1);
+                    }
+                    tables.t[0][b] = c & mask;
+                }
+                for (int k = 1; k < 8; ++k) {
+                    for (int b = 0; b < 256; ++b) {
+                        uint32_t c = tables.t[k - 1][b];
+                        tables.t[k][b] = ((c << 8) & mask) ^ tables.t[0][c >> (width - 8)];
+                    }
+                }
+                return tables;
+            }
+
+            // The loads are written bytewise so they don't depend on the host's byte order.
+            //  Compilers turn them into single loads (plus a swap where needed).
+
+            inline uint64_t load64LE(const uint8_t* p) {
+                return uint64_t(p[0]) | (uint64_t(p[1]) << 8) | (uint64_t(p[2]) << 16) | (uint64_t(p[3]) << 24)
+                    | (uint64_t(p[4]) << 32) | (uint64_t(p[5]) << 40) | (uint64_t(p[6]) << 48) | (uint64_t(p[7]) << 56);
+            }
+
+            inline uint64_t load64BE(const uint8_t* p) {
+                return (uint64_t(p[0]) << 56) | (uint64_t(p[1]) << 48) | (uint64_t(p[2]) << 40) | (uint64_t(p[3]) << 32)
+                    | (uint64_t(p[4]) << 24) | (uint64_t(p[5]) << 16) | (uint64_t(p[6]) << 8) | uint64_t(p[7]);
+            }
+
+            /*!
+             \brief Slice-by-8 for a reflected CRC, which keeps the register in the low bits.
+             */
+            uint32_t reflectedSliceBy8(const Tables& tables, uint32_t state, const uint8_t* data, size_t size) {
+                const uint32_t (&t)[8][256] = tables.t;
+                while (size >= 8) {
+                    uint64_t v = load64LE(data) ^ state;
+                    state = t[7][v & 0xFF] ^ t[6][(v >> 8) & 0xFF] ^ t[5][(v >> 16) & 0xFF] ^ t[4][(v >> 24) & 0xFF]
+                        ^ t[3][(v >> 32) & 0xFF] ^ t[2][(v >> 40) & 0xFF] ^ t[1][(v >> 48) & 0xFF] ^ t[0][v >> 56];
+                    data += 8;
+                    size -= 8;
+                }
+                while (size > 0) {
+                    state = (state >> 8) ^ t[0][(state ^ *data) & 0xFF];
+                    data += 1;
+                    size -= 1;
+                }
+                return state;
+            }
+
+            /*!
+             \brief Slice-by-8 for a 16-bit CRC that isn't reflected. The register is kept in the
+             low 16 bits.
+             */
+            uint32_t normal16SliceBy8(const Tables& tables, uint32_t state, const uint8_t* data, size_t size) {
+                const uint32_t (&t)[8][256] = tables.t;
+                while (size >= 8) {
+                    uint64_t v = load64BE(data) ^ (uint64_t(state) << 48);
+                    state = t[7][v >> 56] ^ t[6][(v >> 48) & 0xFF] ^ t[5][(v >> 40) & 0xFF] ^ t[4][(v >> 32) & 0xFF]
+                        ^ t[3][(v >> 24) & 0xFF] ^ t[2][(v >> 16) & 0xFF] ^ t[1][(v >> 8) & 0xFF] ^ t[0][v & 0xFF];
+                    data += 8;
+                    size -= 8;
+                }
+                while (size > 0) {
+                    state = ((state << 8) & 0xFFFF) ^ t[0][((state >> 8) ^ *data) & 0xFF];
+                    data += 1;
+                    size -= 1;
+                }
+                return state;
+            }
+
+            // Initialized once, at first use. Concurrent first calls are safe since C++11.
+
+            const Tables& crc16CCITTTables() {
+                static const Tables tables = makeNormalTables(0x1021, 16);
+                return tables;
+            }
+
+            const Tables& crc16ModbusTables() {
+                static const Tables tables = makeReflectedTables(0x8005, 16);
+                return tables;
+            }
+
+            const Tables& crc32Tables() {
+                static const Tables tables = makeReflectedTables(0x04C11DB7, 32);
+                return tables;
+            }
+
+            bool hasPCLMUL() {
+#if HSERIAL_CRC_PCLMUL
+                return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+#else
+                return false;
+#endif
+            }
+
+            bool hasARMv8CRC() {
+#if HSERIAL_CRC_ARMV8
+#if defined(__APPLE__) || defined(__ARM_FEATURE_CRC32)
+                return true;
+#elif defined(__linux__) && defined(HWCAP_CRC32)
+                return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+#else
+                return false;
+#endif
+#else
+                return false;
+#endif
+            }
+
+            CRCFunction selectCRC32Kernel() {
+                if (hasPCLMUL()) {
+                    return &crc32PCLMUL;
+                }
+                if (hasARMv8CRC()) {
+                    return &crc32ARMv8;
+                }
+                return &crc32SliceBy8;
+            }
+
+            CRCFunction crc32Kernel() {
+                static const CRCFunction kernel = selectCRC32Kernel();
+                return kernel;
+            }
+        }
+
+        uint32_t crc16CCITTSliceBy8(uint32_t state, const uint8_t* data, size_t size) {
+            return normal16SliceBy8(crc16CCITTTables(), state, data, size);
+        }
+
+        uint32_t crc16ModbusSliceBy8(uint32_t state, const uint8_t* data, size_t size) {
+            return reflectedSliceBy8(crc16ModbusTables(), state, data, size);
+        }
+
+        uint32_t crc32SliceBy8(uint32_t state, const uint8_t* data, size_t size) {
+            return reflectedSliceBy8(crc32Tables(), state, data, size);
+        }
+
+#if HSERIAL_CRC_PCLMUL
+
+        // Folds four 128-bit lanes at a time with carry-less multiplication, then folds to 128
+        //  bits and finishes with a Barrett reduction. The constants are powers of x modulo the
+        //  (bit-reflected) CRC-32 polynomial, from Intel's "Fast CRC Computation for Generic
+        //  Polynomials Using PCLMULQDQ Instruction".
+        __attribute__((target("pclmul,sse4.1")))
+        uint32_t crc32PCLMUL(uint32_t state, const uint8_t* data, size_t size) {
+            if (size < 64) {
+                return crc32SliceBy8(state, data, size);
+            }
+
+            const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+            const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+            const __m128i k5k0 = _mm_set_epi64x(0x0000000000, 0x0163cd6124);
+            const __m128i poly = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+            const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+
+            const uint8_t* p = data;
+            size_t remaining = size & ~size_t(15);
+            size_t tail = size & 15;
+
+            __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x00));
+            __m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x10));
+            __m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x20));
+            __m128i x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x30));
+            x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(int(state)));
+            p += 64;
+            remaining -= 64;
+
+            while (remaining >= 64) {
+                __m128i x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+                __m128i x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+                __m128i x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+                __m128i x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+                x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+                x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+                x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+                x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+                x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x00)));
+                x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x10)));
+                x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x20)));
+                x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x30)));
+                p += 64;
+                remaining -= 64;
+            }
+
+            // Fold the four lanes into one.
+            __m128i x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+            x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+            x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+            x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+            x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+            x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+            x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+            x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+            x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+            // Fold the remaining whole 16-byte blocks.
+            while (remaining >= 16) {
+                x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+                x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+                x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p))), x5);
+                p += 16;
+                remaining -= 16;
+            }
+
+            // Fold 128 bits to 64.
+            x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+            x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+            x2 = _mm_srli_si128(x1, 4);
+            x1 = _mm_and_si128(x1, mask32);
+            x1 = _mm_clmulepi64_si128(x1, k5k0, 0x00);
+            x1 = _mm_xor_si128(x1, x2);
+
+            // Barrett reduction to 32 bits.
+            x2 = _mm_and_si128(x1, mask32);
+            x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+            x2 = _mm_and_si128(x2, mask32);
+            x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+            x1 = _mm_xor_si128(x1, x2);
+
+            state = uint32_t(_mm_extract_epi32(x1, 1));
+            return crc32SliceBy8(state, p, tail);
+        }
+
+#else
+
+        uint32_t crc32PCLMUL(uint32_t state, const uint8_t* data, size_t size) {
+            return crc32SliceBy8(state, data, size);
+        }
+
+#endif
+
+#if HSERIAL_CRC_ARMV8
+
+        HSERIAL_CRC_ARMV8_TARGET
+        uint32_t crc32ARMv8(uint32_t state, const uint8_t* data, size_t size) {
+            while (size > 0 && (reinterpret_cast<uintptr_t>(data) & 7) != 0) {
+                state = __crc32b(state, *data);
+                data += 1;
+                size -= 1;
+            }
+            while (size >= 8) {
+                uint64_t v;
+                __builtin_memcpy(&v, data, 8);
+                state = __crc32d(state, v);
+                data += 8;
+                size -= 8;
+            }
+            while (size > 0) {
+                state = __crc32b(state, *data);
+                data += 1;
+                size -= 1;
+            }
+            return state;
+        }
+
+#else
+
+        uint32_t crc32ARMv8(uint32_t state, const uint8_t* data, size_t size) {
+            return crc32SliceBy8(state, data, size);
+        }
+
+#endif
+
+    }
+
+
+#pragma mark - HSerialCRC
+
+    namespace {
+
+        uint32_t initialState(HSerialCRC::Algorithm algorithm) {
+            switch (algorithm) {
+                case HSerialCRC::Algorithm::crc16CCITT: return 0xFFFF;
+                case HSerialCRC::Algorithm::crc16Modbus: return 0xFFFF;
+                case HSerialCRC::Algorithm::crc32: return 0xFFFFFFFF;
+            }
+            throw std::invalid_argument("Unknown CRC algorithm.");
+        }
+
+        uint32_t advance(HSerialCRC::Algorithm algorithm, uint32_t state, const uint8_t* data, size_t size) {
+            switch (algorithm) {
+                case HSerialCRC::Algorithm::crc16CCITT: return crc::crc16CCITTSliceBy8(state, data, size);
+                case HSerialCRC::Algorithm::crc16Modbus: return crc::crc16ModbusSliceBy8(state, data, size);
+                case HSerialCRC::Algorithm::crc32: return crc::crc32Kernel()(state, data, size);
+            }
+            return state;
+        }
+
+        uint32_t finish(HSerialCRC::Algorithm algorithm, uint32_t state) {
+            return (algorithm == HSerialCRC::Algorithm::crc32) ? ~state : state;
+        }
+    }
+
+    HSerialCRC::HSerialCRC(Algorithm _algorithm) : algorithm(_algorithm), state(initialState(_algorithm)) {}
+
+    uint32_t HSerialCRC::compute(Algorithm algorithm, const uint8_t* data, size_t size) {
+        return finish(algorithm, advance(algorithm, initialState(algorithm), data, size));
+    }
+
+    uint32_t HSerialCRC::compute(Algorithm algorithm, const HSerialByteView& data) {
+        return compute(algorithm, data.data, data.size);
+    }
+
+    const char* HSerialCRC::getKernelName(Algorithm algorithm) {
+        if (algorithm == Algorithm::crc32) {
+            crc::CRCFunction kernel = crc::crc32Kernel();
+            if (kernel == &crc::crc32PCLMUL) return "pclmul";
+            if (kernel == &crc::crc32ARMv8) return "armv8-crc";
+        }
+        return "slice-by-8";
+    }
+
+    void HSerialCRC::update(const uint8_t* data, size_t size) {
+        state = advance(algorithm, state, data, size);
+    }
+
+    void HSerialCRC::update(const HSerialByteView& data) {
+        update(data.data, data.size);
+    }
+
+    uint32_t HSerialCRC::value() const {
+        return finish(algorithm, state);
+    }
+
+    void HSerialCRC::reset() {
+        state = initialState(algorithm);
+    }
+
+}
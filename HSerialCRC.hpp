@@ -0,0 +1,148 @@
+//
+//  HSerialCRC.hpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+
+#ifndef HSerialCRC_hpp
+#define HSerialCRC_hpp
+
+#include <cstddef>
+#include <cstdint>
+
+#include "HSerialByteView.hpp"
+
+
+namespace hserial {
+
+    /*!
+     \brief A running CRC.
+
+     The CRC is computed incrementally: update() may be called with any number of pieces, and
+     value() may be called at any time without disturbing the computation.
+
+         HSerialCRC crc(HSerialCRC::Algorithm::crc32);
+         crc.update(header, headerSize);
+         crc.update(payload, payloadSize);
+         uint32_t check = crc.value();
+
+     A CRC can also be attached to a controller so that it sees every byte the controller reads,
+     as it is read (see HSerialController::setReadCRC).
+
+     All algorithms use table-driven slice-by-8 kernels. CRC-32 uses the carry-less multiply
+     instructions (PCLMULQDQ) on x86-64 and the CRC32 instructions on ARMv8 when the CPU has
+     them. The kernel is chosen once, at first use.
+
+     An HSerialCRC is not thread-safe.
+     */
+    class HSerialCRC {
+
+    public:
+
+        enum class Algorithm {
+
+            /*!
+             \brief CRC-16/CCITT-FALSE: polynomial 0x1021, initial value 0xFFFF, not reflected,
+             no final XOR. The check value of "123456789" is 0x29B1.
+             */
+            crc16CCITT,
+
+            /*!
+             \brief CRC-16/MODBUS: polynomial 0x8005, initial value 0xFFFF, reflected, no final
+             XOR. The check value of "123456789" is 0x4B37. The CRC is sent low byte first.
+             */
+            crc16Modbus,
+
+            /*!
+             \brief CRC-32 (ISO-HDLC, as used by Ethernet, zlib, and PNG): polynomial 0x04C11DB7,
+             initial value 0xFFFFFFFF, reflected, final XOR 0xFFFFFFFF. The check value of
+             "123456789" is 0xCBF43926.
+             */
+            crc32
+        };
+
+        explicit HSerialCRC(Algorithm algorithm);
+
+        /*!
+         \brief Computes the CRC of `size` bytes in one call.
+         */
+        static uint32_t compute(Algorithm algorithm, const uint8_t* data, size_t size);
+
+        /*!
+         \brief Computes the CRC of a view in one call.
+         */
+        static uint32_t compute(Algorithm algorithm, const HSerialByteView& data);
+
+        /*!
+         \brief Returns the name of the kernel used for an algorithm on this CPU (e.g.
+         "slice-by-8", "pclmul", or "armv8-crc").
+         */
+        static const char* getKernelName(Algorithm algorithm);
+
+        /*!
+         \brief Adds bytes to the CRC.
+         */
+        void update(const uint8_t* data, size_t size);
+
+        /*!
+         \brief Adds bytes to the CRC.
+         */
+        void update(const HSerialByteView& data);
+
+        /*!
+         \brief Returns the CRC of the bytes added since construction or the last reset.
+         */
+        uint32_t value() const;
+
+        /*!
+         \brief Starts over.
+         */
+        void reset();
+
+        Algorithm getAlgorithm() const {
+            return algorithm;
+        }
+
+    private:
+
+        Algorithm algorithm;
+
+        /*!
+         \brief The CRC register, before the final XOR (and for crc16CCITT, kept in the low 16
+         bits).
+         */
+        uint32_t state;
+    };
+
+
+    /// \cond internal_docs
+
+    /*!
+     \brief Internal CRC kernels. Each takes and returns the CRC register.
+     */
+    namespace crc {
+
+        uint32_t crc16CCITTSliceBy8(uint32_t state, const uint8_t* data, size_t size);
+        uint32_t crc16ModbusSliceBy8(uint32_t state, const uint8_t* data, size_t size);
+        uint32_t crc32SliceBy8(uint32_t state, const uint8_t* data, size_t size);
+
+        /*!
+         \brief Must only be called if the CPU supports PCLMULQDQ and SSE4.1. Falls back to
+         crc32SliceBy8 where the compiler can't target them.
+         */
+        uint32_t crc32PCLMUL(uint32_t state, const uint8_t* data, size_t size);
+
+        /*!
+         \brief Must only be called if the CPU has the ARMv8 CRC32 instructions. Falls back to
+         crc32SliceBy8 where the compiler can't target them.
+         */
+        uint32_t crc32ARMv8(uint32_t state, const uint8_t* data, size_t size);
+    }
+
+    /// \endcond internal_docs
+
+}
+
+#endif /* HSerialCRC_hpp */
@@ -8,6 +8,8 @@
 
 #include "HSerialController.hpp"
 
+#include <algorithm>
+
 #include "HSerialDevice.hpp"
 #include "HSerialAccess.hpp"
 #include "HSerialExceptions.hpp"
@@ -55,18 +57,49 @@ namespace hserial {
         return access->isActive(*this);
     }
 
-    void HSerialController::makeActive() {
-        access->makeActive(*this);
+    void HSerialController::makeActive(int priority) {
+        // Without a deadline the only way not to get a turn is to be skipped.
+        if (!access->makeActive(*this, priority, std::chrono::steady_clock::time_point::max())) {
+            throw ActivationSuperseded("The activation was superseded by a later one (transition coalescing is enabled).");
+        }
+    }
+
+    bool HSerialController::makeActive(const std::chrono::steady_clock::time_point& deadline, int priority) {
+        return access->makeActive(*this, priority, deadline);
+    }
+
+    bool HSerialController::tryMakeActive(int priority) {
+        return access->makeActive(*this, priority, std::chrono::steady_clock::now());
+    }
+
+    bool HSerialController::makeActiveFor(const std::chrono::milliseconds& timeout, int priority) {
+        return access->makeActive(*this, priority, std::chrono::steady_clock::now() + timeout);
     }
 
     void HSerialController::makeInactive() {
-        access->makeInactive(*this);
+        access->makeInactive(*this, priority::normal);
+    }
+
+    void HSerialController::park() {
+        access->park(*this);
     }
 
     void HSerialController::removeFromAccess() {
         access->removeFromAccess(*this);
     }
 
+    bool HSerialController::isTransitionRequested() const {
+        return access->isTransitionRequested(*this);
+    }
+
+    bool HSerialController::yieldIfRequested() {
+        if (!access->isTransitionRequested(*this)) {
+            return false;
+        }
+        access->makeInactive(*this, priority::critical);
+        return true;
+    }
+
 
 #pragma mark - Access Functions
 
@@ -114,18 +147,60 @@ namespace hserial {
         return access->read(*this, size);
     }
 
-    size_t HSerialController::readline(std::string& buffer, size_t size, std::string eol) {
+    size_t HSerialController::readline(std::string& buffer, size_t size, const std::string& eol) {
+        return access->readline(*this, buffer, size, eol);
+    }
+
+    size_t HSerialController::readline(uint8_t* buffer, size_t size, const HSerialByteView& eol) {
         return access->readline(*this, buffer, size, eol);
     }
 
-    std::string HSerialController::readline(size_t size, std::string eol) {
+    std::string HSerialController::readline(size_t size, const std::string& eol) {
         return access->readline(*this, size, eol);
     }
 
-    std::vector<std::string> HSerialController::readlines(size_t size, std::string eol) {
+    HSerialByteView HSerialController::readlineView(size_t size, const HSerialByteView& eol) {
+        if (lineViewBuffer.size() < size) {
+            lineViewBuffer.resize(size);
+        }
+        size_t count = access->readline(*this, lineViewBuffer.data(), size, eol);
+        return HSerialByteView(lineViewBuffer.data(), count);
+    }
+
+    std::vector<std::string> HSerialController::readlines(size_t size, const std::string& eol) {
         return access->readlines(*this, size, eol);
     }
 
+    size_t HSerialController::forEachLine(const std::function<bool(const HSerialByteView& line)>& callback, size_t size, const HSerialByteView& eol) {
+        std::vector<uint8_t> buffer;
+        buffer.swap(forEachLineBuffer);
+        if (buffer.size() < size) {
+            buffer.resize(size);
+        }
+        size_t numLines = 0;
+        size_t total = 0;
+        try {
+            while (total < size) {
+                size_t count = access->readline(*this, buffer.data(), size - total, eol);
+                if (count == 0) {
+                    break;
+                }
+                total += count;
+                numLines += 1;
+                HSerialByteView line(buffer.data(), count);
+                bool isComplete = line.endsWith(eol);
+                if (!callback(line) || !isComplete) {
+                    break;
+                }
+            }
+        } catch (...) {
+            forEachLineBuffer.swap(buffer);
+            throw;
+        }
+        forEachLineBuffer.swap(buffer);
+        return numLines;
+    }
+
     size_t HSerialController::write(const uint8_t* data, size_t size) {
         return access->write(*this, data, size);
     }
@@ -191,6 +266,14 @@ namespace hserial {
         access->setSettings(*this, baudrate, timeout, bytesize, parity, stopbits, flowcontrol, onlyIfDifferent);
     }
 
+    HSerialSettingsReport HSerialController::applySettings(const HSerialSettings& settings, const HSerialSettingsOptions& options) {
+        return access->applySettings(*this, settings, options);
+    }
+
+    HSerialSettings HSerialController::getSettings() const {
+        return access->getSettings(*this);
+    }
+
     void HSerialController::flush() {
         access->flush(*this);
     }
@@ -239,6 +322,54 @@ namespace hserial {
         return access->getCD(*this);
     }
 
+    void HSerialController::enableReadBuffering(size_t capacity) {
+        access->enableReadBuffering(*this, capacity);
+    }
+
+    void HSerialController::disableReadBuffering() {
+        access->disableReadBuffering(*this);
+    }
+
+    bool HSerialController::isReadBufferingEnabled() const {
+        return access->isReadBufferingEnabled(*this);
+    }
+
+    void HSerialController::setReadCRC(HSerialCRC* crc) {
+        readCRC = crc;
+    }
+
+    HSerialCRC* HSerialController::getReadCRC() const {
+        return readCRC;
+    }
+
+    uint64_t HSerialController::enqueueWrite(const uint8_t* data, size_t size) {
+        return access->enqueueWrite(*this, data, size);
+    }
+
+    uint64_t HSerialController::enqueueWrite(const std::vector<uint8_t>& data) {
+        return access->enqueueWrite(*this, data);
+    }
+
+    uint64_t HSerialController::enqueueWrite(const std::string& data) {
+        return access->enqueueWrite(*this, data);
+    }
+
+    uint64_t HSerialController::enqueueWrite(size_t maxSize, const std::function<size_t(uint8_t* buffer)>& fill) {
+        return access->enqueueWrite(*this, maxSize, fill);
+    }
+
+    bool HSerialController::waitForQueuedWrite(uint64_t ticket, const std::chrono::milliseconds& timeout) {
+        return access->waitForQueuedWrites(*this, ticket, timeout);
+    }
+
+    bool HSerialController::waitForQueuedWrites(const std::chrono::milliseconds& timeout) {
+        return access->waitForQueuedWrites(*this, UINT64_MAX, timeout);
+    }
+
+    size_t HSerialController::cancelQueuedWrites() {
+        return access->cancelQueuedWrites(*this);
+    }
+
 
 #pragma mark - Delegation
 
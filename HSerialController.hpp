@@ -14,11 +14,14 @@
 #include <vector>
 #include <mutex>
 #include <chrono>
+#include <functional>
 
 #include <serial/serial.h>
 
 
 #include "HSerialPort.hpp"
+#include "HSerialByteView.hpp"
+#include "HSerialSettings.hpp"
 
 
 namespace hserial {
@@ -51,6 +54,29 @@ namespace hserial {
     //       higher-level concept that users should implement?
 
     class HSerialAccess;
+    class HSerialCRC;
+    class HSerialReactor;
+    class ReadAwaitable;
+    class ReadlineAwaitable;
+    class WriteAwaitable;
+    class ChangeAwaitable;
+
+    /*!
+     \brief Priorities for queued controller changes (see HSerialController::makeActive).
+
+     When several controller changes are waiting for the same port, the one with the highest
+     priority goes next, and changes with the same priority go in the order they were requested.
+     A waiting change gains priority as it waits (see HSerialPort::getTransitionQueue), so a low
+     priority change is delayed but never starved.
+
+     Any `int` may be used. These are suggestions.
+     */
+    namespace priority {
+        const int background = -100;
+        const int normal = 0;
+        const int high = 100;
+        const int critical = 1000;
+    }
 
     /*!
      \brief The base class for objects that use the serial port.
@@ -166,12 +192,49 @@ namespace hserial {
          is ControllerRefuses (and the the controller was implemented correctly) then the error
          occurred before the controller change.
 
+         Controller changes on a port are serialized. If other changes are waiting, `priority`
+         determines when this one goes (see hserial::priority). Changes made with makeInactive
+         and removeFromAccess have normal priority.
+
          \throws hserial::ControllerRefuses if the existing active controller refuses to relinquish
          the active controller role, or if a current controller change is required and any
          controller in the access list refuses to be removed.
-         \see isActive, makeInactive, removeSelfIfCurrent
+         \throws hserial::ActivationSuperseded if transition coalescing skipped the activation
+         (see HSerialPort::setTransitionCoalescing). The controller is inactive.
+         \see isActive, makeInactive, removeSelfIfCurrent, HSerialPort::getTransitionQueue
+         */
+        void makeActive(int priority = priority::normal);
+
+        /*!
+         \brief Makes the controller active, unless that means waiting past `deadline`.
+
+         The deadline applies to waiting for earlier controller changes on the port. Once this
+         change starts it runs to completion (including the willMakeInactive wait of the existing
+         active controller), since a change can't be abandoned midway.
+
+         \returns `false` if the deadline passed before the change could start, or if transition
+         coalescing skipped the activation (see HSerialPort::setTransitionCoalescing). Nothing is
+         done in either case, and the controller's state is unchanged.
+         \throws (the exceptions of makeActive, except ActivationSuperseded)
+         \see tryMakeActive, makeActiveFor
+         */
+        bool makeActive(const std::chrono::steady_clock::time_point& deadline, int priority = priority::normal);
+
+        /*!
+         \brief Makes the controller active, unless that means waiting for another controller
+         change.
+
+         \see makeActive(const std::chrono::steady_clock::time_point& deadline, int priority)
          */
-        void makeActive();
+        bool tryMakeActive(int priority = priority::normal);
+
+        /*!
+         \brief Makes the controller active, unless that means waiting more than `timeout` for
+         other controller changes.
+
+         \see makeActive(const std::chrono::steady_clock::time_point& deadline, int priority)
+         */
+        bool makeActiveFor(const std::chrono::milliseconds& timeout, int priority = priority::normal);
 
         /*!
          \brief Makes the controller inactive.
@@ -188,6 +251,33 @@ namespace hserial {
          */
         void makeInactive();
 
+        /*!
+         \brief Makes the controller inactive until it or another controller calls makeActive.
+
+         This is for controllers that release the port between bursts of activity and usually
+         take it back before anyone else wants it. A parked controller is inactive (access calls
+         throw NotActiveController), but no transition is performed: no callbacks are called
+         and access calls aren't blocked. The transition is deferred until another controller
+         change, which then makes the controller inactive in the usual way (calling its
+         willMakeInactive callback, etc.). If the controller instead calls makeActive while no
+         other change is waiting it reclaims the port with a single atomic operation, again
+         without any callbacks.
+
+         Other controllers get the port as promptly as after makeInactive. However, since the
+         parked controller's willMakeInactive is called then, it should not refuse to become
+         inactive while parked.
+
+         Access calls that were already made on other threads may still be running when this
+         function returns. The deferred transition waits for them as usual.
+
+         If a controller change is in progress this function is equivalent to makeInactive. If
+         the controller is inactive this function does nothing.
+
+         \throws (the exceptions of makeInactive, if a change is in progress)
+         \see makeInactive, makeActive
+         */
+        void park();
+
         /*!
          \brief Removes the controller from the access list.
 
@@ -215,6 +305,40 @@ namespace hserial {
          \see isActive, makeActive, makeInactive
          */
         void removeFromAccess();
+
+        /*!
+         \brief Indicates if another controller wants the port.
+
+         Returns `true` if the controller is active and either a controller change is waiting for
+         the port (see HSerialPort::getTransitionQueue) or a makeActive call by another
+         controller was refused since this controller became active. The second case usually
+         means this controller is locked or busy.
+
+         This is lock-free, so a long-running controller can check it often (e.g. once per
+         packet) and hand the port over at a convenient point with yieldIfRequested.
+
+         Changes waiting for the port include any requested by this controller itself from
+         another thread.
+
+         \see yieldIfRequested, transitionRequested
+         */
+        bool isTransitionRequested() const;
+
+        /*!
+         \brief Makes the controller inactive if another controller wants the port.
+
+         This lets a controller that would otherwise refuse (or delay) a change hand the port over
+         at a point it chooses. The change jumps the queue (it has hserial::priority::critical),
+         so waiting changes find the port free. A makeActive call that was refused must be
+         retried to get the port.
+
+         Calling code should always catch ControllerRefuses.
+
+         \returns `true` if the controller was made inactive.
+         \throws (the exceptions of makeInactive)
+         \see isTransitionRequested
+         */
+        bool yieldIfRequested();
         
         /// \} /Access Management
 
@@ -288,6 +412,7 @@ namespace hserial {
          \returns `true` if the function exits with the port in a readable state, `false`otherwise
          (due to timeout or select interruption).
          \throws hserial::NotActiveController
+         \throws hserial::AccessInterrupted
          \see available, waitByteTimes
          */
         bool waitReadable();
@@ -334,6 +459,7 @@ namespace hserial {
          \throws serial::PortNotOpenedException Thrown if the port is not open.
          \throws serial::SerialException
          \throws hserial::NotActiveController
+         \throws hserial::AccessInterrupted
          \see setTimeout
          */
         size_t read(uint8_t* buffer, size_t size);
@@ -347,6 +473,7 @@ namespace hserial {
          \throws serial::PortNotOpenedException Thrown if the port is not open.
          \throws serial::SerialException
          \throws hserial::NotActiveController 
+         \throws hserial::AccessInterrupted
          \see read(uint8_t* buffer, size_t size), setTimeout
          */
         size_t read(std::vector<uint8_t>& buffer, size_t size = 1);
@@ -360,6 +487,7 @@ namespace hserial {
          \throws serial::PortNotOpenedException
          \throws serial::SerialException
          \throws hserial::NotActiveController 
+         \throws hserial::AccessInterrupted
          \see read(uint8_t* buffer, size_t size), setTimeout
          */
         size_t read(std::string& buffer, size_t size = 1);
@@ -372,6 +500,7 @@ namespace hserial {
          \throws serial::PortNotOpenedException
          \throws serial::SerialException
          \throws hserial::NotActiveController 
+         \throws hserial::AccessInterrupted
          \see read(uint8_t* buffer, size_t size), setTimeout
          */
         std::string read(size_t size = 1);
@@ -386,9 +515,28 @@ namespace hserial {
          \throws serial::PortNotOpenedException
          \throws serial::SerialException
          \throws hserial::NotActiveController 
+         \throws hserial::AccessInterrupted
          \see read(uint8_t* buffer, size_t size), setTimeout
          */
-        size_t readline(std::string& buffer, size_t size = 65536, std::string eol = "\n");
+        size_t readline(std::string& buffer, size_t size = 65536, const std::string& eol = "\n");
+
+        /*!
+         \brief Reads in a line or until a given delimiter has been processed, into a caller-owned
+         buffer.
+
+         This overload does not allocate.
+
+         \param buffer The buffer used to store the data. It must have room for `size` bytes.
+         \param size The maximum length of a line.
+         \param eol The bytes to match against for the EOL.
+         \returns A size_t representing the number of bytes read.
+         \throws serial::PortNotOpenedException
+         \throws serial::SerialException
+         \throws hserial::NotActiveController
+         \throws hserial::AccessInterrupted
+         \see readlineView, setTimeout
+         */
+        size_t readline(uint8_t* buffer, size_t size, const HSerialByteView& eol = "\n");
 
         /*!
          \brief Reads in a line or until a given delimiter has been processed.
@@ -399,9 +547,29 @@ namespace hserial {
          \throws serial::PortNotOpenedException
          \throws serial::SerialException
          \throws hserial::NotActiveController 
+         \throws hserial::AccessInterrupted
          \see read(uint8_t* buffer, size_t size), setTimeout
          */
-        std::string readline(size_t size = 65536, std::string eol = "\n");
+        std::string readline(size_t size = 65536, const std::string& eol = "\n");
+
+        /*!
+         \brief Reads in a line or until a given delimiter has been processed, and returns a view
+         of it.
+
+         The line is stored in a buffer owned by the controller. The view is valid until the next
+         call to readlineView on this controller, or until the controller is destroyed. Once the
+         buffer has grown to `size` no further allocations are made.
+
+         \param size A maximum length of a line, defaults to 65536 (2^16).
+         \param eol The bytes to match against for the EOL.
+         \returns A view of the line.
+         \throws serial::PortNotOpenedException
+         \throws serial::SerialException
+         \throws hserial::NotActiveController
+         \throws hserial::AccessInterrupted
+         \see readline(uint8_t* buffer, size_t size, const HSerialByteView& eol), setTimeout
+         */
+        HSerialByteView readlineView(size_t size = 65536, const HSerialByteView& eol = "\n");
 
         /*!
          \brief Reads in multiple lines until the serial port times out.
@@ -417,9 +585,41 @@ namespace hserial {
          \throws serial::PortNotOpenedException
          \throws serial::SerialException
          \throws hserial::NotActiveController 
+         \throws hserial::AccessInterrupted
          \see read(uint8_t* buffer, size_t size), setTimeout
          */
-        std::vector<std::string> readlines(size_t size = 65536, std::string eol = "\n");
+        std::vector<std::string> readlines(size_t size = 65536, const std::string& eol = "\n");
+
+        /*!
+         \brief Reads lines until the serial port times out, passing each line to a callback as
+         soon as it is complete.
+
+         This is the streaming equivalent of readlines. It stops under the same conditions (a
+         line is cut short by the timeout, or the size limit is reached), or when the callback
+         returns `false`.
+
+         The view passed to the callback is only valid during the callback. A single line buffer
+         of at most `size` bytes is used for the whole call, so memory use does not depend on the
+         number of lines. The buffer belongs to the controller and is kept between calls, so it
+         is only allocated when `size` exceeds the largest size used before.
+
+         Each line is read with its own access call. The controller does not hold up transitions
+         while the callback runs. If the controller is made inactive between lines, the next
+         read throws NotActiveController.
+
+         \param callback Called with each line. Return `false` to stop.
+         \param size A maximum length of combined lines, defaults to 65536 (2^16).
+         \param eol The bytes to match against for the EOL.
+
+         \returns The number of lines passed to the callback.
+
+         \throws serial::PortNotOpenedException
+         \throws serial::SerialException
+         \throws hserial::NotActiveController
+         \throws hserial::AccessInterrupted
+         \see readlines, readlineView, setTimeout
+         */
+        size_t forEachLine(const std::function<bool(const HSerialByteView& line)>& callback, size_t size = 65536, const HSerialByteView& eol = "\n");
 
         /*!
          \brief Writes a string to the serial port.
@@ -434,6 +634,7 @@ namespace hserial {
          \throws serial::SerialException
          \throws serial::IOException
          \throws hserial::NotActiveController 
+         \throws hserial::AccessInterrupted
          \see setTimeout
          */
         size_t write(const uint8_t* data, size_t size);
@@ -449,6 +650,7 @@ namespace hserial {
          \throws serial::SerialException
          \throws serial::IOException
          \throws hserial::NotActiveController 
+         \throws hserial::AccessInterrupted
          \see setTimeout
          */
         size_t write(const std::vector<uint8_t>& data);
@@ -464,6 +666,7 @@ namespace hserial {
          \throws serial::SerialException
          \throws serial::IOException
          \throws hserial::NotActiveController 
+         \throws hserial::AccessInterrupted
          \see setTimeout
          */
         size_t write(const std::string &data);
@@ -689,6 +892,48 @@ namespace hserial {
         void setSettings(uint32_t baudrate, serial::Timeout timeout, serial::bytesize_t bytesize,
                          serial::parity_t parity, serial::stopbits_t stopbits, serial::flowcontrol_t flowcontrol, bool onlyIfDifferent = false);
 
+        /*!
+         \brief Changes the port's settings as one switch.
+
+         Unlike setSettings, which applies every setting and reconfigures the port once for each,
+         this compares `settings` with the current settings and reconfigures the port only for
+         the line settings that differ. Changing the timeout never reconfigures the port. So a
+         typical profile switch (e.g. only the baudrate) costs a single reconfiguration.
+
+         serial::Serial can't change several line settings in one reconfiguration on an open
+         port. If more than one differs they are applied one at a time, unless
+         HSerialSettingsOptions::reopenForMultipleChanges is set, in which case the port is
+         closed and reopened so that it is configured once. See HSerialSettingsOptions.
+
+         With HSerialSettingsOptions::drainOutput the write queue and the driver's output buffer
+         are drained first. Reopening also drains the write queue, and enqueueWrite waits until
+         the port is open again.
+
+         If reopening with the new settings fails, the port is reopened with the previous ones
+         and the exception is rethrown (no report is returned). If that also fails the port is
+         left closed.
+
+         \returns A report with the number of reconfigurations and the time taken.
+         \throws std::invalid_argument
+         \throws serial::IOException
+         \throws hserial::NotActiveController
+         \throws hserial::AccessInterrupted If interrupted while draining the write queue.
+         \see setSettings, getSettings
+         */
+        HSerialSettingsReport applySettings(const HSerialSettings& settings, const HSerialSettingsOptions& options = HSerialSettingsOptions());
+
+        /*!
+         \brief Returns all of the port's settings at once.
+
+         The settings (like the values returned by getBaudrate and the other getters) come from
+         a copy that the access object updates whenever the port is reconfigured, so reading
+         them doesn't lock a mutex or call into serial::Serial.
+
+         \throws hserial::NotActiveController
+         \see setSettings, applySettings
+         */
+        HSerialSettings getSettings() const;
+
         /*!
          \brief Flushes the input and output buffers.
          \throws serial::PortNotOpenedException
@@ -828,7 +1073,244 @@ namespace hserial {
          */
         bool getCD();
 
+        /*!
+         \brief Starts moving received bytes from the port into a buffer in the background.
+
+         While read buffering is enabled a thread owned by the port continuously drains the
+         port into a preallocated buffer of `capacity` bytes. The reading functions, available(),
+         and waitReadable() are then served from memory, with the same timeout semantics as
+         before. This reduces the number of system calls per byte, and keeps the driver's buffer
+         from overrunning while the controller is busy doing something other than reading.
+
+         The buffer belongs to the port, not the controller. Buffering stays enabled across
+         controller transitions, and buffered bytes are read by whichever controller reads next,
+         just like bytes in the driver's buffer. flush(), flushInput() and close() discard the
+         buffered bytes.
+
+         If the buffer fills up the port is not read until there is room again.
+
+         An exception thrown while reading the port in the background is rethrown from the next
+         reading function call that finds the buffer empty.
+
+         If buffering is already enabled with a different capacity the buffer is replaced.
+         Unread bytes are kept.
+
+         \throws std::invalid_argument Thrown if `capacity` is zero.
+         \throws hserial::NotActiveController
+         \see disableReadBuffering, isReadBufferingEnabled
+         */
+        void enableReadBuffering(size_t capacity = 65536);
+
+        /*!
+         \brief Stops buffering received bytes in the background.
+
+         Bytes already in the buffer are not lost -- they are returned by the next reads.
+
+         This function may block for up to the port's read timeout.
+
+         \throws hserial::NotActiveController
+         \see enableReadBuffering, isReadBufferingEnabled
+         */
+        void disableReadBuffering();
+
+        /*!
+         \brief Indicates if read buffering is enabled.
+         \throws hserial::NotActiveController
+         \see enableReadBuffering, disableReadBuffering
+         */
+        bool isReadBufferingEnabled() const;
+
+        /*!
+         \brief Sets a CRC to be updated with every byte this controller reads.
+
+         Each reading function adds the bytes it returns to the CRC right after copying them out
+         of the port or the read buffer, so a checksum can be computed as data arrives without a
+         second pass over it. Bytes read by other controllers are not included.
+
+         The CRC is not owned, and must remain valid until it is replaced or cleared by passing
+         `nullptr`. It is only touched by reading functions called on this controller, so
+         it may be read and reset between reads without synchronization (as long as the
+         controller itself is only used from one thread at a time).
+
+         Unlike the other access functions, this one may be called while the controller is not
+         active.
+
+         \see HSerialCRC
+         */
+        void setReadCRC(HSerialCRC* crc);
+
+        /*!
+         \brief Returns the CRC set by setReadCRC, or `nullptr`.
+         */
+        HSerialCRC* getReadCRC() const;
+
+        /*!
+         \brief Queues data to be written to the port by a background thread.
+
+         The function returns as soon as the data is queued. A writer thread takes everything
+         queued so far and writes it in a single call, so many small packets queued in quick
+         succession are coalesced into a few large writes.
+
+         Queued bytes are written in order. The synchronous write functions wait for the queue
+         to drain before writing, so they never overtake queued bytes.
+
+         The queue does not count as an unreturned access call. When the controller gives up the
+         port the transition waits, after willMakeInactive returns, for the queued bytes to be
+         written, so a long queue delays the change but doesn't make it fail. flush(),
+         flushOutput() and close() discard queued bytes that have not been taken by the writer
+         yet.
+
+         If the queue is full this function blocks until there is room. It also blocks while
+         applySettings is reopening the port.
+
+         If writing fails the rest of the queue is discarded and the exception is rethrown by the
+         next call to enqueueWrite or waitForQueuedWrites.
+
+         \returns A ticket that may be passed to waitForQueuedWrite.
+         \throws serial::PortNotOpenedException
+         \throws serial::SerialException
+         \throws serial::IOException
+         \throws hserial::NotActiveController
+         \throws hserial::AccessInterrupted
+         \see waitForQueuedWrites, cancelQueuedWrites
+         */
+        uint64_t enqueueWrite(const uint8_t* data, size_t size);
+
+        /*!
+         \brief Queues data to be written to the port by a background thread.
+         \see enqueueWrite(const uint8_t* data, size_t size)
+         */
+        uint64_t enqueueWrite(const std::vector<uint8_t>& data);
+
+        /*!
+         \brief Queues data to be written to the port by a background thread.
+         \see enqueueWrite(const uint8_t* data, size_t size)
+         */
+        uint64_t enqueueWrite(const std::string& data);
+
+        /*!
+         \brief Queues data that is produced directly in the write queue.
+
+         `fill` is called with room for `maxSize` bytes at the end of the queue, and returns the
+         number of bytes it produced. This lets an encoder (e.g. HSerialFramer) write its output
+         straight into the queue instead of into a temporary buffer that is then copied.
+
+         `fill` is called with the queue locked, so it must be quick and must not call the
+         controller. If it throws, nothing is queued and the exception propagates.
+
+         \returns A ticket that may be passed to waitForQueuedWrite.
+         \throws serial::PortNotOpenedException
+         \throws serial::SerialException
+         \throws serial::IOException
+         \throws hserial::NotActiveController
+         \throws hserial::AccessInterrupted
+         \see enqueueWrite(const uint8_t* data, size_t size)
+         */
+        uint64_t enqueueWrite(size_t maxSize, const std::function<size_t(uint8_t* buffer)>& fill);
+
+        /*!
+         \brief Waits until the data queued with the given ticket has been written.
+
+         \returns `true` if the data has been written (or discarded), `false` on timeout.
+         \throws serial::SerialException
+         \throws serial::IOException
+         \throws hserial::NotActiveController
+         \throws hserial::AccessInterrupted
+         \see enqueueWrite, waitForQueuedWrites
+         */
+        bool waitForQueuedWrite(uint64_t ticket, const std::chrono::milliseconds& timeout);
+
+        /*!
+         \brief Waits until all queued data has been written.
+
+         \returns `true` if the queue drained, `false` on timeout.
+         \throws serial::SerialException
+         \throws serial::IOException
+         \throws hserial::NotActiveController
+         \throws hserial::AccessInterrupted
+         \see enqueueWrite, waitForQueuedWrite
+         */
+        bool waitForQueuedWrites(const std::chrono::milliseconds& timeout);
+
+        /*!
+         \brief Discards queued data that has not been taken by the writer thread.
+
+         Data already being written is not affected. A controller that prefers to give up the port
+         quickly may call this from willMakeInactive, so that the transition doesn't wait for the
+         queue to drain.
+
+         \returns The number of bytes discarded.
+         \throws hserial::NotActiveController
+         \see enqueueWrite
+         */
+        size_t cancelQueuedWrites();
+
         /// \} /Access Functions
+
+
+#if defined(__linux__) && defined(__cpp_impl_coroutine)
+
+#pragma mark - Asynchronous Operations
+
+        /*!
+         \name Asynchronous Operations
+
+         C++20 coroutine versions of the reading, writing, and waiting functions, performed by an
+         HSerialReactor with which the controller is registered. The coroutine is resumed on a
+         thread in the reactor's run() or poll(). Like the other access functions these fail
+         (co_await throws NotActiveController) if the controller is not active when the operation
+         completes.
+
+         Defined in HSerialAwaitable.hpp, which must be included to use them. Only available on
+         Linux, in translation units compiled with coroutine support.
+         */
+        /// \{
+
+        /*!
+         \brief Reads up to `size` bytes once at least one byte is available.
+
+         `buffer` must remain valid until the coroutine is resumed.
+
+         \returns An awaitable producing the number of bytes read.
+         \throws std::invalid_argument (from co_await) If the controller is not registered with
+         the reactor.
+         \throws hserial::NotActiveController (from co_await)
+         \see HSerialReactor::asyncRead
+         */
+        ReadAwaitable asyncRead(HSerialReactor& reactor, uint8_t* buffer, size_t size);
+
+        /*!
+         \brief Reads a line once a complete line is available.
+         \returns An awaitable producing the line, including the eol if it was found.
+         \throws hserial::NotActiveController (from co_await)
+         \see HSerialReactor::asyncReadline
+         */
+        ReadlineAwaitable asyncReadline(HSerialReactor& reactor, size_t size = 65536, const std::string& eol = "\n");
+
+        /*!
+         \brief Writes data. The data is copied before the coroutine is suspended.
+         \returns An awaitable producing the number of bytes written.
+         \throws hserial::NotActiveController (from co_await)
+         \see HSerialReactor::asyncWrite
+         */
+        WriteAwaitable asyncWrite(HSerialReactor& reactor, const uint8_t* data, size_t size);
+
+        /*!
+         \brief Waits for a change on the modem status lines.
+
+         Unlike waitForChange this doesn't hold the port while waiting, so it doesn't delay
+         transitions.
+
+         \returns An awaitable producing `true` if a line changed, or `false` if the port was
+         closed.
+         \throws hserial::NotActiveController (from co_await)
+         \see HSerialReactor::asyncWaitForChange
+         */
+        ChangeAwaitable asyncWaitForChange(HSerialReactor& reactor);
+
+        /// \} /Asynchronous Operations
+
+#endif /* __linux__ && __cpp_impl_coroutine */
         
 
 #pragma mark - Delegation
@@ -1097,6 +1579,46 @@ namespace hserial {
          */
         virtual void didMakeActive() {}
 
+        /*!
+         \brief Called on the active controller when another controller's makeActive call has
+         been refused.
+
+         The call is made on the refused thread, after the refusal and before ControllerRefuses
+         is thrown to the caller. It is a hint that the port is wanted: a controller that can't
+         give up the port now (e.g. because it is locked, or in the middle of an exchange) can
+         give it up later with yieldIfRequested. Waiting controller changes don't cause this call;
+         use isTransitionRequested to check for them.
+
+         __Important__: No exceptions can be thrown from this function. It should return quickly,
+         and it must not make controller changes.
+
+         The default implementation is empty.
+
+         \see isTransitionRequested, yieldIfRequested
+         */
+        virtual void transitionRequested() noexcept {}
+
+        /*!
+         \brief Indicates if a makeActive call by this controller may be skipped when transition
+         coalescing is enabled on the port.
+
+         With coalescing (see HSerialPort::setTransitionCoalescing), an activation that is waiting
+         in the queue and would be immediately followed by another controller's activation is
+         skipped: no transition callbacks are called, and makeActive throws ActivationSuperseded
+         (the timed variants return `false`) once the later activation has succeeded. A
+         controller that needs its activation to actually happen (e.g. because it must stay
+         active once active) should return `false`.
+
+         This is called on the thread calling makeActive, when the request is queued.
+
+         __Important__: No exceptions can be thrown from this function.
+
+         The default implementation returns `true`.
+         */
+        virtual bool canSkipActivation() const noexcept {
+            return true;
+        }
+
         /// \} /Transition Callbacks
 
 
@@ -1120,6 +1642,13 @@ namespace hserial {
          Typically waitForAccessCallsToReturn() is used after this function to guarantee
          that the controller is done using the serial port.
 
+         Access calls on other threads that are waiting -- for bytes from the read buffer, for
+         the write queue, or in waitReadable() with read buffering enabled -- are woken and
+         return early, throwing hserial::AccessInterrupted if they haven't transferred any data.
+         So waitForAccessCallsToReturn() usually returns within microseconds instead of after the
+         callers' read timeouts. Waits inside serial::Serial (unbuffered reads, waitForChange)
+         can't be interrupted.
+
          This function may be called only from a transition callback or subcall. Calling at any
          other time will cause an exception to be thrown.
 
@@ -1172,6 +1701,9 @@ namespace hserial {
     private:
 
         friend class HSerialAccess;
+        friend class HSerialReactor; // uses the access to register the port
+        friend class HSerialFramer; // reads and writes through the access
+        friend class HSerialScheduler; // makes controllers active through the access
 
 #pragma mark - For Friends
 
@@ -1278,6 +1810,30 @@ namespace hserial {
          */
         std::vector<HSerialController*> delegates;
 
+        /*!
+         \brief The buffer that holds the line returned by readlineView.
+
+         Internal use only.
+         */
+        std::vector<uint8_t> lineViewBuffer;
+
+        /*!
+         \brief The line buffer used by forEachLine, kept so that each call doesn't allocate.
+
+         Separate from lineViewBuffer since the callback may call readlineView. While a call is
+         running the buffer is moved out of this member, so a nested call uses its own.
+
+         Internal use only.
+         */
+        std::vector<uint8_t> forEachLineBuffer;
+
+        /*!
+         \brief The CRC updated by the reading functions (see setReadCRC). Not owned.
+
+         Internal use only.
+         */
+        HSerialCRC* readCRC = nullptr;
+
         /// \} /Internal Stuff
     };
 }
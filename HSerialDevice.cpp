@@ -8,6 +8,8 @@
 
 #include "HSerialDevice.hpp"
 
+#include <stdexcept>
+
 #include "HSerialController.hpp"
 
 // todo: fix
@@ -18,15 +20,29 @@
 namespace hserial {
 
     std::shared_ptr<HSerialAccess> HSerialDevice::getAccess() {
+        std::lock_guard<std::mutex> lock(accessMutex);
         try {
             return std::shared_ptr<HSerialAccess>(access);
         } catch (const std::bad_weak_ptr& e) {
-            std::shared_ptr<HSerialAccess> a(HSerialAccess::createShared(deviceName));
+            std::unique_ptr<HSerialTransport> transport;
+            if (transportFactory) {
+                transport = transportFactory(deviceName);
+            }
+            std::shared_ptr<HSerialAccess> a(HSerialAccess::createShared(deviceName, std::move(transport)));
+            a->setTransitionCoalescing(isCoalescingTransitions);
             access = a;
             return a;
         }
     }
 
+    void HSerialDevice::setTransportFactory(HSerialTransportFactory factory) {
+        std::lock_guard<std::mutex> lock(accessMutex);
+        if (!access.expired()) {
+            throw std::logic_error("The transport can't be changed while the port has controllers.");
+        }
+        transportFactory = std::move(factory);
+    }
+
     std::string HSerialDevice::getDescription() {
         std::lock_guard<std::mutex> lock(detailsMutex);
         return description;
@@ -52,6 +68,25 @@ namespace hserial {
         }
     }
 
+    void HSerialDevice::setTransitionCoalescing(bool enabled) {
+        std::lock_guard<std::mutex> lock(accessMutex);
+        isCoalescingTransitions = enabled;
+        std::shared_ptr<HSerialAccess> a = access.lock();
+        if (a) {
+            a->setTransitionCoalescing(enabled);
+        }
+    }
+
+    bool HSerialDevice::isTransitionCoalescingEnabled() {
+        std::lock_guard<std::mutex> lock(accessMutex);
+        return isCoalescingTransitions;
+    }
+
+    HSerialTransitionQueue HSerialDevice::getTransitionQueue() {
+        std::shared_ptr<HSerialAccess> a = access.lock();
+        return a ? a->getTransitionQueue() : HSerialTransitionQueue();
+    }
+
 
 #pragma mark - Construction/Destruction
 
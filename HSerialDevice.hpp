@@ -98,6 +98,27 @@ namespace hserial {
          */
         HSerialController* getCurrentController();
 
+        /*!
+         \brief Returns the controller changes waiting for the port (empty if the access object
+         doesn't exist).
+
+         For use by friend classes.
+         */
+        HSerialTransitionQueue getTransitionQueue();
+
+        /*!
+         \brief Sets whether the access object coalesces queued activations, now and whenever it
+         is created.
+
+         For use by friend classes.
+         */
+        void setTransitionCoalescing(bool enabled);
+
+        /*!
+         \brief For use by friend classes.
+         */
+        bool isTransitionCoalescingEnabled();
+
         /*!
          \brief Creates a HSerialDevice object.
 
@@ -117,6 +138,16 @@ namespace hserial {
         */
         std::shared_ptr<HSerialAccess> getAccess();
 
+        /*!
+         \brief Sets the factory used to create the transport when the access object is created.
+         `nullptr` means the default transport (see HSerialAccess::createShared).
+
+         For use by friend classes.
+
+         \throws std::logic_error if the access object exists (i.e. the port has controllers).
+         */
+        void setTransportFactory(HSerialTransportFactory factory);
+
         ///@} /Friends
 
 
@@ -159,6 +190,33 @@ namespace hserial {
          */
         std::weak_ptr<HSerialAccess> access;
 
+        /*!
+         \brief [Internal] Creates the transport for a new access object. May be `nullptr`.
+
+         Internal use only.
+
+         \sa setTransportFactory()
+         */
+        HSerialTransportFactory transportFactory;
+
+        /*!
+         \brief [Internal] Applied to each new access object.
+
+         Internal use only.
+
+         \sa setTransitionCoalescing()
+         */
+        bool isCoalescingTransitions = false;
+
+        /*!
+         \brief [Internal] Protects `access`, `transportFactory` and `isCoalescingTransitions`,
+         so that an access object is created at most once at a time and always with the current
+         factory and settings.
+
+         Internal use only.
+         */
+        std::mutex accessMutex;
+
         /*!
          \brief [Internal] A string describing the serial port.
 
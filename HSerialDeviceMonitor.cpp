@@ -0,0 +1,205 @@
+//
+//  HSerialDeviceMonitor.cpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+
+#include "HSerialDeviceMonitor.hpp"
+
+#if defined(__linux__)
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#endif
+
+
+namespace hserial {
+
+    std::vector<serial::PortInfo> HSerialDeviceMonitor::listPorts() {
+        return serial::list_ports();
+    }
+
+#if defined(__linux__)
+
+    namespace {
+
+        // serial::list_ports globs for these names in /dev, so only they can change its result.
+        const char* const serialNamePrefixes[] = {"ttyACM", "ttyS", "ttyUSB", "tty.", "cu.", "rfcomm"};
+
+        // Device nodes usually appear in bursts (a USB adapter may create several entries,
+        //  and udev adds the by-id links afterwards), so the handler is called once things
+        //  have been quiet this long.
+        const int quietPeriodMS = 50;
+
+        bool isSerialName(const char* name) {
+            for (const char* prefix : serialNamePrefixes) {
+                if (std::strncmp(name, prefix, std::strlen(prefix)) == 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /*
+         The default Linux monitor. A thread waits on an inotify descriptor watching /dev (and
+         /dev/serial/by-id once it exists) and on an eventfd used to stop it.
+         */
+        class InotifyDeviceMonitor : public HSerialDeviceMonitor {
+
+        public:
+
+            ~InotifyDeviceMonitor() {
+                stop();
+            }
+
+            bool start(ChangeHandler _handler) override {
+                if (thread.joinable()) {
+                    return true;
+                }
+                inotifyFD = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+                if (inotifyFD < 0) {
+                    return false;
+                }
+                stopFD = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+                devWatch = inotify_add_watch(inotifyFD, "/dev", watchMask);
+                if (stopFD < 0 || devWatch < 0) {
+                    closeDescriptors();
+                    return false;
+                }
+                addByIDWatch();
+                handler = std::move(_handler);
+                thread = std::thread(&InotifyDeviceMonitor::run, this);
+                return true;
+            }
+
+            void stop() override {
+                if (thread.get_id() == std::this_thread::get_id()) {
+                    // The manager doesn't do this, but joining here would throw. The thread
+                    //  ends after the handler returns; the monitor must not be destroyed first.
+                    uint64_t one = 1;
+                    ssize_t result = write(stopFD, &one, sizeof(one));
+                    (void)result;
+                    return;
+                }
+                if (thread.joinable()) {
+                    uint64_t one = 1;
+                    ssize_t result = write(stopFD, &one, sizeof(one));
+                    (void)result;
+                    thread.join();
+                }
+                closeDescriptors();
+            }
+
+        private:
+
+            static const uint32_t watchMask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+
+            int inotifyFD = -1;
+            int stopFD = -1;
+            int devWatch = -1;
+            int byIDWatch = -1;
+            ChangeHandler handler;
+            std::thread thread;
+
+            void addByIDWatch() {
+                // /dev/serial is created when the first USB serial device is added, so this may
+                //  fail now and succeed later (see run).
+                if (byIDWatch < 0) {
+                    byIDWatch = inotify_add_watch(inotifyFD, "/dev/serial/by-id", watchMask);
+                }
+            }
+
+            void closeDescriptors() {
+                if (inotifyFD >= 0) close(inotifyFD);
+                if (stopFD >= 0) close(stopFD);
+                inotifyFD = -1;
+                stopFD = -1;
+                devWatch = -1;
+                byIDWatch = -1;
+            }
+
+            // Reads the pending events. Returns true if any of them could affect list_ports.
+            bool readEvents() {
+                alignas(struct inotify_event) char buffer[4096];
+                bool isRelevant = false;
+                while (true) {
+                    ssize_t length = read(inotifyFD, buffer, sizeof(buffer));
+                    if (length <= 0) {
+                        return isRelevant;
+                    }
+                    for (char* p = buffer; p < buffer + length; ) {
+                        struct inotify_event* event = reinterpret_cast<struct inotify_event*>(p);
+                        p += sizeof(struct inotify_event) + event->len;
+                        if (event->mask & IN_Q_OVERFLOW) {
+                            isRelevant = true;
+                        } else if (event->wd == byIDWatch) {
+                            isRelevant = true;
+                        } else if (event->len > 0) {
+                            if (std::strcmp(event->name, "serial") == 0) {
+                                addByIDWatch();
+                            }
+                            if (isSerialName(event->name)) {
+                                isRelevant = true;
+                            }
+                        }
+                        if ((event->mask & IN_IGNORED) && event->wd == byIDWatch) {
+                            // The by-id directory was removed (the last USB adapter was unplugged).
+                            byIDWatch = -1;
+                        }
+                    }
+                }
+            }
+
+            void run() {
+                struct pollfd fds[2];
+                fds[0].fd = stopFD;
+                fds[0].events = POLLIN;
+                fds[1].fd = inotifyFD;
+                fds[1].events = POLLIN;
+                bool isPending = false;
+                while (true) {
+                    // While a change is pending, wait for the quiet period before reporting it.
+                    int result = poll(fds, 2, isPending ? quietPeriodMS : -1);
+                    if (result < 0) {
+                        if (errno == EINTR) continue;
+                        return;
+                    }
+                    if (fds[0].revents != 0) {
+                        return;
+                    }
+                    if (result == 0) {
+                        isPending = false;
+                        handler();
+                        continue;
+                    }
+                    if (readEvents()) {
+                        isPending = true;
+                    }
+                }
+            }
+        };
+    }
+
+    std::unique_ptr<HSerialDeviceMonitor> HSerialDeviceMonitor::createDefault() {
+        return std::unique_ptr<HSerialDeviceMonitor>(new InotifyDeviceMonitor());
+    }
+
+#else
+
+    std::unique_ptr<HSerialDeviceMonitor> HSerialDeviceMonitor::createDefault() {
+        return nullptr;
+    }
+
+#endif
+
+}
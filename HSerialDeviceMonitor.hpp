@@ -0,0 +1,82 @@
+//
+//  HSerialDeviceMonitor.hpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+
+#ifndef HSerialDeviceMonitor_hpp
+#define HSerialDeviceMonitor_hpp
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <serial/serial.h>
+
+
+namespace hserial {
+
+    /*!
+     \brief The source of device change notifications for HSerialPortsManager.
+
+     A monitor tells the manager when the set of serial devices may have changed, and lists the
+     devices when asked. The manager keeps its device table up to date by listing the devices
+     only when notified, so HSerialPortsManager::getPorts doesn't have to scan the system on
+     every call.
+
+     The default monitor (see createDefault) uses inotify on Linux. A different monitor (for
+     example, a fake driven by a test, or one based on a netlink uevent socket) can be installed
+     with HSerialPortsManager::setDeviceMonitor.
+     */
+    class HSerialDeviceMonitor {
+
+    public:
+
+        /*!
+         \brief The notification handler type. Called when the devices may have changed.
+         */
+        typedef std::function<void()> ChangeHandler;
+
+        virtual ~HSerialDeviceMonitor() {}
+
+        /*!
+         \brief Starts monitoring.
+
+         The handler may be called from any thread, but calls must not be concurrent. Spurious
+         calls are harmless (they just cause an extra listPorts call).
+
+         \returns `false` if monitoring is not possible, in which case the manager lists the
+         ports on every HSerialPortsManager::getPorts call.
+         */
+        virtual bool start(ChangeHandler handler) = 0;
+
+        /*!
+         \brief Stops monitoring.
+
+         When this function returns the handler is not running and will not be called again.
+         Called by the manager before the monitor is destroyed (if start succeeded), never from
+         the handler.
+         */
+        virtual void stop() = 0;
+
+        /*!
+         \brief Lists the serial ports on the system.
+
+         The default implementation calls `serial::list_ports`.
+         */
+        virtual std::vector<serial::PortInfo> listPorts();
+
+        /*!
+         \brief Creates the default monitor for the platform.
+
+         On Linux this watches `/dev` and `/dev/serial/by-id` with inotify. Returns `nullptr` on
+         other platforms.
+         */
+        static std::unique_ptr<HSerialDeviceMonitor> createDefault();
+    };
+
+}
+
+#endif /* HSerialDeviceMonitor_hpp */
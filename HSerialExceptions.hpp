@@ -25,6 +25,48 @@ namespace hserial {
         NotActiveController(const std::string& description) : std::runtime_error(description) {}
     };
 
+    /*!
+     \brief Thrown when a blocking access call is cut short because the controller is being made
+     inactive.
+
+     blockAccessCalls() wakes waiting access calls made on other threads (for example, a read
+     waiting for bytes from the read pump), so that a transition doesn't have to wait for their
+     timeouts. An interrupted call throws this exception if it hasn't transferred any data yet;
+     otherwise it returns what it has, as if its timeout had been reached.
+
+     Waits inside serial::Serial itself (i.e. unbuffered reads, waitForChange, and waitByteTimes)
+     can't be interrupted. Enable read buffering for interruptible reads.
+
+     \see HSerialController::blockAccessCalls, HSerialController::enableReadBuffering
+     */
+    class AccessInterrupted : public std::runtime_error {
+    public:
+        AccessInterrupted(const std::string& description) : std::runtime_error(description) {}
+    };
+
+    /*!
+     \brief Thrown by HSerialController::makeActive when transition coalescing skipped the
+     activation.
+
+     With coalescing enabled (see HSerialPort::setTransitionCoalescing) a queued activation that
+     would be immediately undone by another controller's activation is skipped. The controller
+     never becomes active, so the blocking makeActive throws this exception. The timed variants
+     return `false` instead.
+     */
+    class ActivationSuperseded : public std::runtime_error {
+    public:
+        ActivationSuperseded(const std::string& description) : std::runtime_error(description) {}
+    };
+
+    /*!
+     \brief Thrown (or set on a future) when a transaction doesn't complete in time.
+     \see HSerialTransactionController::transact
+     */
+    class TransactionTimeout : public std::runtime_error {
+    public:
+        TransactionTimeout(const std::string& description) : std::runtime_error(description) {}
+    };
+
 // todo: consider the problem of private delegate controllers being exposed by
 //       ControllerRefuses. See the proposal in HSerialController.hpp.
 
@@ -0,0 +1,340 @@
+//
+//  HSerialFramer.cpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+
+#include "HSerialFramer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+#include "HSerialController.hpp"
+#include "HSerialAccess.hpp"
+
+
+namespace hserial {
+
+#pragma mark - COBS
+
+    namespace cobs {
+
+        size_t encode(const uint8_t* in, size_t size, uint8_t* out) {
+            const uint8_t* p = in;
+            const uint8_t* end = in + size;
+            uint8_t* o = out;
+            while (true) {
+                size_t run = std::min<size_t>(end - p, 254);
+                const uint8_t* zero = static_cast<const uint8_t*>(std::memchr(p, 0, run));
+                size_t n = (zero != nullptr) ? size_t(zero - p) : run;
+                *o++ = uint8_t(n + 1);
+                std::memcpy(o, p, n);
+                o += n;
+                p += n;
+                if (zero != nullptr) {
+                    // The zero is implied by the code. A zero at the very end still needs a
+                    //  final (empty) block.
+                    p += 1;
+                } else if (p == end) {
+                    break;
+                }
+            }
+            return o - out;
+        }
+
+        size_t decode(const uint8_t* in, size_t size, uint8_t* out) {
+            const uint8_t* p = in;
+            const uint8_t* end = in + size;
+            uint8_t* o = out;
+            while (p < end) {
+                uint8_t code = *p++;
+                if (code == 0) {
+                    return npos;
+                }
+                size_t n = code - 1;
+                if (n > size_t(end - p) || std::memchr(p, 0, n) != nullptr) {
+                    return npos;
+                }
+                // memmove, since decoding in place writes just behind the read position.
+                std::memmove(o, p, n);
+                o += n;
+                p += n;
+                if (code != 0xFF && p < end) {
+                    *o++ = 0;
+                }
+            }
+            return o - out;
+        }
+    }
+
+
+#pragma mark - SLIP
+
+    namespace slip {
+
+        namespace {
+
+            /*!
+             \brief Returns the first END or ESC byte in [p, end), or end.
+
+             Checks eight bytes at a time (a SWAR has-byte test), since special bytes are rare in
+             most payloads.
+             */
+            const uint8_t* findSpecial(const uint8_t* p, const uint8_t* end) {
+                const uint64_t ones = 0x0101010101010101ULL;
+                const uint64_t highs = 0x8080808080808080ULL;
+                const uint64_t ends = ones * END;
+                const uint64_t escs = ones * ESC;
+                while (end - p >= 8) {
+                    uint64_t v;
+                    std::memcpy(&v, p, 8);
+                    uint64_t a = v ^ ends;
+                    uint64_t b = v ^ escs;
+                    if ((((a - ones) & ~a) | ((b - ones) & ~b)) & highs) {
+                        break;
+                    }
+                    p += 8;
+                }
+                while (p < end && *p != END && *p != ESC) {
+                    ++p;
+                }
+                return p;
+            }
+        }
+
+        size_t encode(const uint8_t* in, size_t size, uint8_t* out) {
+            const uint8_t* p = in;
+            const uint8_t* end = in + size;
+            uint8_t* o = out;
+            while (p < end) {
+                const uint8_t* special = findSpecial(p, end);
+                size_t n = special - p;
+                std::memcpy(o, p, n);
+                o += n;
+                if (special == end) {
+                    break;
+                }
+                *o++ = ESC;
+                *o++ = (*special == END) ? ESC_END : ESC_ESC;
+                p = special + 1;
+            }
+            return o - out;
+        }
+
+        size_t decode(const uint8_t* in, size_t size, uint8_t* out) {
+            const uint8_t* p = in;
+            const uint8_t* end = in + size;
+            uint8_t* o = out;
+            while (p < end) {
+                const uint8_t* special = findSpecial(p, end);
+                size_t n = special - p;
+                std::memmove(o, p, n);
+                o += n;
+                if (special == end) {
+                    break;
+                }
+                if (*special == END || special + 1 == end) {
+                    return npos;
+                }
+                uint8_t escaped = special[1];
+                if (escaped == ESC_END) {
+                    *o++ = END;
+                } else if (escaped == ESC_ESC) {
+                    *o++ = ESC;
+                } else {
+                    return npos;
+                }
+                p = special + 2;
+            }
+            return o - out;
+        }
+    }
+
+
+#pragma mark - HSerialFrame
+
+    /*!
+     \brief [Internal] Buffers for frames, shared by a framer and the frames it returns.
+     */
+    struct HSerialFrame::Pool {
+
+        /*!
+         \brief The most idle buffers kept. More are freed when returned.
+         */
+        static const size_t maxIdleBuffers = 16;
+
+        explicit Pool(size_t _bufferSize) : bufferSize(_bufferSize) {}
+
+        std::vector<uint8_t> take() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!idle.empty()) {
+                    std::vector<uint8_t> buffer = std::move(idle.back());
+                    idle.pop_back();
+                    return buffer;
+                }
+            }
+            return std::vector<uint8_t>(bufferSize);
+        }
+
+        void give(std::vector<uint8_t>&& buffer) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (idle.size() < maxIdleBuffers) {
+                idle.push_back(std::move(buffer));
+            }
+        }
+
+        const size_t bufferSize;
+        std::mutex mutex;
+        std::vector<std::vector<uint8_t>> idle;
+    };
+
+    HSerialFrame::HSerialFrame(std::shared_ptr<Pool> _pool, std::vector<uint8_t>&& _buffer, size_t _length)
+    : pool(std::move(_pool)), buffer(std::move(_buffer)), length(_length), isValid(true) {}
+
+    HSerialFrame::~HSerialFrame() {
+        if (pool) {
+            pool->give(std::move(buffer));
+        }
+    }
+
+    HSerialFrame::HSerialFrame(HSerialFrame&& other)
+    : pool(std::move(other.pool)), buffer(std::move(other.buffer)), length(other.length), isValid(other.isValid) {
+        other.length = 0;
+        other.isValid = false;
+    }
+
+    HSerialFrame& HSerialFrame::operator=(HSerialFrame&& other) {
+        if (this != &other) {
+            if (pool) {
+                pool->give(std::move(buffer));
+            }
+            pool = std::move(other.pool);
+            buffer = std::move(other.buffer);
+            length = other.length;
+            isValid = other.isValid;
+            other.pool.reset();
+            other.length = 0;
+            other.isValid = false;
+        }
+        return *this;
+    }
+
+
+#pragma mark - HSerialFramer
+
+    HSerialFramer::HSerialFramer(HSerialController& _controller, Codec _codec, size_t _maxFrameSize)
+    : controller(_controller), codec(_codec), maxFrameSize(_maxFrameSize), delimiter(_codec == Codec::cobs ? 0 : slip::END) {
+        // The longest acceptable encoded frame, plus its delimiter. Decoding never lengthens a
+        //  frame, so pool buffers of this size always have room.
+        size_t capacity = (codec == Codec::cobs ? cobs::maxEncodedSize(maxFrameSize) : slip::maxEncodedSize(maxFrameSize)) + 1;
+        current.resize(capacity);
+        pool = std::make_shared<HSerialFrame::Pool>(capacity);
+    }
+
+    size_t HSerialFramer::maxFrameEncodedSize(size_t size) const {
+        if (codec == Codec::cobs) {
+            return cobs::maxEncodedSize(size) + 1;
+        } else {
+            return slip::maxEncodedSize(size) + 2;
+        }
+    }
+
+    size_t HSerialFramer::encodeFrame(const uint8_t* data, size_t size, uint8_t* out) const {
+        if (codec == Codec::cobs) {
+            size_t n = cobs::encode(data, size, out);
+            out[n] = 0;
+            return n + 1;
+        } else {
+            // A leading END flushes any line noise received before the frame (RFC 1055).
+            out[0] = slip::END;
+            size_t n = slip::encode(data, size, out + 1);
+            out[n + 1] = slip::END;
+            return n + 2;
+        }
+    }
+
+    HSerialFrame HSerialFramer::readFrame() {
+        HSerialByteView eol(&delimiter, 1);
+        while (true) {
+            size_t space = current.size() - currentLength;
+            size_t count = controller.access->readline(controller, current.data() + currentLength, space, eol);
+            if (count == 0) {
+                return HSerialFrame();
+            }
+            currentLength += count;
+
+            if (current[currentLength - 1] != delimiter) {
+                if (currentLength < current.size()) {
+                    // Timed out. Keep the partial frame for the next call.
+                    return HSerialFrame();
+                }
+                // Too long. Throw away what was read, and the rest up to the next delimiter.
+                if (!isDiscarding) {
+                    numDroppedFrames += 1;
+                    isDiscarding = true;
+                }
+                currentLength = 0;
+                continue;
+            }
+
+            size_t encodedLength = currentLength - 1;
+            currentLength = 0;
+            if (isDiscarding) {
+                isDiscarding = false;
+                continue;
+            }
+            if (encodedLength == 0) {
+                continue;
+            }
+
+            std::vector<uint8_t> buffer = pool->take();
+            size_t length;
+            if (codec == Codec::cobs) {
+                length = cobs::decode(current.data(), encodedLength, buffer.data());
+            } else {
+                length = slip::decode(current.data(), encodedLength, buffer.data());
+            }
+            // (cobs::npos and slip::npos are the same value.)
+            if (length == cobs::npos || length > maxFrameSize) {
+                numDroppedFrames += 1;
+                pool->give(std::move(buffer));
+                continue;
+            }
+            return HSerialFrame(pool, std::move(buffer), length);
+        }
+    }
+
+    bool HSerialFramer::writeFrame(const uint8_t* data, size_t size) {
+        size_t maxSize = maxFrameEncodedSize(size);
+        if (txBuffer.size() < maxSize) {
+            txBuffer.resize(maxSize);
+        }
+        size_t encodedSize = encodeFrame(data, size, txBuffer.data());
+        return controller.access->write(controller, txBuffer.data(), encodedSize) == encodedSize;
+    }
+
+    bool HSerialFramer::writeFrame(const HSerialByteView& data) {
+        return writeFrame(data.data, data.size);
+    }
+
+    uint64_t HSerialFramer::enqueueFrame(const uint8_t* data, size_t size) {
+        return controller.access->enqueueWrite(controller, maxFrameEncodedSize(size), [this, data, size](uint8_t* out) {
+            return encodeFrame(data, size, out);
+        });
+    }
+
+    uint64_t HSerialFramer::enqueueFrame(const HSerialByteView& data) {
+        return enqueueFrame(data.data, data.size);
+    }
+
+    void HSerialFramer::reset() {
+        // If part of a frame was read, the rest of it is still to come.
+        isDiscarding = (currentLength > 0);
+        currentLength = 0;
+    }
+
+}
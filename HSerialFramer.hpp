@@ -0,0 +1,286 @@
+//
+//  HSerialFramer.hpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+
+#ifndef HSerialFramer_hpp
+#define HSerialFramer_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "HSerialByteView.hpp"
+
+
+namespace hserial {
+
+    class HSerialController;
+
+    /*!
+     \brief Consistent Overhead Byte Stuffing.
+
+     Encoded data contains no zero bytes, so a zero byte delimits frames.
+     */
+    namespace cobs {
+
+        /*!
+         \brief The value returned by decode for malformed input.
+         */
+        const size_t npos = static_cast<size_t>(-1);
+
+        /*!
+         \brief Returns the largest possible encoded size of `size` bytes (without a delimiter).
+         */
+        inline size_t maxEncodedSize(size_t size) {
+            return size + size / 254 + 1;
+        }
+
+        /*!
+         \brief Encodes `size` bytes. `out` must have room for maxEncodedSize(size) bytes and must
+         not overlap `in`. No delimiter is appended.
+         \returns The encoded size.
+         */
+        size_t encode(const uint8_t* in, size_t size, uint8_t* out);
+
+        /*!
+         \brief Decodes `size` bytes (without the delimiter). `out` may be the same as `in`.
+         \returns The decoded size, or npos if the input is malformed (contains a zero, or a code
+         byte points past the end).
+         */
+        size_t decode(const uint8_t* in, size_t size, uint8_t* out);
+    }
+
+    /*!
+     \brief Serial Line Internet Protocol framing (RFC 1055).
+
+     END bytes delimit frames, and END and ESC bytes in the data are escaped.
+     */
+    namespace slip {
+
+        const uint8_t END = 0xC0;
+        const uint8_t ESC = 0xDB;
+        const uint8_t ESC_END = 0xDC;
+        const uint8_t ESC_ESC = 0xDD;
+
+        /*!
+         \brief The value returned by decode for malformed input.
+         */
+        const size_t npos = static_cast<size_t>(-1);
+
+        /*!
+         \brief Returns the largest possible encoded size of `size` bytes (without delimiters).
+         */
+        inline size_t maxEncodedSize(size_t size) {
+            return 2 * size;
+        }
+
+        /*!
+         \brief Escapes `size` bytes. `out` must have room for maxEncodedSize(size) bytes and must
+         not overlap `in`. No END bytes are added.
+         \returns The encoded size.
+         */
+        size_t encode(const uint8_t* in, size_t size, uint8_t* out);
+
+        /*!
+         \brief Unescapes `size` bytes (without END bytes). `out` may be the same as `in`.
+         \returns The decoded size, or npos if the input is malformed (contains an END, or an ESC
+         not followed by ESC_END or ESC_ESC).
+         */
+        size_t decode(const uint8_t* in, size_t size, uint8_t* out);
+    }
+
+    class HSerialFramer;
+
+    /*!
+     \brief A decoded frame returned by HSerialFramer::readFrame.
+
+     The frame owns its buffer, which came from the framer's pool and goes back to it when the
+     frame is destroyed, so reading frames in a loop doesn't allocate once the pool has warmed
+     up. A frame may outlive its framer.
+
+     A default constructed frame (or one returned when no frame was read) is empty and
+     evaluates to `false`. Note that a valid frame may also have a size of zero.
+     */
+    class HSerialFrame {
+
+    public:
+
+        HSerialFrame() {}
+        ~HSerialFrame();
+
+        HSerialFrame(HSerialFrame&& other);
+        HSerialFrame& operator=(HSerialFrame&& other);
+        HSerialFrame(const HSerialFrame&) = delete;
+        HSerialFrame& operator=(const HSerialFrame&) = delete;
+
+        /*!
+         \brief Indicates if the object holds a frame.
+         */
+        explicit operator bool() const {
+            return isValid;
+        }
+
+        const uint8_t* data() const {
+            return buffer.data();
+        }
+
+        size_t size() const {
+            return length;
+        }
+
+        HSerialByteView view() const {
+            return HSerialByteView(buffer.data(), length);
+        }
+
+    private:
+
+        friend class HSerialFramer;
+
+        struct Pool;
+
+        HSerialFrame(std::shared_ptr<Pool> pool, std::vector<uint8_t>&& buffer, size_t length);
+
+        std::shared_ptr<Pool> pool;
+        std::vector<uint8_t> buffer;
+        size_t length = 0;
+        bool isValid = false;
+    };
+
+    /*!
+     \brief Reads and writes COBS or SLIP framed packets through a controller.
+
+     The framer works with any controller. Reading uses the controller's delimiter-searching
+     readline, which reads the port in large chunks (through the read buffer) and finds the
+     delimiter with the vectorized scan kernels, and then decodes the frame in place. Writing
+     encodes directly into the destination: a reusable buffer for writeFrame, or the
+     controller's write queue for enqueueFrame.
+
+     Frames that are malformed, or longer than the maximum frame size, are dropped and counted
+     (see getNumDroppedFrames). Empty frames (consecutive delimiters) are skipped.
+
+     A framer is not thread-safe, and it should be the only reader of the controller while it
+     holds a partial frame (see reset).
+     */
+    class HSerialFramer {
+
+    public:
+
+        enum class Codec {
+            cobs,
+            slip
+        };
+
+        /*!
+         \brief Creates a framer for a controller.
+
+         \param controller The controller to read and write with. It must outlive the framer.
+         \param codec The framing to use.
+         \param maxFrameSize The largest decoded frame that will be accepted.
+         */
+        HSerialFramer(HSerialController& controller, Codec codec, size_t maxFrameSize = 4096);
+
+        HSerialFramer(const HSerialFramer&) = delete;
+        HSerialFramer& operator=(const HSerialFramer&) = delete;
+
+        /*!
+         \brief Reads the next complete frame.
+
+         Each read of the port is subject to the controller's timeout. If a frame isn't
+         complete when a read times out, the bytes read so far are kept for the next call, and
+         an empty frame is returned.
+
+         \throws serial::PortNotOpenedException
+         \throws serial::SerialException
+         \throws hserial::NotActiveController
+         \throws hserial::AccessInterrupted
+         \see HSerialController::readline(uint8_t* buffer, size_t size, const HSerialByteView& eol)
+         */
+        HSerialFrame readFrame();
+
+        /*!
+         \brief Encodes and writes a frame with a single write call.
+         \returns `true` if the whole frame was written, or `false` if the write timed out first
+         (the receiver will drop the partial frame).
+         \throws (the exceptions of HSerialController::write)
+         */
+        bool writeFrame(const uint8_t* data, size_t size);
+
+        /*!
+         \brief Encodes and writes a frame with a single write call.
+         \see writeFrame(const uint8_t* data, size_t size)
+         */
+        bool writeFrame(const HSerialByteView& data);
+
+        /*!
+         \brief Encodes a frame directly into the controller's write queue.
+         \returns A ticket for HSerialController::waitForQueuedWrite.
+         \throws (the exceptions of HSerialController::enqueueWrite)
+         */
+        uint64_t enqueueFrame(const uint8_t* data, size_t size);
+
+        /*!
+         \brief Encodes a frame directly into the controller's write queue.
+         \see enqueueFrame(const uint8_t* data, size_t size)
+         */
+        uint64_t enqueueFrame(const HSerialByteView& data);
+
+        /*!
+         \brief Discards the partial frame, if any. The rest of that frame, up to its delimiter,
+         is discarded when it is read.
+         */
+        void reset();
+
+        /*!
+         \brief Returns the number of frames dropped because they were malformed or too long.
+         */
+        uint64_t getNumDroppedFrames() const {
+            return numDroppedFrames;
+        }
+
+        /*!
+         \brief Returns the largest possible encoded size of a frame of `size` bytes, including
+         delimiters.
+         */
+        size_t maxFrameEncodedSize(size_t size) const;
+
+    private:
+
+        HSerialController& controller;
+        const Codec codec;
+        const size_t maxFrameSize;
+        const uint8_t delimiter;
+
+        std::shared_ptr<HSerialFrame::Pool> pool;
+
+        /*!
+         \brief The encoded bytes of the frame being read, and how many there are.
+         */
+        std::vector<uint8_t> current;
+        size_t currentLength = 0;
+
+        /*!
+         \brief Set after an oversized frame, until its delimiter has been read.
+         */
+        bool isDiscarding = false;
+
+        /*!
+         \brief Reused by writeFrame.
+         */
+        std::vector<uint8_t> txBuffer;
+
+        uint64_t numDroppedFrames = 0;
+
+        /*!
+         \brief Encodes a complete frame, with delimiters, into `out`.
+         */
+        size_t encodeFrame(const uint8_t* data, size_t size, uint8_t* out) const;
+    };
+
+}
+
+#endif /* HSerialFramer_hpp */
@@ -0,0 +1,239 @@
+//
+//  HSerialLoopbackTransport.cpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+
+#include "HSerialLoopbackTransport.hpp"
+
+#include <algorithm>
+#include <thread>
+
+
+namespace hserial {
+
+    HSerialTransportFactory HSerialLoopbackTransport::factory() {
+        return [](const std::string&) {
+            return std::unique_ptr<HSerialTransport>(new HSerialLoopbackTransport());
+        };
+    }
+
+
+#pragma mark - Opening and Closing
+
+    void HSerialLoopbackTransport::open() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (isOpenFlag) throw serial::SerialException("Serial port already open.");
+        isOpenFlag = true;
+    }
+
+    bool HSerialLoopbackTransport::isOpen() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return isOpenFlag;
+    }
+
+    void HSerialLoopbackTransport::close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            isOpenFlag = false;
+            data.clear();
+        }
+        condition.notify_all();
+    }
+
+
+#pragma mark - Reading, Writing, and Waiting
+
+    size_t HSerialLoopbackTransport::available() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return data.size();
+    }
+
+    bool HSerialLoopbackTransport::waitReadable() {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout.read_timeout_constant);
+        condition.wait_until(lock, deadline, [this]() {return !data.empty() || !isOpenFlag;});
+        return !data.empty();
+    }
+
+    void HSerialLoopbackTransport::waitByteTimes(size_t count) {
+        std::chrono::nanoseconds byteTime;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            byteTime = characterTime(baudrate, bytesize, parity, stopbits);
+        }
+        std::this_thread::sleep_for(byteTime * count);
+    }
+
+    size_t HSerialLoopbackTransport::read(uint8_t* buffer, size_t size) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!isOpenFlag) throw serial::PortNotOpenedException("HSerialLoopbackTransport::read");
+        auto deadline = readDeadline(timeout, size);
+        size_t count = 0;
+        while (true) {
+            size_t n = std::min(size - count, data.size());
+            std::copy(data.begin(), data.begin() + n, buffer + count);
+            data.erase(data.begin(), data.begin() + n);
+            count += n;
+            if (count == size || !isOpenFlag) {
+                break;
+            }
+            auto waitDeadline = deadline;
+            if (count > 0 && timeout.inter_byte_timeout != serial::Timeout::max()) {
+                waitDeadline = std::min(deadline, std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout.inter_byte_timeout));
+            }
+            if (!condition.wait_until(lock, waitDeadline, [this]() {return !data.empty() || !isOpenFlag;})) {
+                break;
+            }
+        }
+        return count;
+    }
+
+    size_t HSerialLoopbackTransport::write(const uint8_t* bytes, size_t size) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!isOpenFlag) throw serial::PortNotOpenedException("HSerialLoopbackTransport::write");
+            data.insert(data.end(), bytes, bytes + size);
+        }
+        condition.notify_all();
+        return size;
+    }
+
+
+#pragma mark - Settings
+
+    void HSerialLoopbackTransport::setBaudrate(uint32_t _baudrate) {
+        std::lock_guard<std::mutex> lock(mutex);
+        baudrate = _baudrate;
+    }
+
+    uint32_t HSerialLoopbackTransport::getBaudrate() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return baudrate;
+    }
+
+    void HSerialLoopbackTransport::setTimeout(const serial::Timeout& _timeout) {
+        std::lock_guard<std::mutex> lock(mutex);
+        timeout = _timeout;
+    }
+
+    serial::Timeout HSerialLoopbackTransport::getTimeout() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return timeout;
+    }
+
+    void HSerialLoopbackTransport::setBytesize(serial::bytesize_t _bytesize) {
+        std::lock_guard<std::mutex> lock(mutex);
+        bytesize = _bytesize;
+    }
+
+    serial::bytesize_t HSerialLoopbackTransport::getBytesize() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return bytesize;
+    }
+
+    void HSerialLoopbackTransport::setParity(serial::parity_t _parity) {
+        std::lock_guard<std::mutex> lock(mutex);
+        parity = _parity;
+    }
+
+    serial::parity_t HSerialLoopbackTransport::getParity() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return parity;
+    }
+
+    void HSerialLoopbackTransport::setStopbits(serial::stopbits_t _stopbits) {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopbits = _stopbits;
+    }
+
+    serial::stopbits_t HSerialLoopbackTransport::getStopbits() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stopbits;
+    }
+
+    void HSerialLoopbackTransport::setFlowcontrol(serial::flowcontrol_t _flowcontrol) {
+        std::lock_guard<std::mutex> lock(mutex);
+        flowcontrol = _flowcontrol;
+    }
+
+    serial::flowcontrol_t HSerialLoopbackTransport::getFlowcontrol() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return flowcontrol;
+    }
+
+
+#pragma mark - Buffers and Lines
+
+    void HSerialLoopbackTransport::flush() {
+        // Written bytes are delivered immediately, so there is nothing to wait for.
+    }
+
+    void HSerialLoopbackTransport::flushInput() {
+        std::lock_guard<std::mutex> lock(mutex);
+        data.clear();
+    }
+
+    void HSerialLoopbackTransport::flushOutput() {
+        // There is no output buffer.
+    }
+
+    void HSerialLoopbackTransport::sendBreak(int duration) {
+        // A break carries no data, so only the timing is simulated.
+        std::this_thread::sleep_for(std::chrono::milliseconds(duration));
+    }
+
+    void HSerialLoopbackTransport::setBreak(bool level) {
+        // The break condition isn't modelled.
+        (void)level;
+    }
+
+    void HSerialLoopbackTransport::setRTS(bool level) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (rts == level) return;
+            rts = level;
+            ++lineChangeCount;
+        }
+        condition.notify_all();
+    }
+
+    void HSerialLoopbackTransport::setDTR(bool level) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (dtr == level) return;
+            dtr = level;
+            ++lineChangeCount;
+        }
+        condition.notify_all();
+    }
+
+    bool HSerialLoopbackTransport::waitForChange() {
+        std::unique_lock<std::mutex> lock(mutex);
+        uint64_t startCount = lineChangeCount;
+        condition.wait(lock, [this, startCount]() {return lineChangeCount != startCount || !isOpenFlag;});
+        return lineChangeCount != startCount;
+    }
+
+    bool HSerialLoopbackTransport::getCTS() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return rts;
+    }
+
+    bool HSerialLoopbackTransport::getDSR() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return dtr;
+    }
+
+    bool HSerialLoopbackTransport::getRI() {
+        return false;
+    }
+
+    bool HSerialLoopbackTransport::getCD() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return dtr;
+    }
+
+}
@@ -0,0 +1,124 @@
+//
+//  HSerialLoopbackTransport.hpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+
+#ifndef HSerialLoopbackTransport_hpp
+#define HSerialLoopbackTransport_hpp
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+#include "HSerialTransport.hpp"
+
+
+namespace hserial {
+
+    /*!
+     \brief An in-memory transport that behaves like a port with a loopback plug.
+
+     Bytes written are immediately available to read. RTS is looped back to CTS, and DTR to DSR
+     and CD. There are no line rate delays (except in waitByteTimes), so the transport is
+     useful for exercising the access and transition layers at full speed without hardware.
+
+     The settings are stored and reported, but have no effect. setBreak does nothing. The input is discarded when
+     the transport is closed.
+
+     To use a loopback port:
+
+         HSerialPortsManager::getInstance().registerTransport("loop0", HSerialLoopbackTransport::factory());
+         HSerial serial("loop0");
+     */
+    class HSerialLoopbackTransport : public HSerialTransport {
+
+    public:
+
+        HSerialLoopbackTransport() {}
+
+        /*!
+         \brief Returns a factory that creates loopback transports.
+         */
+        static HSerialTransportFactory factory();
+
+        void open() override;
+        bool isOpen() const override;
+        void close() override;
+
+        size_t available() override;
+        bool waitReadable() override;
+        void waitByteTimes(size_t count) override;
+        size_t read(uint8_t* buffer, size_t size) override;
+        size_t write(const uint8_t* data, size_t size) override;
+
+        using HSerialTransport::read;
+        using HSerialTransport::write;
+
+        void setBaudrate(uint32_t baudrate) override;
+        uint32_t getBaudrate() const override;
+        void setTimeout(const serial::Timeout& timeout) override;
+        serial::Timeout getTimeout() const override;
+        void setBytesize(serial::bytesize_t bytesize) override;
+        serial::bytesize_t getBytesize() const override;
+        void setParity(serial::parity_t parity) override;
+        serial::parity_t getParity() const override;
+        void setStopbits(serial::stopbits_t stopbits) override;
+        serial::stopbits_t getStopbits() const override;
+        void setFlowcontrol(serial::flowcontrol_t flowcontrol) override;
+        serial::flowcontrol_t getFlowcontrol() const override;
+
+        void flush() override;
+        void flushInput() override;
+        void flushOutput() override;
+        void sendBreak(int duration) override;
+        void setBreak(bool level) override;
+        void setRTS(bool level) override;
+        void setDTR(bool level) override;
+        bool waitForChange() override;
+        bool getCTS() override;
+        bool getDSR() override;
+        bool getRI() override;
+        bool getCD() override;
+
+    private:
+
+        /*!
+         \brief Protects everything below.
+         */
+        mutable std::mutex mutex;
+
+        /*!
+         \brief Notified when bytes are written, when a line changes, and when the transport is
+         closed.
+         */
+        std::condition_variable condition;
+
+        bool isOpenFlag = false;
+
+        /*!
+         \brief The bytes written and not yet read.
+         */
+        std::deque<uint8_t> data;
+
+        uint32_t baudrate = 9600;
+        serial::Timeout timeout;
+        serial::bytesize_t bytesize = serial::eightbits;
+        serial::parity_t parity = serial::parity_none;
+        serial::stopbits_t stopbits = serial::stopbits_one;
+        serial::flowcontrol_t flowcontrol = serial::flowcontrol_none;
+
+        bool rts = false;
+        bool dtr = false;
+
+        /*!
+         \brief Incremented when a looped back line changes (for waitForChange).
+         */
+        uint64_t lineChangeCount = 0;
+    };
+
+}
+
+#endif /* HSerialLoopbackTransport_hpp */
@@ -35,6 +35,18 @@ namespace hserial {
         return device->getCurrentController();
     }
 
+    HSerialTransitionQueue HSerialPort::getTransitionQueue() {
+        return device->getTransitionQueue();
+    }
+
+    void HSerialPort::setTransitionCoalescing(bool enabled) {
+        device->setTransitionCoalescing(enabled);
+    }
+
+    bool HSerialPort::isTransitionCoalescingEnabled() {
+        return device->isTransitionCoalescingEnabled();
+    }
+
     std::string HSerialPort::getDeviceName() const {
         return device->deviceName;
     }
@@ -43,7 +55,7 @@ namespace hserial {
         std::string s = device->getDescription();
         if (s.empty()) {
             HSerialPortsManager& manager = HSerialPortsManager::getInstance();
-            manager.refreshDeviceDetails(*device);
+            manager.refreshDeviceDetails();
             return device->getDescription();
         }
         return s;
@@ -53,7 +65,7 @@ namespace hserial {
         std::string s = device->getHardwareID();
         if (s.empty()) {
             HSerialPortsManager& manager = HSerialPortsManager::getInstance();
-            manager.refreshDeviceDetails(*device);
+            manager.refreshDeviceDetails();
             return device->getHardwareID();
         }
         return s;
@@ -12,6 +12,8 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <chrono>
+#include <thread>
 
 
 namespace hserial {
@@ -20,6 +22,57 @@ namespace hserial {
     class HSerialPortsManager;
     class HSerialDevice;
 
+    /*!
+     \brief A controller change waiting for a port, as reported by HSerialPort::getTransitionQueue.
+     */
+    struct HSerialTransitionWaiter {
+
+        /*!
+         \brief The controller that requested the change.
+
+         __Warning__: This is only safe to dereference if the caller knows the controller still
+         exists.
+         */
+        const HSerialController* controller = nullptr;
+
+        /*!
+         \brief The thread waiting to make the change.
+         */
+        std::thread::id thread;
+
+        /*!
+         \brief The priority the change was requested with.
+         */
+        int priority = 0;
+
+        /*!
+         \brief The priority including what the change has gained by waiting.
+         */
+        int effectivePriority = 0;
+
+        /*!
+         \brief How long the change has been waiting.
+         */
+        std::chrono::microseconds waitTime {0};
+    };
+
+    /*!
+     \brief A snapshot of the controller changes waiting for a port.
+     */
+    struct HSerialTransitionQueue {
+
+        /*!
+         \brief Indicates if a controller change was being made when the snapshot was taken.
+         */
+        bool isTransitionInProgress = false;
+
+        /*!
+         \brief The waiting changes, in the order they would go if nothing else were queued. The
+         queue depth is `waiters.size()`.
+         */
+        std::vector<HSerialTransitionWaiter> waiters;
+    };
+
     /*!
      \brief A lightweight representation of a serial port.
      
@@ -109,6 +162,50 @@ namespace hserial {
          */
         HSerialController* getCurrentController();
 
+        /*!
+         \brief Returns the controller changes waiting for the port.
+
+         Controller changes (made by makeActive, makeInactive, and removeFromAccess) are
+         serialized per port. Waiting changes are served by priority, and a waiting change gains
+         one priority level per 10 ms waited so that none waits forever.
+
+         The snapshot is out of date as soon as it is returned. It is meant for monitoring and
+         debugging.
+
+         \see HSerialController::makeActive, hserial::priority
+         */
+        HSerialTransitionQueue getTransitionQueue();
+
+        /*!
+         \brief Enables or disables coalescing of queued activations.
+
+         Normally each queued makeActive call makes its controller active in turn. If controllers
+         A, B and C all call makeActive while D is active, the port goes D to A, A to B, and B to
+         C, with full transition callbacks each time, although A and B are superseded before
+         they can use the port.
+
+         With coalescing enabled, an activation that is waiting in the queue and would be
+         immediately followed by another controller's activation is skipped, so the port goes
+         straight from D to C. Once the later activation has succeeded a skipped makeActive call
+         throws ActivationSuperseded (the timed variants return `false`). No transition callbacks
+         are called for it, and the controller is inactive. If the later activation fails (e.g. D
+         refuses) the skipped calls go back into the queue in their original places. A skipped
+         timed call still returns `false` when its deadline passes, without waiting for the
+         later activation.
+
+         Only activations are coalesced, and only those whose controller allows it (see
+         HSerialController::canSkipActivation -- HSerial's makeLockedActive is never skipped).
+
+         Coalescing is disabled by default. The setting lasts for the life of the program.
+         */
+        void setTransitionCoalescing(bool enabled);
+
+        /*!
+         \brief Indicates if coalescing of queued activations is enabled.
+         \see setTransitionCoalescing
+         */
+        bool isTransitionCoalescingEnabled();
+
     private:
 
         /*!
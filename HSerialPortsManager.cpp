@@ -8,75 +8,271 @@
 
 #include "HSerialPortsManager.hpp"
 
+#include <algorithm>
+#include <thread>
+#include <unordered_set>
+
 #include "HSerialPort.hpp"
 #include "HSerialDevice.hpp"
 
 
 namespace hserial {
 
+    namespace {
+
+        // The monitor whose handler is running on this thread, if any.
+        thread_local const HSerialDeviceMonitor* handlingMonitor = nullptr;
+    }
+
     HSerialPortsManager& HSerialPortsManager::getInstance() {
         static HSerialPortsManager instance;
         return instance;
     }
 
 
+    HSerialPortsManager::~HSerialPortsManager() {
+        if (monitor && isMonitoring) {
+            monitor->stop();
+        }
+    }
+
     std::vector<HSerialPort> HSerialPortsManager::getPorts() {
-        std::lock_guard<std::mutex> lock(devicesMutex);
-        std::vector<serial::PortInfo> portInfoList = serial::list_ports();
-        std::vector<HSerialPort> ports;
-        for (const serial::PortInfo& portInfo : portInfoList) {
-            if (portInfo.port.empty()) continue; // not expected
-            // Using emplace_back could save a copy, but would require the HSerialPort device
-            //  constructor be public.
-            HSerialPort port(getDeviceInternal(portInfo));
-            ports.push_back(port);
+        std::shared_ptr<HSerialDeviceMonitor> source;
+        {
+            std::lock_guard<std::mutex> lock(monitorMutex);
+            startMonitoring();
+            source = monitor;
         }
-        return ports;
+        if (!isTableCurrent.load()) {
+            scan(source.get());
+        }
+        std::lock_guard<std::mutex> lock(tableMutex);
+        return presentPorts;
+    }
+
+    HSerialPortsManager::SubscriptionID HSerialPortsManager::subscribe(PortChangeHandler handler) {
+        std::shared_ptr<HSerialDeviceMonitor> source;
+        {
+            std::lock_guard<std::mutex> lock(monitorMutex);
+            startMonitoring();
+            source = monitor;
+        }
+        // Changes are reported relative to the table, so it must be current before the
+        //  subscription starts.
+        if (!isTableCurrent.load()) {
+            scan(source.get());
+        }
+        std::lock_guard<std::recursive_mutex> lock(subscribersMutex);
+        SubscriptionID subscription = nextSubscriptionID++;
+        subscriptions.emplace_back(subscription, std::move(handler));
+        return subscription;
+    }
+
+    void HSerialPortsManager::unsubscribe(SubscriptionID subscription) {
+        // Locking subscribersMutex waits for a notification in progress on another thread.
+        std::lock_guard<std::recursive_mutex> lock(subscribersMutex);
+        subscriptions.erase(std::remove_if(subscriptions.begin(), subscriptions.end(),
+                                           [subscription](const std::pair<SubscriptionID, PortChangeHandler>& entry) {
+                                               return entry.first == subscription;
+                                           }), subscriptions.end());
+    }
+
+    void HSerialPortsManager::setDeviceMonitor(std::unique_ptr<HSerialDeviceMonitor> newMonitor) {
+        std::shared_ptr<HSerialDeviceMonitor> oldMonitor;
+        bool wasMonitoring;
+        {
+            std::lock_guard<std::mutex> lock(monitorMutex);
+            oldMonitor = std::move(monitor);
+            wasMonitoring = isMonitoring;
+            monitor = std::move(newMonitor);
+            hasMonitorBeenConfigured = true;
+            isMonitoring = false;
+            isTableCurrent.store(false);
+        }
+        if (!oldMonitor || !wasMonitoring) {
+            return;
+        }
+        if (oldMonitor.get() == handlingMonitor) {
+            // Called by a subscriber on the old monitor's thread, which can't wait for itself.
+            //  Another thread stops the monitor once the handler returns, and destroys it.
+            std::thread([oldMonitor]() {
+                oldMonitor->stop();
+            }).detach();
+            return;
+        }
+        // Stopped with monitorMutex unlocked, since its handler may be scanning.
+        oldMonitor->stop();
     }
 
     HSerialPort HSerialPortsManager::portForDeviceName(const std::string& deviceName) {
-        if (deviceName.empty()) throw std::invalid_argument("Device name must not be empty.");
-        std::lock_guard<std::mutex> lock(devicesMutex);
         return HSerialPort(getDeviceInternal(deviceName));
     }
 
+    HSerialPort HSerialPortsManager::registerTransport(const std::string& deviceName, HSerialTransportFactory factory) {
+        std::shared_ptr<HSerialDevice> device = getDeviceInternal(deviceName);
+        device->setTransportFactory(std::move(factory));
+        return HSerialPort(device);
+    }
+
     std::shared_ptr<HSerialDevice> HSerialPortsManager::getDevice(const std::string& deviceName) {
-        std::lock_guard<std::mutex> lock(devicesMutex);
         return getDeviceInternal(deviceName);
     }
 
-    void HSerialPortsManager::refreshDeviceDetails(HSerialDevice& device) {
-        std::lock_guard<std::mutex> lock(devicesMutex);
-        std::vector<serial::PortInfo> portInfoList = serial::list_ports();
-        for (const serial::PortInfo& info : portInfoList) {
-            if (info.port == device.deviceName) {
-                device.setDescriptionAndHardwareID(info.description, info.hardware_id);
-                return;
+    void HSerialPortsManager::setDetailsStalenessWindow(std::chrono::milliseconds window) {
+        std::lock_guard<std::mutex> lock(tableMutex);
+        detailsStalenessWindow = window;
+    }
+
+    std::chrono::milliseconds HSerialPortsManager::getDetailsStalenessWindow() {
+        std::lock_guard<std::mutex> lock(tableMutex);
+        return detailsStalenessWindow;
+    }
+
+    void HSerialPortsManager::refreshDeviceDetails() {
+        // Scans update the details of every listed device, so one scan serves all the devices,
+        //  and a device without details after a recent scan doesn't have any to find.
+        std::shared_ptr<HSerialDeviceMonitor> source;
+        {
+            std::lock_guard<std::mutex> lock(monitorMutex);
+            startMonitoring();
+            source = monitor;
+        }
+        if (isTableCurrent.load()) {
+            return;
+        }
+        std::chrono::milliseconds maxAge;
+        {
+            std::lock_guard<std::mutex> lock(tableMutex);
+            maxAge = detailsStalenessWindow;
+        }
+        scan(source.get(), maxAge);
+    }
+
+    bool HSerialPortsManager::startMonitoring() {
+        // Assumes monitorMutex is locked.
+        if (!hasMonitorBeenConfigured) {
+            monitor = HSerialDeviceMonitor::createDefault();
+            hasMonitorBeenConfigured = true;
+        }
+        if (monitor && !isMonitoring) {
+            HSerialDeviceMonitor* source = monitor.get();
+            isTableCurrent.store(false);
+            isMonitoring = monitor->start([this, source]() {
+                // The monitor is alive while its handler runs (stop waits for it).
+                handlingMonitor = source;
+                isTableCurrent.store(false);
+                try {
+                    scan(source);
+                } catch (...) {
+                    // Nothing on the monitor's thread can handle the error, and letting it
+                    //  escape would terminate the program. The table stays marked as not
+                    //  current, so the next getPorts scans again.
+                    isTableCurrent.store(false);
+                }
+                handlingMonitor = nullptr;
+            });
+        }
+        if (!isMonitoring) {
+            // Without notifications every getPorts call has to scan.
+            isTableCurrent.store(false);
+        }
+        return isMonitoring;
+    }
+
+    void HSerialPortsManager::scan(HSerialDeviceMonitor* source, std::chrono::steady_clock::duration maxAge) {
+        std::unique_lock<std::mutex> scanLock(scanMutex);
+        std::chrono::steady_clock::time_point scanTime = std::chrono::steady_clock::now();
+        if (maxAge > std::chrono::steady_clock::duration::zero() && hasScanned && scanTime - lastScanTime < maxAge) {
+            // Checked after locking scanMutex so that callers waiting on a scan use its result.
+            return;
+        }
+        std::vector<serial::PortInfo> portInfoList = source ? source->listPorts() : serial::list_ports();
+
+        std::unique_lock<std::mutex> lock(tableMutex);
+        {
+
+            std::vector<HSerialPort> ports;
+            std::unordered_set<HSerialDevice*> found;
+            for (const serial::PortInfo& portInfo : portInfoList) {
+                if (portInfo.port.empty()) continue; // not expected
+                std::shared_ptr<HSerialDevice> device = getDeviceInternal(portInfo.port, portInfo.description, portInfo.hardware_id);
+                if (!found.insert(device.get()).second) continue;
+                // The details may have changed since the device object was created (e.g. a
+                //  different adapter was plugged in and given the same name).
+                device->setDescriptionAndHardwareID(portInfo.description, portInfo.hardware_id);
+                ports.push_back(HSerialPort(device));
+            }
+
+            // Only the differences from the previous table are reported.
+            std::unordered_set<HSerialDevice*> previous;
+            for (const HSerialPort& port : presentPorts) {
+                previous.insert(port.device.get());
+                if (found.count(port.device.get()) == 0) {
+                    pendingChanges.emplace_back(PortChange::removed, port);
+                }
+            }
+            for (const HSerialPort& port : ports) {
+                if (previous.count(port.device.get()) == 0) {
+                    pendingChanges.emplace_back(PortChange::added, port);
+                }
+            }
+
+            presentPorts.swap(ports);
+            isTableCurrent.store(true);
+            hasScanned = true;
+            lastScanTime = scanTime;
+        }
+        scanLock.unlock();
+
+        // The changes are delivered by one thread at a time, in the order they were found. If
+        //  another thread (or a handler further up this thread's stack) is already delivering,
+        //  it will deliver these too. This way a handler that causes a scan can't deadlock.
+        if (isNotifying) {
+            return;
+        }
+        isNotifying = true;
+        while (!pendingChanges.empty()) {
+            std::pair<PortChange, HSerialPort> change = pendingChanges.front();
+            pendingChanges.pop_front();
+            lock.unlock();
+            try {
+                notifySubscribers(change.first, change.second);
+            } catch (...) {
+                lock.lock();
+                isNotifying = false;
+                throw;
             }
+            lock.lock();
         }
+        isNotifying = false;
     }
 
-    std::shared_ptr<HSerialDevice> HSerialPortsManager::getDeviceInternal(const std::string& deviceName) {
-        // Assumes devicesMutex is locked.
-        if (deviceName.empty()) throw std::invalid_argument("Device name must not be empty.");
-        try {
-            return devices.at(deviceName);
-        } catch (const std::out_of_range& e) {
-            std::shared_ptr<HSerialDevice> d = HSerialDevice::createShared(deviceName, "", "");
-            devices.insert({deviceName, d});
-            return d;
+    void HSerialPortsManager::notifySubscribers(PortChange change, const HSerialPort& port) {
+        std::lock_guard<std::recursive_mutex> lock(subscribersMutex);
+        // A copy, since a handler may subscribe or unsubscribe.
+        std::vector<std::pair<SubscriptionID, PortChangeHandler>> current = subscriptions;
+        for (const auto& entry : current) {
+            bool isSubscribed = std::any_of(subscriptions.begin(), subscriptions.end(),
+                                            [&entry](const std::pair<SubscriptionID, PortChangeHandler>& other) {
+                                                return other.first == entry.first;
+                                            });
+            if (isSubscribed) {
+                entry.second(change, port);
+            }
         }
     }
 
-    std::shared_ptr<HSerialDevice> HSerialPortsManager::getDeviceInternal(const serial::PortInfo& portInfo) {
-        // Assumes devicesMutex is locked.
-        try {
-            return devices.at(portInfo.port);
-        } catch (const std::out_of_range& e) {
-            std::shared_ptr<HSerialDevice> d = HSerialDevice::createShared(portInfo.port, portInfo.description, portInfo.hardware_id);
-            devices.insert({portInfo.port, d});
-            return d;
+    std::shared_ptr<HSerialDevice> HSerialPortsManager::getDeviceInternal(const std::string& deviceName, const std::string& description, const std::string& hardwareID) {
+        if (deviceName.empty()) throw std::invalid_argument("Device name must not be empty.");
+        DeviceShard& shard = deviceShards[std::hash<std::string>()(deviceName) % numDeviceShards];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.devices.find(deviceName);
+        if (it != shard.devices.end()) {
+            return it->second;
         }
+        std::shared_ptr<HSerialDevice> d = HSerialDevice::createShared(deviceName, description, hardwareID);
+        shard.devices.emplace(deviceName, d);
+        return d;
     }
 
 }
\ No newline at end of file
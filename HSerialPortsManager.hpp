@@ -10,12 +10,19 @@
 #define HSerialPortsManager_hpp
 
 #include <unordered_map>
+#include <deque>
 #include <vector>
 #include <mutex>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
 
 #include <serial/serial.h>
 
 #include "HSerialPort.hpp"
+#include "HSerialDeviceMonitor.hpp"
+#include "HSerialTransport.hpp"
 
 
 namespace hserial {
@@ -28,8 +35,12 @@ namespace hserial {
 
      To obtain the manager call HSerialPortsManager::getInstance().
 
-     Currently HSerialPortsManager is just a fancy wrapper for `serial::list_ports`,
-     but there are plans to develop it further.
+     The manager keeps a table of the ports present on the system. The table is updated when a
+     device monitor (see HSerialDeviceMonitor) reports that devices may have changed, so
+     getPorts() is usually just a copy of the table. On platforms without a monitor, or if one
+     can't be started, getPorts() lists the ports on every call, as before.
+
+     Code that wants to know when ports come and go can subscribe to the changes.
      */
     class HSerialPortsManager {
 
@@ -45,10 +56,97 @@ namespace hserial {
 
         /*!
          \brief Returns a list of serial ports currently found on the system.
+
+         Starts the device monitor if it hasn't been started. While the monitor is running this
+         returns a copy of the manager's table and doesn't scan the system.
+
          \returns A list of serial ports currently found on the system.
          */
         std::vector<HSerialPort> getPorts();
 
+        /*!
+         \brief Describes a change reported to subscribers.
+         */
+        enum class PortChange {
+            added,
+            removed
+        };
+
+        /*!
+         \brief The subscriber type. Called once for each port added to or removed from the
+         table.
+         */
+        typedef std::function<void(PortChange change, const HSerialPort& port)> PortChangeHandler;
+
+        /*!
+         \brief Identifies a subscription.
+         */
+        typedef uint64_t SubscriptionID;
+
+        /*!
+         \brief Subscribes to port changes.
+
+         Starts the device monitor if it hasn't been started. Ports present when subscribing are
+         not reported (use getPorts).
+
+         Handlers are called from the monitor's thread (or from a thread calling getPorts if there
+         is no monitor), never concurrently, and in the order the changes were found. Handlers
+         may call the manager, including unsubscribe.
+
+         An exception thrown by a handler during a scan caused by a getPorts call propagates to
+         that call. During a scan started by the monitor there is no caller to receive it, so it
+         is swallowed (as are errors listing the ports); the undelivered changes are delivered
+         after the next scan.
+
+         \returns An id to pass to unsubscribe.
+         */
+        SubscriptionID subscribe(PortChangeHandler handler);
+
+        /*!
+         \brief Cancels a subscription.
+
+         When this function returns the handler is not running on another thread and will not be
+         called again. Does nothing if the subscription doesn't exist.
+         */
+        void unsubscribe(SubscriptionID subscription);
+
+        /*!
+         \brief Replaces the device monitor.
+
+         The current monitor (the default one, unless this has been called before) is stopped
+         and destroyed. The new monitor is started the next time it is needed. Passing `nullptr`
+         turns monitoring off, so that getPorts lists the ports on every call.
+
+         This is intended for tests, which can install a fake monitor, and for applications that
+         have their own source of device notifications.
+
+         May be called by a subscriber. In that case the current monitor's thread is the one
+         calling, so the monitor is stopped and destroyed on another thread after the subscriber
+         returns.
+         */
+        void setDeviceMonitor(std::unique_ptr<HSerialDeviceMonitor> monitor);
+
+        /*!
+         \brief Sets how long the results of a scan are used to answer HSerialPort::getDescription
+         and HSerialPort::getHardwareID.
+
+         Those functions ask the manager to refresh the details of a port that doesn't have them.
+         A refresh lists all the ports once and updates every known port, so the details of the
+         other ports are refreshed at the same time. If the last scan is younger than this window
+         the refresh does nothing, so ports that have no details (such as ptys, or devices that
+         have been removed) don't cause a scan on every call. While the device monitor is running
+         the table is always current, and refreshes never scan.
+
+         The default is one second. Zero makes every refresh scan.
+         */
+        void setDetailsStalenessWindow(std::chrono::milliseconds window);
+
+        /*!
+         \brief Returns the details staleness window.
+         \see setDetailsStalenessWindow
+         */
+        std::chrono::milliseconds getDetailsStalenessWindow();
+
         /*!
          \brief Returns a serial port for the given device name. 
          
@@ -62,6 +160,25 @@ namespace hserial {
          */
         HSerialPort portForDeviceName(const std::string& deviceName);
 
+        /*!
+         \brief Sets the transport for a device name.
+
+         Controllers for the port will use a transport created by `factory` instead of
+         `serial::Serial` (see HSerialTransport). The device name doesn't have to exist on the
+         system, so this can be used to create virtual ports, e.g. with
+         HSerialLoopbackTransport::factory(). Passing `nullptr` restores the default transport.
+
+         The factory is called when the port's access object is created, which happens when the
+         first controller for the port is created (and again if all the controllers have been
+         destroyed). It may be called on any thread.
+
+         \returns The port for the device name.
+
+         \throws std::invalid_argument if `deviceName` is empty.
+         \throws std::logic_error if controllers for the port exist.
+         */
+        HSerialPort registerTransport(const std::string& deviceName, HSerialTransportFactory factory);
+
         HSerialPortsManager(const HSerialPortsManager&) = delete;
         HSerialPortsManager& operator=(const HSerialPortsManager&) = delete;
         HSerialPortsManager(HSerialPortsManager&&) = delete;
@@ -77,32 +194,150 @@ namespace hserial {
         std::shared_ptr<HSerialDevice> getDevice(const std::string& deviceName);
 
         /*!
-         \brief Updates the device's information, if possible.
+         \brief Updates the devices' information, if possible.
          
          Specifically, this method updates `description` and `hardwareID`. If it is not possible
          to update those properties this method does nothing.
+
+         All devices are updated by the same scan, so this method takes no device. The scan is
+         skipped if the table is current or younger than detailsStalenessWindow.
          */
-        void refreshDeviceDetails(HSerialDevice& device);
+        void refreshDeviceDetails();
 
         HSerialPortsManager() {}
-        ~HSerialPortsManager() {}
+        ~HSerialPortsManager();
+
+        /*!
+         \brief Returns the device for the name, creating it if necessary. `description` and
+         `hardwareID` are only used when creating it.
+         */
+        std::shared_ptr<HSerialDevice> getDeviceInternal(const std::string& deviceName, const std::string& description = "", const std::string& hardwareID = "");
+
+        /*!
+         \brief One part of the device registry.
+
+         The registry is split by a hash of the device name, so that looking up different
+         devices (e.g. constructing HSerial instances for many ports on many threads) doesn't
+         contend on one lock. Each shard is aligned to a cache line so that neighbouring shards
+         don't share one.
+         */
+        struct alignas(64) DeviceShard {
 
-        std::shared_ptr<HSerialDevice> getDeviceInternal(const std::string& deviceName);
-        std::shared_ptr<HSerialDevice> getDeviceInternal(const serial::PortInfo& portInfo);
+            std::mutex mutex;
+
+            /*!
+             \brief A dictionary of devices indexed by their names.
+
+             The manager instance shares ownership of a device with any HSerialPort
+             instances.
+             */
+            std::unordered_map<std::string, std::shared_ptr<HSerialDevice>> devices;
+        };
+
+        static const size_t numDeviceShards = 64;
+
+        DeviceShard deviceShards[numDeviceShards];
 
         /*!
-         \brief Used to protect the devices dictionary, as well as to serialize calls
-         to `serial::list_ports`.
+         \brief Used to protect the port table and the related state below.
+
+         Device lookups don't use this mutex (see DeviceShard). A shard may be locked while this
+         mutex is held, but not the other way around.
          */
-        std::mutex devicesMutex;
+        std::mutex tableMutex;
 
         /*!
-         \brief A dictionary of devices indexed by their names.
-         
-         The manager instance shares ownership of a device with any HSerialPort
-         instances.
+         \brief The ports found by the last scan, in the order `serial::list_ports` returned them.
+         Protected by tableMutex.
+         */
+        std::vector<HSerialPort> presentPorts;
+
+        /*!
+         \brief Indicates if presentPorts reflects the monitor's latest notification.
+
+         Cleared when a monitor is started (so the first getPorts scans) and set by scans.
+         */
+        std::atomic_bool isTableCurrent {false};
+
+        /*!
+         \brief Protects monitor and the monitor state flags.
+
+         Never held while scanning or calling subscribers, so a subscriber may call the manager.
          */
-        std::unordered_map<std::string, std::shared_ptr<HSerialDevice>> devices;
+        std::mutex monitorMutex;
+
+        /*!
+         \brief The device monitor. Shared so that a scan can keep using it if it is replaced.
+         */
+        std::shared_ptr<HSerialDeviceMonitor> monitor;
+
+        /*!
+         \brief Indicates if the default monitor has been created (or replaced).
+         */
+        bool hasMonitorBeenConfigured = false;
+
+        /*!
+         \brief Indicates if monitor is running.
+         */
+        bool isMonitoring = false;
+
+        /*!
+         \brief Serializes scans, so that the table is always updated from the latest listing.
+         */
+        std::mutex scanMutex;
+
+        /*!
+         \brief Changes found by scans and not yet delivered to subscribers. Protected by
+         tableMutex.
+         */
+        std::deque<std::pair<PortChange, HSerialPort>> pendingChanges;
+
+        /*!
+         \brief See setDetailsStalenessWindow. Protected by tableMutex.
+         */
+        std::chrono::milliseconds detailsStalenessWindow {1000};
+
+        /*!
+         \brief When the last completed scan started. Valid if hasScanned is set. Protected by
+         scanMutex (written under tableMutex too).
+         */
+        std::chrono::steady_clock::time_point lastScanTime;
+
+        bool hasScanned = false;
+
+        /*!
+         \brief Indicates if a thread is delivering pendingChanges. Protected by tableMutex.
+         */
+        bool isNotifying = false;
+
+        /*!
+         \brief Serializes calls to subscribers and protects subscriptions.
+
+         Recursive so that a subscriber may subscribe or unsubscribe.
+         */
+        std::recursive_mutex subscribersMutex;
+
+        std::vector<std::pair<SubscriptionID, PortChangeHandler>> subscriptions;
+
+        SubscriptionID nextSubscriptionID = 1;
+
+        /*!
+         \brief Creates the default monitor if necessary and starts the monitor if it isn't
+         running. Assumes monitorMutex is locked.
+         \returns `true` if the monitor is running.
+         */
+        bool startMonitoring();
+
+        /*!
+         \brief Lists the ports, updates the table, and notifies subscribers of the differences.
+
+         `source` lists the ports, or `serial::list_ports` is used if it is `nullptr`. If `maxAge`
+         is positive the scan is skipped when the last scan started less than `maxAge` ago.
+         Assumes monitorMutex is not locked.
+         */
+        void scan(HSerialDeviceMonitor* source, std::chrono::steady_clock::duration maxAge = std::chrono::steady_clock::duration::zero());
+
+        void notifySubscribers(PortChange change, const HSerialPort& port);
 
     };
 }
@@ -0,0 +1,387 @@
+//
+//  HSerialPtyTransport.cpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+
+#include "HSerialPtyTransport.hpp"
+
+#if !defined(_WIN32)
+
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <thread>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <termios.h>
+#include <unistd.h>
+
+
+namespace hserial {
+
+    namespace {
+
+        void setNonBlocking(int fd) {
+            int flags = fcntl(fd, F_GETFL);
+            if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+                throw serial::IOException(__FILE__, __LINE__, errno);
+            }
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+    }
+
+    HSerialPtyTransport::HSerialPtyTransport(const std::string& _linkPath) {
+        try {
+            masterFD = posix_openpt(O_RDWR | O_NOCTTY);
+            if (masterFD < 0 || grantpt(masterFD) != 0 || unlockpt(masterFD) != 0) {
+                throw serial::IOException(__FILE__, __LINE__, errno);
+            }
+            setNonBlocking(masterFD);
+
+#if defined(__linux__)
+            char name[PATH_MAX];
+            if (ptsname_r(masterFD, name, sizeof(name)) != 0) {
+                throw serial::IOException(__FILE__, __LINE__, errno);
+            }
+            slaveName = name;
+#else
+            const char* name = ptsname(masterFD);
+            if (name == NULL) {
+                throw serial::IOException(__FILE__, __LINE__, errno);
+            }
+            slaveName = name;
+#endif
+
+            slaveFD = ::open(slaveName.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+            if (slaveFD < 0) {
+                throw serial::IOException(__FILE__, __LINE__, errno);
+            }
+            struct termios options;
+            if (tcgetattr(slaveFD, &options) == 0) {
+                cfmakeraw(&options);
+                tcsetattr(slaveFD, TCSANOW, &options);
+            }
+
+            int wakeFDs[2];
+            if (pipe(wakeFDs) != 0) {
+                throw serial::IOException(__FILE__, __LINE__, errno);
+            }
+            wakeReadFD = wakeFDs[0];
+            wakeWriteFD = wakeFDs[1];
+            setNonBlocking(wakeReadFD);
+            setNonBlocking(wakeWriteFD);
+
+            if (!_linkPath.empty()) {
+                // Replace a link left behind by an earlier run, but nothing else.
+                struct stat info;
+                if (lstat(_linkPath.c_str(), &info) == 0 && S_ISLNK(info.st_mode)) {
+                    unlink(_linkPath.c_str());
+                }
+                if (symlink(slaveName.c_str(), _linkPath.c_str()) != 0) {
+                    throw serial::IOException(__FILE__, __LINE__, errno);
+                }
+                linkPath = _linkPath;
+            }
+        } catch (...) {
+            closeDescriptors();
+            throw;
+        }
+    }
+
+    HSerialPtyTransport::~HSerialPtyTransport() {
+        if (!linkPath.empty()) {
+            unlink(linkPath.c_str());
+        }
+        closeDescriptors();
+    }
+
+    HSerialTransportFactory HSerialPtyTransport::factory(const std::string& linkPath) {
+        return [linkPath](const std::string&) {
+            return std::unique_ptr<HSerialTransport>(new HSerialPtyTransport(linkPath));
+        };
+    }
+
+    std::string HSerialPtyTransport::getSlaveName() const {
+        return slaveName;
+    }
+
+    void HSerialPtyTransport::closeDescriptors() {
+        if (masterFD >= 0) ::close(masterFD);
+        if (slaveFD >= 0) ::close(slaveFD);
+        if (wakeReadFD >= 0) ::close(wakeReadFD);
+        if (wakeWriteFD >= 0) ::close(wakeWriteFD);
+        masterFD = -1;
+        slaveFD = -1;
+        wakeReadFD = -1;
+        wakeWriteFD = -1;
+    }
+
+    bool HSerialPtyTransport::waitFor(short events, std::chrono::steady_clock::time_point deadline) {
+        struct pollfd fds[2];
+        fds[0].fd = masterFD;
+        fds[0].events = events;
+        fds[1].fd = wakeReadFD;
+        fds[1].events = POLLIN;
+        while (true) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            if (remaining.count() < 0) {
+                return false;
+            }
+            // Rounded up, so that a wait doesn't end just before the deadline.
+            int ms = int(std::min<int64_t>(remaining.count() + 1, INT_MAX));
+            int result = poll(fds, 2, ms);
+            if (result < 0) {
+                if (errno == EINTR) continue;
+                throw serial::IOException(__FILE__, __LINE__, errno);
+            }
+            if (fds[1].revents != 0 || !isOpenFlag.load()) {
+                return false;
+            }
+            if (fds[0].revents != 0) {
+                return true;
+            }
+        }
+    }
+
+    void HSerialPtyTransport::drainMaster() {
+        uint8_t discard[256];
+        while (::read(masterFD, discard, sizeof(discard)) > 0) {}
+    }
+
+
+#pragma mark - Opening and Closing
+
+    void HSerialPtyTransport::open() {
+        if (isOpenFlag.load()) throw serial::SerialException("Serial port already open.");
+        // Clear the wake from the last close, and drop what the other side sent while the port
+        //  was closed (as a real port would).
+        uint8_t discard[16];
+        while (::read(wakeReadFD, discard, sizeof(discard)) > 0) {}
+        drainMaster();
+        isOpenFlag.store(true);
+    }
+
+    bool HSerialPtyTransport::isOpen() const {
+        return isOpenFlag.load();
+    }
+
+    void HSerialPtyTransport::close() {
+        {
+            std::lock_guard<std::mutex> lock(closeMutex);
+            if (!isOpenFlag.exchange(false)) return;
+        }
+        uint8_t wake = 0;
+        ssize_t result = ::write(wakeWriteFD, &wake, 1);
+        (void)result;
+        closeCondition.notify_all();
+    }
+
+
+#pragma mark - Reading, Writing, and Waiting
+
+    size_t HSerialPtyTransport::available() {
+        if (!isOpenFlag.load()) return 0;
+        int count = 0;
+        if (ioctl(masterFD, FIONREAD, &count) != 0) {
+            throw serial::IOException(__FILE__, __LINE__, errno);
+        }
+        return size_t(count);
+    }
+
+    bool HSerialPtyTransport::waitReadable() {
+        serial::Timeout t = getTimeout();
+        return waitFor(POLLIN, std::chrono::steady_clock::now() + std::chrono::milliseconds(t.read_timeout_constant));
+    }
+
+    void HSerialPtyTransport::waitByteTimes(size_t count) {
+        std::chrono::nanoseconds byteTime;
+        {
+            std::lock_guard<std::mutex> lock(settingsMutex);
+            byteTime = characterTime(baudrate, bytesize, parity, stopbits);
+        }
+        std::this_thread::sleep_for(byteTime * count);
+    }
+
+    size_t HSerialPtyTransport::read(uint8_t* buffer, size_t size) {
+        if (!isOpenFlag.load()) throw serial::PortNotOpenedException("HSerialPtyTransport::read");
+        serial::Timeout t = getTimeout();
+        auto deadline = readDeadline(t, size);
+        size_t count = 0;
+        while (count < size) {
+            ssize_t result = ::read(masterFD, buffer + count, size - count);
+            if (result > 0) {
+                count += size_t(result);
+                continue;
+            }
+            // EIO means the slave has no other opener, which is the same as no data here.
+            if (result < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR && errno != EIO) {
+                throw serial::IOException(__FILE__, __LINE__, errno);
+            }
+            auto waitDeadline = deadline;
+            if (count > 0 && t.inter_byte_timeout != serial::Timeout::max()) {
+                waitDeadline = std::min(deadline, std::chrono::steady_clock::now() + std::chrono::milliseconds(t.inter_byte_timeout));
+            }
+            if (!waitFor(POLLIN, waitDeadline)) {
+                break;
+            }
+        }
+        return count;
+    }
+
+    size_t HSerialPtyTransport::write(const uint8_t* data, size_t size) {
+        if (!isOpenFlag.load()) throw serial::PortNotOpenedException("HSerialPtyTransport::write");
+        auto deadline = writeDeadline(getTimeout(), size);
+        size_t count = 0;
+        while (count < size) {
+            ssize_t result = ::write(masterFD, data + count, size - count);
+            if (result > 0) {
+                count += size_t(result);
+                continue;
+            }
+            if (result < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                throw serial::IOException(__FILE__, __LINE__, errno);
+            }
+            if (!waitFor(POLLOUT, deadline)) {
+                break;
+            }
+        }
+        return count;
+    }
+
+
+#pragma mark - Settings
+
+    void HSerialPtyTransport::setBaudrate(uint32_t _baudrate) {
+        std::lock_guard<std::mutex> lock(settingsMutex);
+        baudrate = _baudrate;
+    }
+
+    uint32_t HSerialPtyTransport::getBaudrate() const {
+        std::lock_guard<std::mutex> lock(settingsMutex);
+        return baudrate;
+    }
+
+    void HSerialPtyTransport::setTimeout(const serial::Timeout& _timeout) {
+        std::lock_guard<std::mutex> lock(settingsMutex);
+        timeout = _timeout;
+    }
+
+    serial::Timeout HSerialPtyTransport::getTimeout() const {
+        std::lock_guard<std::mutex> lock(settingsMutex);
+        return timeout;
+    }
+
+    void HSerialPtyTransport::setBytesize(serial::bytesize_t _bytesize) {
+        std::lock_guard<std::mutex> lock(settingsMutex);
+        bytesize = _bytesize;
+    }
+
+    serial::bytesize_t HSerialPtyTransport::getBytesize() const {
+        std::lock_guard<std::mutex> lock(settingsMutex);
+        return bytesize;
+    }
+
+    void HSerialPtyTransport::setParity(serial::parity_t _parity) {
+        std::lock_guard<std::mutex> lock(settingsMutex);
+        parity = _parity;
+    }
+
+    serial::parity_t HSerialPtyTransport::getParity() const {
+        std::lock_guard<std::mutex> lock(settingsMutex);
+        return parity;
+    }
+
+    void HSerialPtyTransport::setStopbits(serial::stopbits_t _stopbits) {
+        std::lock_guard<std::mutex> lock(settingsMutex);
+        stopbits = _stopbits;
+    }
+
+    serial::stopbits_t HSerialPtyTransport::getStopbits() const {
+        std::lock_guard<std::mutex> lock(settingsMutex);
+        return stopbits;
+    }
+
+    void HSerialPtyTransport::setFlowcontrol(serial::flowcontrol_t _flowcontrol) {
+        std::lock_guard<std::mutex> lock(settingsMutex);
+        flowcontrol = _flowcontrol;
+    }
+
+    serial::flowcontrol_t HSerialPtyTransport::getFlowcontrol() const {
+        std::lock_guard<std::mutex> lock(settingsMutex);
+        return flowcontrol;
+    }
+
+
+#pragma mark - Buffers and Lines
+
+    void HSerialPtyTransport::flush() {
+        // Written bytes are in the slave's input queue as soon as write returns.
+    }
+
+    void HSerialPtyTransport::flushInput() {
+        drainMaster();
+    }
+
+    void HSerialPtyTransport::flushOutput() {
+        // Discards what the other side hasn't read yet.
+        tcflush(slaveFD, TCIFLUSH);
+    }
+
+    void HSerialPtyTransport::sendBreak(int duration) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(duration));
+    }
+
+    void HSerialPtyTransport::setBreak(bool level) {
+        // A pseudoterminal has no break condition to hold.
+        (void)level;
+    }
+
+    void HSerialPtyTransport::setRTS(bool level) {
+        // A pseudoterminal has no modem lines.
+        (void)level;
+    }
+
+    void HSerialPtyTransport::setDTR(bool level) {
+        // A pseudoterminal has no modem lines.
+        (void)level;
+    }
+
+    bool HSerialPtyTransport::waitForChange() {
+        // The lines never change, so the only thing to wait for is close().
+        std::unique_lock<std::mutex> lock(closeMutex);
+        closeCondition.wait(lock, [this]() {return !isOpenFlag.load();});
+        return false;
+    }
+
+    bool HSerialPtyTransport::getCTS() {
+        return false;
+    }
+
+    bool HSerialPtyTransport::getDSR() {
+        return false;
+    }
+
+    bool HSerialPtyTransport::getRI() {
+        return false;
+    }
+
+    bool HSerialPtyTransport::getCD() {
+        return false;
+    }
+
+
+#pragma mark - Readiness
+
+    int HSerialPtyTransport::getNativeHandle() const {
+        return masterFD;
+    }
+
+}
+
+#endif /* !_WIN32 */
@@ -0,0 +1,171 @@
+//
+//  HSerialPtyTransport.hpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+
+#ifndef HSerialPtyTransport_hpp
+#define HSerialPtyTransport_hpp
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+#include "HSerialTransport.hpp"
+
+#if !defined(_WIN32)
+
+namespace hserial {
+
+    /*!
+     \brief A transport that is the master side of a pseudoterminal.
+
+     Another program (or another part of the same program, using HSerialSerialTransport) talks
+     to the port by opening the slave device, whose name is returned by getSlaveName(). The
+     pseudoterminal is created by the constructor and lasts as long as the transport, so the
+     slave name doesn't change when the port is closed and reopened. The slave is put in raw
+     mode.
+
+     If `linkPath` is given, a symbolic link to the slave is created there (and removed by the
+     destructor), which gives the other side a fixed name to open:
+
+         HSerialPortsManager::getInstance().registerTransport("sim0", HSerialPtyTransport::factory("/tmp/sim0"));
+         HSerial serial("sim0"); // the other side opens /tmp/sim0
+
+     Pseudoterminals deliver bytes immediately, so the settings are stored and reported but
+     don't affect timing. A pseudoterminal has no modem lines: setting them (or the break
+     condition) does nothing and getting them returns `false`. Since the lines never change,
+     waitForChange blocks until the transport is closed and then always returns `false`.
+
+     getNativeHandle returns the master side, which is created with the transport and stays
+     valid until it is destroyed.
+
+     Available on POSIX systems.
+
+     \throws serial::IOException from the constructor if the pseudoterminal can't be created.
+     */
+    class HSerialPtyTransport : public HSerialTransport {
+
+    public:
+
+        explicit HSerialPtyTransport(const std::string& linkPath = "");
+        ~HSerialPtyTransport();
+
+        HSerialPtyTransport(const HSerialPtyTransport&) = delete;
+        HSerialPtyTransport& operator=(const HSerialPtyTransport&) = delete;
+
+        /*!
+         \brief Returns a factory that creates pty transports. If `linkPath` is not empty each
+         transport links its slave there.
+         */
+        static HSerialTransportFactory factory(const std::string& linkPath = "");
+
+        /*!
+         \brief Returns the device name of the slave side (e.g. `/dev/pts/3`).
+         */
+        std::string getSlaveName() const;
+
+        void open() override;
+        bool isOpen() const override;
+        void close() override;
+
+        size_t available() override;
+        bool waitReadable() override;
+        void waitByteTimes(size_t count) override;
+        size_t read(uint8_t* buffer, size_t size) override;
+        size_t write(const uint8_t* data, size_t size) override;
+
+        using HSerialTransport::read;
+        using HSerialTransport::write;
+
+        void setBaudrate(uint32_t baudrate) override;
+        uint32_t getBaudrate() const override;
+        void setTimeout(const serial::Timeout& timeout) override;
+        serial::Timeout getTimeout() const override;
+        void setBytesize(serial::bytesize_t bytesize) override;
+        serial::bytesize_t getBytesize() const override;
+        void setParity(serial::parity_t parity) override;
+        serial::parity_t getParity() const override;
+        void setStopbits(serial::stopbits_t stopbits) override;
+        serial::stopbits_t getStopbits() const override;
+        void setFlowcontrol(serial::flowcontrol_t flowcontrol) override;
+        serial::flowcontrol_t getFlowcontrol() const override;
+
+        void flush() override;
+        void flushInput() override;
+        void flushOutput() override;
+        void sendBreak(int duration) override;
+        void setBreak(bool level) override;
+        void setRTS(bool level) override;
+        void setDTR(bool level) override;
+        bool waitForChange() override;
+        bool getCTS() override;
+        bool getDSR() override;
+        bool getRI() override;
+        bool getCD() override;
+
+        int getNativeHandle() const override;
+
+    private:
+
+        /*!
+         \brief The master side, non-blocking.
+         */
+        int masterFD = -1;
+
+        /*!
+         \brief A descriptor for the slave side, held so that the master doesn't see a hangup
+         while the other side has the slave closed. Never read or written.
+         */
+        int slaveFD = -1;
+
+        /*!
+         \brief A pipe that close() writes to, to wake waits on masterFD.
+         */
+        int wakeReadFD = -1;
+        int wakeWriteFD = -1;
+
+        std::string slaveName;
+        std::string linkPath;
+
+        std::atomic_bool isOpenFlag {false};
+
+        /*!
+         \brief Protects the settings.
+         */
+        mutable std::mutex settingsMutex;
+
+        uint32_t baudrate = 9600;
+        serial::Timeout timeout;
+        serial::bytesize_t bytesize = serial::eightbits;
+        serial::parity_t parity = serial::parity_none;
+        serial::stopbits_t stopbits = serial::stopbits_one;
+        serial::flowcontrol_t flowcontrol = serial::flowcontrol_none;
+
+        /*!
+         \brief Used by waitForChange to wait for close().
+         */
+        std::mutex closeMutex;
+        std::condition_variable closeCondition;
+
+        /*!
+         \brief Waits until masterFD has the `events` or the deadline passes.
+         \returns `false` on timeout or if the transport was closed.
+         */
+        bool waitFor(short events, std::chrono::steady_clock::time_point deadline);
+
+        /*!
+         \brief Discards the bytes waiting to be read from masterFD.
+         */
+        void drainMaster();
+
+        void closeDescriptors();
+    };
+
+}
+
+#endif /* !_WIN32 */
+
+#endif /* HSerialPtyTransport_hpp */
@@ -0,0 +1,851 @@
+//
+//  HSerialReactor.cpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+
+#include "HSerialReactor.hpp"
+
+#if defined(__linux__)
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <deque>
+#include <stdexcept>
+#include <system_error>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "HSerialController.hpp"
+#include "HSerialAccess.hpp"
+#include "HSerialExceptions.hpp"
+
+
+namespace hserial {
+
+    namespace {
+
+        // The epoll data values used for stopFD, postFD and lineTimerFD. Port ids start at 3.
+        const uint64_t stopID = 0;
+        const uint64_t postID = 1;
+        const uint64_t lineTimerID = 2;
+
+        // Set in the epoll data of a port's native handle, to tell it from the port's eventfd.
+        const uint64_t handleFlag = uint64_t(1) << 63;
+
+        const int maxEventsPerWait = 64;
+
+        // A port event (alongside HSerialAccess's flags) asking the dispatch to look at the
+        //  modem status lines.
+        const uint32_t lineCheckEvent = 0x8;
+
+        void throwSystemError(const char* what) {
+            throw std::system_error(errno, std::generic_category(), what);
+        }
+
+        std::exception_ptr makeCanceledError() {
+            return std::make_exception_ptr(std::system_error(std::make_error_code(std::errc::operation_canceled), "The reactor registration was removed"));
+        }
+
+        std::exception_ptr makeNotActiveError() {
+            return std::make_exception_ptr(NotActiveController("The controller is not active, so its pending asynchronous operation was failed."));
+        }
+    }
+
+
+#pragma mark - Internal Types
+
+    // A pending asyncRead, asyncReadline, asyncWrite or asyncWaitForChange.
+    struct HSerialReactor::Operation {
+        virtual ~Operation() {}
+
+        // Tries to complete the operation without blocking. Returns false if the operation must
+        //  wait for another event. The callback is called (and may throw) if it returns true.
+        virtual bool tryComplete(HSerialAccess& access, HSerialController& controller) = 0;
+
+        virtual void fail(std::exception_ptr error) = 0;
+    };
+
+    struct HSerialReactor::ReadOperation : HSerialReactor::Operation {
+        uint8_t* buffer;
+        size_t size;
+        CountCallback callback;
+
+        ReadOperation(uint8_t* _buffer, size_t _size, CountCallback _callback) : buffer(_buffer), size(_size), callback(std::move(_callback)) {}
+
+        bool tryComplete(HSerialAccess& access, HSerialController& controller) override {
+            size_t count;
+            try {
+                count = access.tryRead(controller, buffer, size);
+            } catch (...) {
+                fail(std::current_exception());
+                return true;
+            }
+            if (count == 0 && size > 0) {
+                return false;
+            }
+            callback(nullptr, count);
+            return true;
+        }
+
+        void fail(std::exception_ptr error) override {
+            callback(error, 0);
+        }
+    };
+
+    struct HSerialReactor::ReadlineOperation : HSerialReactor::Operation {
+        size_t size;
+        std::string eol;
+        LineCallback callback;
+
+        ReadlineOperation(size_t _size, const std::string& _eol, LineCallback _callback) : size(_size), eol(_eol), callback(std::move(_callback)) {}
+
+        bool tryComplete(HSerialAccess& access, HSerialController& controller) override {
+            std::string line;
+            try {
+                if (!access.tryReadline(controller, line, size, eol)) {
+                    return false;
+                }
+            } catch (...) {
+                fail(std::current_exception());
+                return true;
+            }
+            callback(nullptr, std::move(line));
+            return true;
+        }
+
+        void fail(std::exception_ptr error) override {
+            callback(error, std::string());
+        }
+    };
+
+    struct HSerialReactor::WriteOperation : HSerialReactor::Operation {
+        size_t size;
+        uint64_t ticket = 0;
+        std::exception_ptr error; // from enqueueWrite
+        CountCallback callback;
+
+        WriteOperation(size_t _size, CountCallback _callback) : size(_size), callback(std::move(_callback)) {}
+
+        bool tryComplete(HSerialAccess& access, HSerialController& controller) override {
+            if (error) {
+                fail(error);
+                return true;
+            }
+            try {
+                if (!access.waitForQueuedWrites(controller, ticket, std::chrono::milliseconds(0))) {
+                    return false;
+                }
+            } catch (...) {
+                fail(std::current_exception());
+                return true;
+            }
+            callback(nullptr, size);
+            return true;
+        }
+
+        void fail(std::exception_ptr _error) override {
+            callback(_error, 0);
+        }
+    };
+
+    // Nothing waits on the port: the lines are compared with their levels at the start each
+    //  time the line timer fires.
+    struct HSerialReactor::ChangeOperation : HSerialReactor::Operation {
+        uint8_t lines = 0; // from readLines, when the operation was started
+        std::exception_ptr error; // from reading the lines at the start
+        ChangeCallback callback;
+
+        explicit ChangeOperation(ChangeCallback _callback) : callback(std::move(_callback)) {}
+
+        // Returns the levels of CTS, DSR, RI and CD as bits.
+        static uint8_t readLines(HSerialAccess& access, const HSerialController& controller) {
+            return uint8_t((access.getCTS(controller) ? 0x1 : 0)
+                           | (access.getDSR(controller) ? 0x2 : 0)
+                           | (access.getRI(controller) ? 0x4 : 0)
+                           | (access.getCD(controller) ? 0x8 : 0));
+        }
+
+        bool tryComplete(HSerialAccess& access, HSerialController& controller) override {
+            if (error) {
+                fail(error);
+                return true;
+            }
+            bool isOpen;
+            uint8_t current = lines;
+            try {
+                isOpen = access.isTransportOpen();
+                if (isOpen) {
+                    current = readLines(access, controller);
+                }
+            } catch (...) {
+                fail(std::current_exception());
+                return true;
+            }
+            if (isOpen && current == lines) {
+                return false;
+            }
+            // Closing the port ends the wait, as it does for waitForChange.
+            callback(nullptr, isOpen);
+            return true;
+        }
+
+        void fail(std::exception_ptr _error) override {
+            callback(_error, false);
+        }
+    };
+
+    struct HSerialReactor::Registration {
+        HSerialController* controller = nullptr;
+        Handler handler;
+        bool isRemoved = false;
+
+        // Reads and line reads, in the order they were started.
+        std::deque<std::unique_ptr<Operation>> inputs;
+
+        // Writes, in the order they were started.
+        std::deque<std::unique_ptr<Operation>> outputs;
+
+        // Waits for line changes. These complete in any order.
+        std::deque<std::unique_ptr<Operation>> changes;
+    };
+
+    struct HSerialReactor::Port {
+        std::shared_ptr<HSerialAccess> access;
+        int eventFD = -1;
+        int nativeHandle = -1; // the transport's, if it was added to the epoll instance
+        uint64_t observerID = 0;
+        uint64_t id = 0;
+        std::atomic<uint32_t> pendingEvents {0};
+        std::vector<std::shared_ptr<Registration>> registrations;
+        bool isDispatching = false;
+        std::thread::id dispatchingThread;
+    };
+
+
+#pragma mark - Constructor/Destructor
+
+    HSerialReactor::HSerialReactor() {
+        static_assert(readable == HSerialAccess::readableEvent && writable == HSerialAccess::writableEvent,
+                      "The reactor passes HSerialAccess's event flags through unchanged.");
+        epollFD = epoll_create1(EPOLL_CLOEXEC);
+        if (epollFD < 0) {
+            throwSystemError("epoll_create1");
+        }
+        stopFD = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        postFD = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        lineTimerFD = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (stopFD < 0 || postFD < 0 || lineTimerFD < 0) {
+            int error = errno;
+            const char* what = lineTimerFD < 0 ? "timerfd_create" : "eventfd";
+            if (stopFD >= 0) close(stopFD);
+            if (postFD >= 0) close(postFD);
+            if (lineTimerFD >= 0) close(lineTimerFD);
+            close(epollFD);
+            throw std::system_error(error, std::generic_category(), what);
+        }
+        epoll_event event {};
+        event.events = EPOLLIN;
+        event.data.u64 = stopID;
+        epoll_ctl(epollFD, EPOLL_CTL_ADD, stopFD, &event);
+        event.data.u64 = postID;
+        epoll_ctl(epollFD, EPOLL_CTL_ADD, postFD, &event);
+        event.data.u64 = lineTimerID;
+        epoll_ctl(epollFD, EPOLL_CTL_ADD, lineTimerFD, &event);
+    }
+
+    HSerialReactor::~HSerialReactor() {
+        std::vector<std::shared_ptr<Registration>> registrations;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto& entry : ports) {
+                for (auto& registration : entry.second->registrations) {
+                    registration->isRemoved = true;
+                    registrations.push_back(registration);
+                }
+                entry.second->registrations.clear();
+            }
+        }
+        for (auto& registration : registrations) {
+            try {
+                cancelOperations(*registration);
+            } catch (...) {
+                // A destructor must not throw.
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            while (!ports.empty()) {
+                destroyPort(ports.begin()->second.get());
+            }
+        }
+        close(lineTimerFD);
+        close(postFD);
+        close(stopFD);
+        close(epollFD);
+    }
+
+
+#pragma mark - Registration
+
+    void HSerialReactor::add(HSerialController& controller, Handler handler) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        std::shared_ptr<Registration> registration = std::make_shared<Registration>();
+        registration->controller = &controller;
+        registration->handler = std::move(handler);
+
+        Port* port = findPort(controller.access.get());
+
+        if (port) {
+            for (const auto& existing : port->registrations) {
+                if (existing->controller == &controller) {
+                    throw std::invalid_argument("The controller is already registered with the reactor.");
+                }
+            }
+            port->registrations.push_back(std::move(registration));
+            return;
+        }
+
+        std::unique_ptr<Port> newPort(new Port());
+        newPort->access = controller.access;
+        newPort->id = nextPortID++;
+        newPort->eventFD = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (newPort->eventFD < 0) {
+            throwSystemError("eventfd");
+        }
+        epoll_event event {};
+        event.events = EPOLLIN | EPOLLONESHOT;
+        event.data.u64 = newPort->id;
+        if (epoll_ctl(epollFD, EPOLL_CTL_ADD, newPort->eventFD, &event) != 0) {
+            int error = errno;
+            close(newPort->eventFD);
+            throw std::system_error(error, std::generic_category(), "epoll_ctl");
+        }
+        newPort->registrations.push_back(std::move(registration));
+
+        // The handle is edge triggered, so bytes the handler leaves unread don't wake the
+        //  reactor again. Its events are turned into readable events on the port's eventfd,
+        //  which keeps the port's dispatches serialized. If the handle can't be watched the
+        //  port falls back to events from the read pump.
+        int handle = newPort->access->getNativeHandle();
+        if (handle >= 0) {
+            event.events = EPOLLIN | EPOLLET;
+            event.data.u64 = newPort->id | handleFlag;
+            if (epoll_ctl(epollFD, EPOLL_CTL_ADD, handle, &event) == 0) {
+                newPort->nativeHandle = handle;
+            }
+        }
+
+        port = newPort.get();
+        ports[port->id] = std::move(newPort);
+
+        // The observer runs on the pump and writer threads (and on threads that open the port
+        //  or make transitions). It only touches the atomic flags and the eventfd, so it never
+        //  needs the reactor's mutex. Other reactors may observe the same port.
+        port->observerID = port->access->addEventObserver([port](uint32_t events) {
+            signalPort(port, events);
+        });
+    }
+
+    void HSerialReactor::remove(HSerialController& controller) {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        const HSerialAccess* access = controller.access.get();
+        std::thread::id thisThread = std::this_thread::get_id();
+
+        // Wait for a dispatch on another thread to finish, since it might be running this
+        //  controller's handler. A dispatch on this thread (i.e. remove was called by a handler)
+        //  is fine since the dispatch keeps its own references.
+        Port* port;
+        while (true) {
+            port = findPort(access);
+            if (!port || !port->isDispatching || port->dispatchingThread == thisThread) {
+                break;
+            }
+            dispatchFinishedCondition.wait(lock);
+        }
+        if (!port) {
+            return;
+        }
+
+        std::shared_ptr<Registration> removed;
+        auto& list = port->registrations;
+        for (auto it = list.begin(); it != list.end(); ++it) {
+            if ((*it)->controller == &controller) {
+                removed = *it;
+                removed->isRemoved = true;
+                list.erase(it);
+                break;
+            }
+        }
+
+        if (list.empty() && !port->isDispatching) {
+            destroyPort(port);
+        }
+        // Otherwise the dispatch destroys the port when it finishes.
+
+        lock.unlock();
+
+        if (removed) {
+            cancelOperations(*removed);
+        }
+    }
+
+
+#pragma mark - Asynchronous Operations
+
+    void HSerialReactor::asyncRead(HSerialController& controller, uint8_t* buffer, size_t size, CountCallback callback) {
+        std::unique_ptr<Operation> operation(new ReadOperation(buffer, size, std::move(callback)));
+        std::lock_guard<std::mutex> lock(mutex);
+        Port* port;
+        Registration& registration = getRegistration(controller, port);
+        registration.inputs.push_back(std::move(operation));
+        signalPort(port, readable);
+    }
+
+    void HSerialReactor::asyncReadline(HSerialController& controller, size_t size, const std::string& eol, LineCallback callback) {
+        std::unique_ptr<Operation> operation(new ReadlineOperation(size, eol, std::move(callback)));
+        std::lock_guard<std::mutex> lock(mutex);
+        Port* port;
+        Registration& registration = getRegistration(controller, port);
+        registration.inputs.push_back(std::move(operation));
+        signalPort(port, readable);
+    }
+
+    void HSerialReactor::asyncWrite(HSerialController& controller, const uint8_t* data, size_t size, CountCallback callback) {
+        std::unique_ptr<WriteOperation> operation(new WriteOperation(size, std::move(callback)));
+
+        std::unique_lock<std::mutex> lock(mutex);
+        Port* port;
+        getRegistration(controller, port);
+        std::shared_ptr<HSerialAccess> access = port->access;
+        lock.unlock();
+
+        // enqueueWrite may block if the write queue is full, so the reactor's mutex is not held.
+        //  Its errors are reported through the callback.
+        try {
+            operation->ticket = access->enqueueWrite(controller, data, size);
+        } catch (...) {
+            operation->error = std::current_exception();
+        }
+
+        lock.lock();
+        Registration& registration = getRegistration(controller, port);
+        registration.outputs.push_back(std::move(operation));
+        signalPort(port, writable);
+    }
+
+    void HSerialReactor::asyncWaitForChange(HSerialController& controller, ChangeCallback callback) {
+        std::unique_ptr<ChangeOperation> operation(new ChangeOperation(std::move(callback)));
+
+        std::unique_lock<std::mutex> lock(mutex);
+        Port* port;
+        getRegistration(controller, port);
+        std::shared_ptr<HSerialAccess> access = port->access;
+        lock.unlock();
+
+        // Reading the lines is an access call, so the reactor's mutex is not held. Its errors are
+        //  reported through the callback.
+        try {
+            operation->lines = ChangeOperation::readLines(*access, controller);
+        } catch (...) {
+            operation->error = std::current_exception();
+        }
+
+        lock.lock();
+        Registration& registration = getRegistration(controller, port);
+        registration.changes.push_back(std::move(operation));
+        if (!isLineTimerArmed) {
+            setLineTimer(true);
+        }
+        // Catches a change made since the lines were read (and reports an error promptly).
+        signalPort(port, lineCheckEvent);
+    }
+
+    void HSerialReactor::setLinePollInterval(const std::chrono::milliseconds& interval) {
+        if (interval.count() <= 0) {
+            throw std::invalid_argument("The line poll interval must be positive.");
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        linePollInterval = interval;
+        if (isLineTimerArmed) {
+            setLineTimer(true);
+        }
+    }
+
+    std::chrono::milliseconds HSerialReactor::getLinePollInterval() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return linePollInterval;
+    }
+
+    void HSerialReactor::post(std::function<void()> function) {
+        {
+            std::lock_guard<std::mutex> lock(postMutex);
+            postedFunctions.push_back(std::move(function));
+        }
+        uint64_t one = 1;
+        ssize_t result = write(postFD, &one, sizeof(one));
+        (void)result;
+    }
+
+
+#pragma mark - Dispatching
+
+    size_t HSerialReactor::poll(const std::chrono::milliseconds& timeout) {
+        if (stopped.load()) {
+            return 0;
+        }
+        int timeoutMS = timeout.count() < 0 ? -1 : static_cast<int>(std::min<long long>(timeout.count(), INT_MAX));
+        epoll_event events[maxEventsPerWait];
+        int count = epoll_wait(epollFD, events, maxEventsPerWait, timeoutMS);
+        if (count < 0) {
+            if (errno == EINTR) {
+                return 0;
+            }
+            throwSystemError("epoll_wait");
+        }
+        size_t numCalls = 0;
+        for (int i = 0; i < count; ++i) {
+            uint64_t id = events[i].data.u64;
+            if (id == stopID) {
+                continue;
+            } else if (id == postID) {
+                runPostedFunctions();
+            } else if (id == lineTimerID) {
+                signalLineWaiters();
+            } else if (id & handleFlag) {
+                signalHandleReadable(id & ~handleFlag);
+            } else if (dispatch(id)) {
+                numCalls += 1;
+            }
+        }
+        return numCalls;
+    }
+
+    void HSerialReactor::run() {
+        while (!stopped.load()) {
+            poll(std::chrono::milliseconds(-1));
+        }
+    }
+
+    void HSerialReactor::stop() {
+        stopped.store(true);
+        // stopFD is level triggered and never read, so every waiting thread wakes up.
+        uint64_t one = 1;
+        ssize_t result = write(stopFD, &one, sizeof(one));
+        (void)result;
+    }
+
+    bool HSerialReactor::isStopped() const {
+        return stopped.load();
+    }
+
+    bool HSerialReactor::dispatch(uint64_t portID) {
+
+        std::unique_lock<std::mutex> lock(mutex);
+
+        auto it = ports.find(portID);
+        if (it == ports.end()) {
+            // The port was removed after epoll_wait returned.
+            return false;
+        }
+        Port* port = it->second.get();
+        port->isDispatching = true;
+        port->dispatchingThread = std::this_thread::get_id();
+        lock.unlock();
+
+        // Drain the eventfd before taking the flags. An event reported after this point
+        //  signals the eventfd again, so it is dispatched after the port is rearmed.
+        uint64_t value;
+        ssize_t result = read(port->eventFD, &value, sizeof(value));
+        (void)result;
+        uint32_t events = port->pendingEvents.exchange(0);
+
+        // Operations of the active controller are attempted. Operations of inactive controllers
+        //  fail, since they could only complete by bypassing access control.
+        std::shared_ptr<Registration> target;
+        std::deque<std::unique_ptr<Operation>> inputs;
+        std::deque<std::unique_ptr<Operation>> outputs;
+        std::deque<std::unique_ptr<Operation>> changes;
+        std::vector<std::unique_ptr<Operation>> orphans;
+
+        lock.lock();
+        for (auto& registration : port->registrations) {
+            if (!target && port->access->isActive(*registration->controller)) {
+                target = registration;
+                inputs.swap(registration->inputs);
+                outputs.swap(registration->outputs);
+                changes.swap(registration->changes);
+            } else {
+                for (auto* queue : {&registration->inputs, &registration->outputs, &registration->changes}) {
+                    for (auto& operation : *queue) orphans.push_back(std::move(operation));
+                    queue->clear();
+                }
+            }
+        }
+        Handler handler = target ? target->handler : Handler();
+        lock.unlock();
+
+        // Exceptions from callbacks and the handler are rethrown after the bookkeeping is done.
+        std::exception_ptr error;
+        auto keepFirstError = [&error]() {
+            if (!error) error = std::current_exception();
+        };
+
+        for (auto& operation : orphans) {
+            try {
+                operation->fail(makeNotActiveError());
+            } catch (...) {
+                keepFirstError();
+            }
+        }
+        orphans.clear();
+
+        bool didCallHandler = false;
+
+        if (target) {
+            HSerialController& controller = *target->controller;
+            for (auto* queue : {&inputs, &outputs}) {
+                while (!queue->empty()) {
+                    bool isComplete = true;
+                    try {
+                        isComplete = queue->front()->tryComplete(*port->access, controller);
+                    } catch (...) {
+                        keepFirstError();
+                    }
+                    if (!isComplete) {
+                        break;
+                    }
+                    queue->pop_front();
+                }
+            }
+
+            // Line waits are independent of each other, so all of them are looked at.
+            if (events & lineCheckEvent) {
+                for (auto it = changes.begin(); it != changes.end(); ) {
+                    bool isComplete = true;
+                    try {
+                        isComplete = (*it)->tryComplete(*port->access, controller);
+                    } catch (...) {
+                        keepFirstError();
+                    }
+                    it = isComplete ? changes.erase(it) : it + 1;
+                }
+            }
+
+            uint32_t ioEvents = events & (readable | writable);
+            if (handler && ioEvents != 0) {
+                didCallHandler = true;
+                try {
+                    handler(ioEvents);
+                } catch (const NotActiveController&) {
+                    // The controller became inactive while handling the event.
+                } catch (...) {
+                    keepFirstError();
+                }
+            }
+        }
+
+        lock.lock();
+        if (target) {
+            if (target->isRemoved) {
+                // The handler (or a callback) removed its own controller.
+                for (auto* queue : {&inputs, &outputs, &changes}) {
+                    for (auto& operation : *queue) orphans.push_back(std::move(operation));
+                }
+            } else {
+                // Put back incomplete operations ahead of any started during the dispatch.
+                while (!inputs.empty()) {
+                    target->inputs.push_front(std::move(inputs.back()));
+                    inputs.pop_back();
+                }
+                while (!outputs.empty()) {
+                    target->outputs.push_front(std::move(outputs.back()));
+                    outputs.pop_back();
+                }
+                for (auto& operation : changes) {
+                    target->changes.push_back(std::move(operation));
+                }
+                // The timer may have found no waits while they were out for this dispatch.
+                if (!target->changes.empty() && !isLineTimerArmed) {
+                    setLineTimer(true);
+                }
+            }
+        }
+        port->isDispatching = false;
+        port->dispatchingThread = std::thread::id();
+        if (port->registrations.empty()) {
+            destroyPort(port);
+        } else {
+            epoll_event event {};
+            event.events = EPOLLIN | EPOLLONESHOT;
+            event.data.u64 = portID;
+            epoll_ctl(epollFD, EPOLL_CTL_MOD, port->eventFD, &event);
+        }
+        lock.unlock();
+        dispatchFinishedCondition.notify_all();
+
+        for (auto& operation : orphans) {
+            try {
+                operation->fail(makeCanceledError());
+            } catch (...) {
+                keepFirstError();
+            }
+        }
+
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return didCallHandler;
+    }
+
+
+#pragma mark - Internal Stuff
+
+    HSerialReactor::Port* HSerialReactor::findPort(const HSerialAccess* access) {
+        for (auto& entry : ports) {
+            if (entry.second->access.get() == access) {
+                return entry.second.get();
+            }
+        }
+        return nullptr;
+    }
+
+    HSerialReactor::Registration& HSerialReactor::getRegistration(HSerialController& controller, Port*& port) {
+        port = findPort(controller.access.get());
+        if (port) {
+            for (auto& registration : port->registrations) {
+                if (registration->controller == &controller) {
+                    return *registration;
+                }
+            }
+        }
+        throw std::invalid_argument("The controller is not registered with the reactor.");
+    }
+
+    void HSerialReactor::destroyPort(Port* port) {
+        // After this returns the observer is not running and won't be called again.
+        port->access->removeEventObserver(port->observerID);
+        if (port->nativeHandle >= 0) {
+            epoll_ctl(epollFD, EPOLL_CTL_DEL, port->nativeHandle, nullptr);
+        }
+        epoll_ctl(epollFD, EPOLL_CTL_DEL, port->eventFD, nullptr);
+        close(port->eventFD);
+        ports.erase(port->id);
+    }
+
+    void HSerialReactor::signalPort(Port* port, uint32_t events) {
+        port->pendingEvents.fetch_or(events);
+        uint64_t one = 1;
+        ssize_t result = write(port->eventFD, &one, sizeof(one));
+        (void)result; // EAGAIN means the counter is saturated, which is still a wakeup.
+    }
+
+    void HSerialReactor::signalHandleReadable(uint64_t portID) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = ports.find(portID);
+        if (it == ports.end()) {
+            return;
+        }
+        // A closed transport's handle may report bytes that open() will discard. Opening the
+        //  port reports a readable event, so nothing is lost by ignoring these.
+        Port* port = it->second.get();
+        if (port->access->isTransportOpen()) {
+            signalPort(port, readable);
+        }
+    }
+
+    void HSerialReactor::cancelOperations(Registration& registration) {
+        std::deque<std::unique_ptr<Operation>> operations;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto* queue : {&registration.inputs, &registration.outputs, &registration.changes}) {
+                for (auto& operation : *queue) operations.push_back(std::move(operation));
+                queue->clear();
+            }
+        }
+
+        std::exception_ptr error;
+        for (auto& operation : operations) {
+            try {
+                operation->fail(makeCanceledError());
+            } catch (...) {
+                if (!error) error = std::current_exception();
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    void HSerialReactor::setLineTimer(bool isArmed) {
+        itimerspec spec {};
+        if (isArmed) {
+            std::chrono::nanoseconds interval = linePollInterval;
+            spec.it_interval.tv_sec = time_t(interval.count() / 1000000000);
+            spec.it_interval.tv_nsec = long(interval.count() % 1000000000);
+            spec.it_value = spec.it_interval;
+        }
+        timerfd_settime(lineTimerFD, 0, &spec, nullptr);
+        isLineTimerArmed = isArmed;
+    }
+
+    void HSerialReactor::signalLineWaiters() {
+        uint64_t expirations;
+        ssize_t result = read(lineTimerFD, &expirations, sizeof(expirations));
+        (void)result;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        bool isWaiting = false;
+        for (auto& entry : ports) {
+            Port* port = entry.second.get();
+            for (auto& registration : port->registrations) {
+                if (!registration->changes.empty()) {
+                    signalPort(port, lineCheckEvent);
+                    isWaiting = true;
+                    break;
+                }
+            }
+        }
+        // A dispatch that puts back waits rearms the timer.
+        if (!isWaiting && isLineTimerArmed) {
+            setLineTimer(false);
+        }
+    }
+
+    void HSerialReactor::runPostedFunctions() {
+        uint64_t value;
+        ssize_t result = read(postFD, &value, sizeof(value));
+        (void)result;
+
+        std::vector<std::function<void()>> functions;
+        {
+            std::lock_guard<std::mutex> lock(postMutex);
+            functions.swap(postedFunctions);
+        }
+        for (size_t i = 0; i < functions.size(); ++i) {
+            try {
+                functions[i]();
+            } catch (...) {
+                // Requeue the rest so they aren't lost.
+                std::lock_guard<std::mutex> lock(postMutex);
+                postedFunctions.insert(postedFunctions.begin(), functions.begin() + i + 1, functions.end());
+                if (!postedFunctions.empty()) {
+                    uint64_t one = 1;
+                    result = write(postFD, &one, sizeof(one));
+                }
+                throw;
+            }
+        }
+    }
+
+}
+
+#endif /* __linux__ */
@@ -0,0 +1,372 @@
+//
+//  HSerialReactor.hpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+
+#ifndef HSerialReactor_hpp
+#define HSerialReactor_hpp
+
+#if defined(__linux__)
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+
+namespace hserial {
+
+    class HSerialController;
+    class HSerialAccess;
+
+    /*!
+     \brief Services many ports from a few threads using a single epoll instance.
+
+     Controllers are registered with a handler. When a port becomes readable or writable the
+     reactor calls the handler of the port's active controller -- handlers of inactive
+     controllers are never called, so the reactor preserves HSerial's access rules. If no
+     registered controller of the port is active the event is dropped.
+
+     Events come from the following sources:
+     - `readable` is reported when the port's transport has a native handle (see
+       HSerialTransport::getNativeHandle) and the reactor's epoll instance sees it become
+       readable, or when the port is opened. serial::Serial does not expose its file descriptor,
+       so for it `readable` is reported by the read pump instead, when it adds bytes to the read
+       buffer (or encounters an error, which the next read will throw). In that case readable
+       events require read buffering (see HSerialController::enableReadBuffering).
+     - `writable` is reported when the port is registered and whenever the write queue finishes
+       a batch (see HSerialController::enqueueWrite).
+
+     Several reactors may watch the same port; each one gets every event.
+
+     Events are edge-like: a handler should read everything that is available (for example,
+     using available() and read()) since it won't be called again until new bytes arrive. Events
+     for one port are never dispatched concurrently, but different ports may be dispatched on
+     different threads.
+
+     Any number of threads may call run() or poll(). Handlers may call add and remove, including
+     for their own controller.
+
+     The reactor also performs asynchronous operations (asyncRead, asyncReadline, asyncWrite and
+     asyncWaitForChange) for registered controllers. Completion callbacks are always called
+     from a thread in run() or poll(), never from the function that started the operation.
+     Reads and line reads complete in the order they were started, as do writes. If the
+     controller is not active when an operation would complete -- for example, because another
+     controller called makeActive while the operation was pending -- the operation fails with
+     NotActiveController. Pending operations don't hold the port: they don't count as access calls
+     and don't delay transitions. See HSerialAwaitable.hpp for C++20 coroutine support.
+
+     The reactor is only available on Linux.
+     */
+    class HSerialReactor {
+
+    public:
+
+        /*!
+         \brief Event flag indicating that the port may have bytes to read.
+         */
+        static const uint32_t readable = 0x1;
+
+        /*!
+         \brief Event flag indicating that the port's write queue has finished a batch.
+         */
+        static const uint32_t writable = 0x2;
+
+        /*!
+         \brief The handler type. The argument is a combination of event flags.
+
+         The access functions of HSerialController are protected, so a handler typically
+         captures the controller that registered it (e.g. `[this](uint32_t events) {...}`).
+         */
+        typedef std::function<void(uint32_t events)> Handler;
+
+        /*!
+         \brief The completion callback type for asyncRead and asyncWrite.
+
+         If `error` is set the operation failed and `count` is zero.
+         */
+        typedef std::function<void(std::exception_ptr error, size_t count)> CountCallback;
+
+        /*!
+         \brief The completion callback type for asyncReadline.
+         */
+        typedef std::function<void(std::exception_ptr error, std::string line)> LineCallback;
+
+        /*!
+         \brief The completion callback type for asyncWaitForChange.
+         */
+        typedef std::function<void(std::exception_ptr error, bool changed)> ChangeCallback;
+
+        /*!
+         \brief Creates a reactor.
+         \throws std::system_error if the epoll instance can't be created.
+         */
+        HSerialReactor();
+
+        HSerialReactor(const HSerialReactor&) = delete;
+        HSerialReactor& operator=(const HSerialReactor&) = delete;
+
+        /*!
+         \brief Destroys the reactor. No thread may be in run() or poll().
+         */
+        ~HSerialReactor();
+
+        /*!
+         \brief Registers a controller.
+
+         The controller must be removed (or the reactor destroyed) before the controller is
+         destroyed. Several controllers of the same port may be registered.
+
+         \throws std::invalid_argument if the controller is already registered.
+         \throws std::system_error if the port can't be added to the epoll instance.
+         \see remove
+         */
+        void add(HSerialController& controller, Handler handler = Handler());
+
+        /*!
+         \brief Unregisters a controller.
+
+         When this function returns the controller's handler is not running on any other thread
+         and will not be called again. If the controller is not registered this function does
+         nothing.
+
+         Pending asynchronous operations are failed with std::system_error
+         (`std::errc::operation_canceled`). These callbacks are called from this function.
+         */
+        void remove(HSerialController& controller);
+
+        /*!
+         \brief Reads up to `size` bytes once at least one byte is available.
+
+         If the port's transport has no native handle, read buffering must be enabled on the port
+         (see HSerialController::enableReadBuffering), otherwise the operation fails with
+         std::logic_error. `buffer` must remain valid until the callback is called.
+
+         \throws std::invalid_argument if the controller is not registered.
+         */
+        void asyncRead(HSerialController& controller, uint8_t* buffer, size_t size, CountCallback callback);
+
+        /*!
+         \brief Reads a line once a complete line is available.
+
+         A line is complete when it ends with `eol` or reaches `size` bytes (or fills the read
+         buffer). As with asyncRead, read buffering must be enabled on the port unless its
+         transport has a native handle.
+
+         \throws std::invalid_argument if the controller is not registered.
+         */
+        void asyncReadline(HSerialController& controller, size_t size, const std::string& eol, LineCallback callback);
+
+        /*!
+         \brief Writes data, completing once it has been handed to the driver.
+
+         The data is copied into the port's write queue (see HSerialController::enqueueWrite)
+         before this function returns.
+
+         \throws std::invalid_argument if the controller is not registered.
+         */
+        void asyncWrite(HSerialController& controller, const uint8_t* data, size_t size, CountCallback callback);
+
+        /*!
+         \brief Waits for a change on the modem status lines.
+
+         The levels of CTS, DSR, RI and CD are read when the operation starts, and the reactor
+         compares them with the current levels every line poll interval (see
+         setLinePollInterval). The operation completes with `true` when a level differs, or with
+         `false` if the port is closed. A pulse shorter than the interval may be missed.
+
+         Unlike HSerialController::waitForChange no thread is blocked on the port, so a pending
+         wait does not hold up transitions: if the controller loses the active role the operation
+         fails with NotActiveController.
+
+         \throws std::invalid_argument if the controller is not registered.
+         */
+        void asyncWaitForChange(HSerialController& controller, ChangeCallback callback);
+
+        /*!
+         \brief Sets how often pending asyncWaitForChange operations look at the lines.
+
+         Defaults to 10 ms. The lines are only polled while such an operation is pending.
+
+         \throws std::invalid_argument if the interval is not positive.
+         */
+        void setLinePollInterval(const std::chrono::milliseconds& interval);
+
+        std::chrono::milliseconds getLinePollInterval();
+
+        /*!
+         \brief Calls a function from a thread in run() or poll().
+         */
+        void post(std::function<void()> function);
+
+        /*!
+         \brief Waits for events and dispatches them.
+
+         A negative timeout waits indefinitely.
+
+         Exceptions thrown by handlers propagate, except for NotActiveController (which just
+         means the controller became inactive while handling the event).
+
+         \returns The number of handler calls made.
+         \throws std::system_error if epoll fails.
+         */
+        size_t poll(const std::chrono::milliseconds& timeout);
+
+        /*!
+         \brief Dispatches events until stop() is called.
+         \see poll
+         */
+        void run();
+
+        /*!
+         \brief Makes all current and future calls to run() return, and makes poll() return
+         immediately.
+         */
+        void stop();
+
+        /*!
+         \brief Indicates if stop() has been called.
+         */
+        bool isStopped() const;
+
+    private:
+
+        struct Operation;
+        struct ReadOperation;
+        struct ReadlineOperation;
+        struct WriteOperation;
+        struct ChangeOperation;
+        struct Registration;
+        struct Port;
+
+        /*!
+         \brief [Internal] Protects ports and the non-atomic Port members.
+         */
+        std::mutex mutex;
+
+        /*!
+         \brief [Internal] Notified when a port's dispatch finishes.
+         */
+        std::condition_variable dispatchFinishedCondition;
+
+        /*!
+         \brief [Internal] The registered ports, keyed by id.
+
+         The id (not a pointer) is stored in the epoll event, so an event that arrives after its
+         port was removed is harmlessly ignored.
+         */
+        std::unordered_map<uint64_t, std::unique_ptr<Port>> ports;
+
+        uint64_t nextPortID = 3;
+
+        int epollFD = -1;
+
+        /*!
+         \brief [Internal] An eventfd that is never read, used to wake every polling thread after
+         stop() is called.
+         */
+        int stopFD = -1;
+
+        std::atomic_bool stopped {false};
+
+        /*!
+         \brief [Internal] An eventfd signaled by post().
+         */
+        int postFD = -1;
+
+        /*!
+         \brief [Internal] Protects postedFunctions.
+         */
+        std::mutex postMutex;
+
+        std::vector<std::function<void()>> postedFunctions;
+
+        /*!
+         \brief [Internal] A timerfd that fires every linePollInterval while asyncWaitForChange
+         operations are pending.
+         */
+        int lineTimerFD = -1;
+
+        /*!
+         \brief [Internal] Indicates if lineTimerFD is running. Protected by mutex.
+         */
+        bool isLineTimerArmed = false;
+
+        std::chrono::milliseconds linePollInterval {10};
+
+        /*!
+         \brief [Internal] Finds the port for an access object. Assumes mutex is locked.
+         */
+        Port* findPort(const HSerialAccess* access);
+
+        /*!
+         \brief [Internal] Finds the registration for a controller, or throws
+         std::invalid_argument. Assumes mutex is locked.
+         */
+        Registration& getRegistration(HSerialController& controller, Port*& port);
+
+        /*!
+         \brief [Internal] Unregisters a port with no controllers and frees it. Assumes mutex is
+         locked and the port is not being dispatched.
+         */
+        void destroyPort(Port* port);
+
+        /*!
+         \brief [Internal] Records events for a port and wakes a polling thread.
+
+         This is the port's event observer, and is also used to get new operations looked at.
+         */
+        static void signalPort(Port* port, uint32_t events);
+
+        /*!
+         \brief [Internal] Handles an event from a port's native handle by reporting a readable
+         event on the port's eventfd, if the port is still registered and open. Assumes mutex is
+         not locked.
+         */
+        void signalHandleReadable(uint64_t portID);
+
+        /*!
+         \brief [Internal] Cancels the pending operations of a registration. Assumes mutex is
+         not locked.
+         */
+        void cancelOperations(Registration& registration);
+
+        /*!
+         \brief [Internal] Starts or stops lineTimerFD. Assumes mutex is locked.
+         */
+        void setLineTimer(bool isArmed);
+
+        /*!
+         \brief [Internal] Handles a lineTimerFD expiration by asking each port with pending
+         asyncWaitForChange operations to look at its lines. Stops the timer if there are none.
+         */
+        void signalLineWaiters();
+
+        /*!
+         \brief [Internal] Runs the functions passed to post().
+         */
+        void runPostedFunctions();
+
+        /*!
+         \brief [Internal] Reads the port's events and calls the active controller's handler.
+         \returns `true` if a handler was called.
+         */
+        bool dispatch(uint64_t portID);
+    };
+
+}
+
+#endif /* __linux__ */
+
+#endif /* HSerialReactor_hpp */
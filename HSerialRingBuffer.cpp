@@ -0,0 +1,127 @@
+//
+//  HSerialRingBuffer.cpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+
+#include "HSerialRingBuffer.hpp"
+
+#include "HSerialScan.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+
+namespace hserial {
+
+    HSerialRingBuffer::HSerialRingBuffer(size_t capacity) {
+        if (capacity == 0) throw std::invalid_argument("Ring buffer capacity must not be zero.");
+        storage.resize(capacity);
+    }
+
+    size_t HSerialRingBuffer::getCapacity() const {
+        return storage.size();
+    }
+
+    size_t HSerialRingBuffer::getSize() const {
+        return size;
+    }
+
+    size_t HSerialRingBuffer::getFree() const {
+        return storage.size() - size;
+    }
+
+    bool HSerialRingBuffer::isEmpty() const {
+        return size == 0;
+    }
+
+    bool HSerialRingBuffer::isFull() const {
+        return size == storage.size();
+    }
+
+    void HSerialRingBuffer::clear() {
+        head = 0;
+        size = 0;
+    }
+
+    size_t HSerialRingBuffer::write(const uint8_t* data, size_t count) {
+        const size_t capacity = storage.size();
+        count = std::min(count, capacity - size);
+        size_t tail = head + size;
+        if (tail >= capacity) tail -= capacity;
+        // The free region may wrap around the end of the storage, so copy in up to two segments.
+        size_t first = std::min(count, capacity - tail);
+        std::memcpy(&storage[tail], data, first);
+        std::memcpy(&storage[0], data + first, count - first);
+        size += count;
+        return count;
+    }
+
+    size_t HSerialRingBuffer::read(uint8_t* buffer, size_t count) {
+        count = peek(buffer, count);
+        return discard(count);
+    }
+
+    size_t HSerialRingBuffer::discard(size_t count) {
+        count = std::min(count, size);
+        head += count;
+        if (head >= storage.size()) head -= storage.size();
+        size -= count;
+        if (size == 0) {
+            // Resetting the head keeps future data contiguous for as long as possible.
+            head = 0;
+        }
+        return count;
+    }
+
+    size_t HSerialRingBuffer::peek(uint8_t* buffer, size_t count, size_t offset) const {
+        if (offset >= size) return 0;
+        const size_t capacity = storage.size();
+        count = std::min(count, size - offset);
+        size_t start = head + offset;
+        if (start >= capacity) start -= capacity;
+        size_t first = std::min(count, capacity - start);
+        std::memcpy(buffer, &storage[start], first);
+        std::memcpy(buffer + first, &storage[0], count - first);
+        return count;
+    }
+
+    uint8_t HSerialRingBuffer::at(size_t index) const {
+        size_t i = head + index;
+        if (i >= storage.size()) i -= storage.size();
+        return storage[i];
+    }
+
+    size_t HSerialRingBuffer::find(const uint8_t* pattern, size_t patternSize, size_t start) const {
+        if (patternSize == 0 || start >= size || patternSize > size - start) return npos;
+        const size_t capacity = storage.size();
+
+        // The bytes from start to the end of the buffer are in at most two contiguous segments.
+        //  Matches entirely within a segment are found by the scan kernel, and matches straddling
+        //  the wrap are checked byte by byte.
+        size_t i = head + start;
+        if (i >= capacity) i -= capacity;
+        const size_t firstSize = std::min(size - start, capacity - i);
+
+        size_t found = scan::find(&storage[i], firstSize, pattern, patternSize);
+        if (found != scan::npos) return start + found;
+
+        const size_t wrapIndex = start + firstSize;
+        if (wrapIndex == size) return npos;
+
+        size_t index = wrapIndex - std::min(firstSize, patternSize - 1);
+        for ( ; index < wrapIndex && index + patternSize <= size; ++index) {
+            size_t k = 0;
+            while (k < patternSize && at(index + k) == pattern[k]) ++k;
+            if (k == patternSize) return index;
+        }
+
+        found = scan::find(&storage[0], size - wrapIndex, pattern, patternSize);
+        if (found != scan::npos) return wrapIndex + found;
+        return npos;
+    }
+
+}
@@ -0,0 +1,130 @@
+//
+//  HSerialRingBuffer.hpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+
+#ifndef HSerialRingBuffer_hpp
+#define HSerialRingBuffer_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/// \cond internal_docs
+
+namespace hserial {
+
+    /*!
+     \brief An internal fixed-capacity byte queue.
+
+     HSerialAccess uses a ring buffer to hold received bytes that have not yet been read by a
+     controller (see HSerialAccess::enableReadBuffering). The storage is allocated once, in the
+     constructor, and never reallocated.
+
+     A ring buffer is not thread safe. The owner must provide synchronization.
+     */
+    class HSerialRingBuffer {
+
+    public:
+
+        /*!
+         \brief The value returned by find() if the pattern is not found.
+         */
+        static const size_t npos = static_cast<size_t>(-1);
+
+        /*!
+         \brief Creates a ring buffer that can hold `capacity` bytes.
+
+         \throws std::invalid_argument if `capacity` is zero.
+         */
+        HSerialRingBuffer(size_t capacity);
+
+        HSerialRingBuffer() = delete;
+        HSerialRingBuffer(const HSerialRingBuffer&) = delete;
+        HSerialRingBuffer& operator=(const HSerialRingBuffer&) = delete;
+
+        /*!
+         \brief Returns the maximum number of bytes the buffer can hold.
+         */
+        size_t getCapacity() const;
+
+        /*!
+         \brief Returns the number of bytes in the buffer.
+         */
+        size_t getSize() const;
+
+        /*!
+         \brief Returns the number of bytes that can be written before the buffer is full.
+         */
+        size_t getFree() const;
+
+        bool isEmpty() const;
+        bool isFull() const;
+
+        /*!
+         \brief Discards all bytes in the buffer.
+         */
+        void clear();
+
+        /*!
+         \brief Appends up to `size` bytes to the buffer.
+         \returns The number of bytes appended, which is less than `size` if the buffer fills up.
+         */
+        size_t write(const uint8_t* data, size_t size);
+
+        /*!
+         \brief Removes up to `size` bytes from the front of the buffer and copies them to
+         `buffer`.
+         \returns The number of bytes removed.
+         */
+        size_t read(uint8_t* buffer, size_t size);
+
+        /*!
+         \brief Removes up to `size` bytes from the front of the buffer without copying them.
+         \returns The number of bytes removed.
+         */
+        size_t discard(size_t size);
+
+        /*!
+         \brief Copies up to `size` bytes starting at `offset` (counted from the front) without
+         removing them.
+         \returns The number of bytes copied.
+         */
+        size_t peek(uint8_t* buffer, size_t size, size_t offset = 0) const;
+
+        /*!
+         \brief Returns the byte at `index`, counted from the front. `index` must be less than
+         getSize().
+         */
+        uint8_t at(size_t index) const;
+
+        /*!
+         \brief Finds the first occurrence of `pattern` at or after `start`.
+         \returns The index (counted from the front) of the start of the match, or npos.
+         */
+        size_t find(const uint8_t* pattern, size_t patternSize, size_t start = 0) const;
+
+    private:
+
+        std::vector<uint8_t> storage;
+
+        /*!
+         \brief The storage index of the front of the buffer.
+         */
+        size_t head = 0;
+
+        /*!
+         \brief The number of bytes in the buffer.
+         */
+        size_t size = 0;
+    };
+
+}
+
+/// \endcond internal_docs
+
+#endif /* HSerialRingBuffer_hpp */
@@ -0,0 +1,158 @@
+//
+//  HSerialScan.cpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+
+#include "HSerialScan.hpp"
+
+#include <cstring>
+
+// The x86 kernels use GCC/Clang builtins (__builtin_ctz, __builtin_cpu_supports and the target
+//  attribute), so they are only compiled with those compilers.
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define HSERIAL_SCAN_SSE2 1
+#define HSERIAL_SCAN_AVX2 1
+#include <immintrin.h>
+#endif
+
+
+namespace hserial {
+    namespace scan {
+
+        namespace {
+
+            typedef size_t (*FindFunction)(const uint8_t*, size_t, const uint8_t*, size_t);
+
+            FindFunction selectKernel() {
+#if HSERIAL_SCAN_AVX2
+                if (__builtin_cpu_supports("avx2")) {
+                    return &findAVX2;
+                }
+#endif
+                return &findSSE2;
+            }
+
+#if HSERIAL_SCAN_SSE2
+            // Checks the candidate positions in `mask` (bit i set means position `offset + i`
+            //  matched on the first and last pattern bytes).
+            inline size_t checkCandidates(uint32_t mask, const uint8_t* data, size_t offset, const uint8_t* pattern, size_t patternSize) {
+                while (mask != 0) {
+                    size_t i = offset + __builtin_ctz(mask);
+                    if (std::memcmp(data + i + 1, pattern + 1, patternSize - 2) == 0) {
+                        return i;
+                    }
+                    mask &= mask - 1;
+                }
+                return npos;
+            }
+#endif
+
+        }
+
+        size_t find(const uint8_t* data, size_t size, const uint8_t* pattern, size_t patternSize) {
+            if (patternSize == 0 || patternSize > size) {
+                return npos;
+            }
+            if (patternSize == 1) {
+                const void* hit = std::memchr(data, pattern[0], size);
+                return hit ? static_cast<const uint8_t*>(hit) - data : npos;
+            }
+            // Initialized once. Concurrent first calls are safe since C++11.
+            static const FindFunction kernel = selectKernel();
+            return kernel(data, size, pattern, patternSize);
+        }
+
+        size_t findGeneric(const uint8_t* data, size_t size, const uint8_t* pattern, size_t patternSize) {
+            if (patternSize == 0 || patternSize > size) {
+                return npos;
+            }
+            const size_t lastStart = size - patternSize;
+            size_t index = 0;
+            while (index <= lastStart) {
+                const void* hit = std::memchr(data + index, pattern[0], lastStart - index + 1);
+                if (!hit) {
+                    return npos;
+                }
+                index = static_cast<const uint8_t*>(hit) - data;
+                if (std::memcmp(data + index + 1, pattern + 1, patternSize - 1) == 0) {
+                    return index;
+                }
+                index += 1;
+            }
+            return npos;
+        }
+
+#if HSERIAL_SCAN_SSE2
+
+        size_t findSSE2(const uint8_t* data, size_t size, const uint8_t* pattern, size_t patternSize) {
+            if (patternSize < 2 || patternSize > size) {
+                return findGeneric(data, size, pattern, patternSize);
+            }
+            const __m128i first = _mm_set1_epi8(static_cast<char>(pattern[0]));
+            const __m128i last = _mm_set1_epi8(static_cast<char>(pattern[patternSize - 1]));
+            const size_t lastStart = size - patternSize;
+            size_t offset = 0;
+            // Each block loads sixteen bytes starting at offset and at offset + patternSize - 1,
+            //  so it may only be used while both loads are in bounds.
+            while (offset + 16 <= lastStart + 1) {
+                __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset));
+                __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset + patternSize - 1));
+                __m128i eq = _mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last));
+                uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(eq));
+                size_t found = checkCandidates(mask, data, offset, pattern, patternSize);
+                if (found != npos) {
+                    return found;
+                }
+                offset += 16;
+            }
+            size_t found = findGeneric(data + offset, size - offset, pattern, patternSize);
+            return found == npos ? npos : offset + found;
+        }
+
+#else
+
+        size_t findSSE2(const uint8_t* data, size_t size, const uint8_t* pattern, size_t patternSize) {
+            return findGeneric(data, size, pattern, patternSize);
+        }
+
+#endif
+
+#if HSERIAL_SCAN_AVX2
+
+        __attribute__((target("avx2")))
+        size_t findAVX2(const uint8_t* data, size_t size, const uint8_t* pattern, size_t patternSize) {
+            if (patternSize < 2 || patternSize > size) {
+                return findGeneric(data, size, pattern, patternSize);
+            }
+            const __m256i first = _mm256_set1_epi8(static_cast<char>(pattern[0]));
+            const __m256i last = _mm256_set1_epi8(static_cast<char>(pattern[patternSize - 1]));
+            const size_t lastStart = size - patternSize;
+            size_t offset = 0;
+            while (offset + 32 <= lastStart + 1) {
+                __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + offset));
+                __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + offset + patternSize - 1));
+                __m256i eq = _mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first), _mm256_cmpeq_epi8(blockLast, last));
+                uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(eq));
+                size_t found = checkCandidates(mask, data, offset, pattern, patternSize);
+                if (found != npos) {
+                    return found;
+                }
+                offset += 32;
+            }
+            size_t found = findSSE2(data + offset, size - offset, pattern, patternSize);
+            return found == npos ? npos : offset + found;
+        }
+
+#else
+
+        size_t findAVX2(const uint8_t* data, size_t size, const uint8_t* pattern, size_t patternSize) {
+            return findSSE2(data, size, pattern, patternSize);
+        }
+
+#endif
+
+    }
+}
@@ -0,0 +1,66 @@
+//
+//  HSerialScan.hpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+
+#ifndef HSerialScan_hpp
+#define HSerialScan_hpp
+
+#include <cstddef>
+#include <cstdint>
+
+
+/// \cond internal_docs
+
+namespace hserial {
+
+    /*!
+     \brief Internal byte scanning kernels used for delimiter (eol) searches.
+     */
+    namespace scan {
+
+        /*!
+         \brief The value returned by the find functions if the pattern is not found.
+         */
+        const size_t npos = static_cast<size_t>(-1);
+
+        /*!
+         \brief Finds the first occurrence of `pattern` that lies entirely within `data`.
+
+         Dispatches once, at first use, to the fastest kernel supported by the CPU. Single byte
+         patterns always use memchr, which the C library already vectorizes.
+
+         \returns The offset of the start of the match, or npos.
+         */
+        size_t find(const uint8_t* data, size_t size, const uint8_t* pattern, size_t patternSize);
+
+        /*!
+         \brief The portable kernel: memchr for the first pattern byte, then memcmp.
+         */
+        size_t findGeneric(const uint8_t* data, size_t size, const uint8_t* pattern, size_t patternSize);
+
+        /*!
+         \brief The SSE2 kernel. Falls back to findGeneric where SSE2 is not available.
+
+         Sixteen candidate positions at a time are filtered by comparing both the first and the
+         last pattern byte, so memcmp runs only on positions where both match.
+         */
+        size_t findSSE2(const uint8_t* data, size_t size, const uint8_t* pattern, size_t patternSize);
+
+        /*!
+         \brief The AVX2 kernel. Same approach as findSSE2 with thirty-two positions at a time.
+
+         Must only be called if the CPU supports AVX2. Falls back to findSSE2 where the compiler
+         can't target AVX2.
+         */
+        size_t findAVX2(const uint8_t* data, size_t size, const uint8_t* pattern, size_t patternSize);
+
+    }
+}
+
+/// \endcond internal_docs
+
+#endif /* HSerialScan_hpp */
@@ -0,0 +1,272 @@
+//
+//  HSerialScheduler.cpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+
+#include "HSerialScheduler.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "HSerialController.hpp"
+#include "HSerialAccess.hpp"
+
+
+namespace hserial {
+
+    namespace {
+
+        std::chrono::microseconds toMicroseconds(std::chrono::steady_clock::duration duration) {
+            return std::chrono::duration_cast<std::chrono::microseconds>(duration);
+        }
+    }
+
+
+#pragma mark - Construction/Destruction
+
+    HSerialScheduler::HSerialScheduler(const HSerialSchedulerOptions& options) : quantum(options.quantum) {
+        if (quantum <= std::chrono::milliseconds(0)) {
+            throw std::invalid_argument("The quantum must be positive.");
+        }
+        worker = std::thread(&HSerialScheduler::runWorker, this);
+    }
+
+    HSerialScheduler::~HSerialScheduler() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            isStopping = true;
+        }
+        workCondition.notify_all();
+        sliceCondition.notify_all();
+        worker.join();
+    }
+
+
+#pragma mark - Registration
+
+    void HSerialScheduler::add(HSerialController& controller, unsigned weight) {
+        if (weight == 0) {
+            throw std::invalid_argument("The weight must be at least one.");
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& entry : entries) {
+            if (entry->controller == &controller) {
+                throw std::invalid_argument("The controller is already registered with the scheduler.");
+            }
+        }
+        if (access && access != controller.access) {
+            throw std::invalid_argument("The controller uses a different port than the scheduler's other controllers.");
+        }
+        access = controller.access;
+        std::shared_ptr<Entry> entry = std::make_shared<Entry>();
+        entry->controller = &controller;
+        entry->weight = weight;
+        entry->addTime = Clock::now();
+        entries.push_back(std::move(entry));
+    }
+
+    void HSerialScheduler::remove(HSerialController& controller) {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto it = std::find_if(entries.begin(), entries.end(), [&controller](const std::shared_ptr<Entry>& entry) {
+            return entry->controller == &controller;
+        });
+        if (it == entries.end()) {
+            return;
+        }
+        std::shared_ptr<Entry> entry = *it;
+
+        // The scheduler's thread may be making the controller active right now.
+        sliceCondition.wait(lock, [this, &entry]() {
+            return switchingTo != entry.get();
+        });
+        if (owner == entry.get()) {
+            endSlice(Clock::now());
+        }
+        entry->isRemoved = true;
+        entries.erase(std::find(entries.begin(), entries.end(), entry));
+        if (entries.empty()) {
+            access.reset();
+        }
+        sliceCondition.notify_all();
+        workCondition.notify_all();
+    }
+
+
+#pragma mark - Slices
+
+    bool HSerialScheduler::acquire(HSerialController& controller, const std::chrono::milliseconds& timeout) {
+        Clock::time_point deadline = Clock::now() + timeout;
+        std::unique_lock<std::mutex> lock(mutex);
+        Entry& entry = getEntry(controller);
+        if (!entry.isWaiting) {
+            entry.isWaiting = true;
+            entry.waitStart = Clock::now();
+        }
+        if (owner == &entry) {
+            return true;
+        }
+        workCondition.notify_all();
+
+        // Keeps the entry alive if it is removed while waiting.
+        std::shared_ptr<Entry> kept;
+        for (const auto& e : entries) {
+            if (e.get() == &entry) {
+                kept = e;
+            }
+        }
+        sliceCondition.wait_until(lock, deadline, [this, &kept]() {
+            return owner == kept.get() || kept->isRemoved || isStopping;
+        });
+        if (owner == kept.get()) {
+            return true;
+        }
+        kept->isWaiting = false;
+        return false;
+    }
+
+    void HSerialScheduler::release(HSerialController& controller) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            getEntry(controller).isWaiting = false;
+        }
+        workCondition.notify_all();
+    }
+
+    std::chrono::microseconds HSerialScheduler::getSliceRemaining(const HSerialController& controller) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (owner == nullptr || owner->controller != &controller) {
+            return std::chrono::microseconds(0);
+        }
+        return std::max(toMicroseconds(sliceEnd - Clock::now()), std::chrono::microseconds(0));
+    }
+
+    HSerialSchedulerStats HSerialScheduler::getStats(const HSerialController& controller) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        const Entry& entry = getEntry(controller);
+        Clock::time_point now = Clock::now();
+        HSerialSchedulerStats stats = entry.stats;
+        if (owner == &entry) {
+            stats.activeTime += toMicroseconds(now - sliceStart);
+        }
+        std::chrono::microseconds registered = toMicroseconds(now - entry.addTime);
+        if (registered.count() > 0) {
+            stats.utilization = double(stats.activeTime.count()) / double(registered.count());
+        }
+        return stats;
+    }
+
+
+#pragma mark - Internal
+
+    HSerialScheduler::Entry& HSerialScheduler::getEntry(const HSerialController& controller) const {
+        for (const auto& entry : entries) {
+            if (entry->controller == &controller) {
+                return *entry;
+            }
+        }
+        throw std::invalid_argument("The controller is not registered with the scheduler.");
+    }
+
+    void HSerialScheduler::endSlice(Clock::time_point now) {
+        owner->stats.activeTime += toMicroseconds(now - sliceStart);
+        owner = nullptr;
+    }
+
+    size_t HSerialScheduler::findNextWaiting(const Entry* except) const {
+        size_t size = entries.size();
+        for (size_t i = 0; i < size; ++i) {
+            size_t index = (nextIndex + i) % size;
+            const Entry* entry = entries[index].get();
+            if (entry->isWaiting && entry != except) {
+                return index;
+            }
+        }
+        return size;
+    }
+
+    void HSerialScheduler::runWorker() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!isStopping) {
+            Clock::time_point now = Clock::now();
+
+            if (owner) {
+                if (owner->isWaiting && now < sliceEnd) {
+                    workCondition.wait_until(lock, sliceEnd);
+                    continue;
+                }
+                // The slice is over: it expired or was released.
+                if (findNextWaiting(owner) == entries.size()) {
+                    // No one else is waiting, so the owner keeps the port. If it still wants it
+                    //  the slice is extended, otherwise it holds the port without a slice.
+                    if (owner->isWaiting) {
+                        sliceEnd = now + quantum * owner->weight;
+                    } else {
+                        endSlice(now);
+                    }
+                    continue;
+                }
+                // Someone else is waiting. An owner that still wants the port goes to the back
+                //  of the line.
+                Entry* previous = owner;
+                endSlice(now);
+                previous->waitStart = now;
+            }
+
+            size_t index = findNextWaiting(nullptr);
+            if (index == entries.size()) {
+                workCondition.wait(lock);
+                continue;
+            }
+            Entry* next = entries[index].get();
+
+            // makeActive runs transition callbacks, so the mutex can't be held. remove waits
+            //  for switchingTo to be cleared, so next stays valid.
+            switchingTo = next;
+            std::shared_ptr<HSerialAccess> portAccess = access;
+            lock.unlock();
+            try {
+                portAccess->makeActive(*next->controller, priority::normal, Clock::time_point::max());
+            } catch (...) {
+                // Refused (or failed after the change). Checked below.
+            }
+            bool isActive = portAccess->isActive(*next->controller);
+            lock.lock();
+            switchingTo = nullptr;
+            sliceCondition.notify_all();
+            now = Clock::now();
+
+            // Start the round-robin search after this entry next time (whether or not it got the
+            //  port, so a refused entry doesn't block the others).
+            for (size_t i = 0; i < entries.size(); ++i) {
+                if (entries[i].get() == next) {
+                    nextIndex = i + 1;
+                }
+            }
+
+            if (!isActive) {
+                // The active controller refused. Try again after a quantum.
+                workCondition.wait_for(lock, quantum);
+                continue;
+            }
+            if (!next->isWaiting) {
+                // Released, or its acquire timed out, while it was being made active.
+                continue;
+            }
+            owner = next;
+            sliceStart = now;
+            sliceEnd = now + quantum * next->weight;
+            std::chrono::microseconds wait = toMicroseconds(now - next->waitStart);
+            next->stats.numSlices += 1;
+            next->stats.totalWaitTime += wait;
+            next->stats.maxWaitTime = std::max(next->stats.maxWaitTime, wait);
+            sliceCondition.notify_all();
+        }
+        if (owner) {
+            endSlice(Clock::now());
+        }
+    }
+
+}
@@ -0,0 +1,250 @@
+//
+//  HSerialScheduler.hpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+
+#ifndef HSerialScheduler_hpp
+#define HSerialScheduler_hpp
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace hserial {
+
+    class HSerialController;
+    class HSerialAccess;
+
+    /*!
+     \brief Options for HSerialScheduler.
+     */
+    struct HSerialSchedulerOptions {
+
+        /*!
+         \brief The length of a time slice for a controller with weight 1.
+         */
+        std::chrono::milliseconds quantum {20};
+    };
+
+    /*!
+     \brief Statistics for a controller registered with an HSerialScheduler.
+     */
+    struct HSerialSchedulerStats {
+
+        /*!
+         \brief The number of time slices the controller has been given.
+         */
+        uint64_t numSlices = 0;
+
+        /*!
+         \brief The total time spent waiting for slices (from acquire, or from losing the port
+         at a quantum boundary, until the slice started).
+         */
+        std::chrono::microseconds totalWaitTime {0};
+
+        /*!
+         \brief The longest wait for a slice.
+         */
+        std::chrono::microseconds maxWaitTime {0};
+
+        /*!
+         \brief The total time the controller has held slices.
+         */
+        std::chrono::microseconds activeTime {0};
+
+        /*!
+         \brief activeTime as a fraction of the time since the controller was added.
+         */
+        double utilization = 0.0;
+    };
+
+    /*!
+     \brief Shares a port among controllers in time slices.
+
+     Controllers that need the port briefly and often can fight over it with makeActive, but
+     each refusal costs a retry and latency comes in bursts. A scheduler instead gives the active
+     role to its registered controllers in turn. A controller calls acquire() when it needs the
+     port, which returns once the controller has a slice, and release() when it is done:
+
+         scheduler.add(monitor, 2);
+         ...
+         if (scheduler.acquire(monitor, std::chrono::milliseconds(100))) {
+             // The monitor is active. Poll the device...
+             scheduler.release(monitor);
+         }
+
+     Controllers waiting for the port are served round-robin. A slice lasts for the quantum
+     times the controller's weight, or until the controller calls release(). When a slice ends
+     and another controller is waiting the scheduler makes that controller active, which makes
+     the slice owner inactive in the usual way (its willMakeInactive callback runs, and access
+     calls made after that throw NotActiveController). If no other controller is waiting the
+     owner keeps the port, so the port is never handed over needlessly. getSliceRemaining()
+     lets an owner check whether an exchange will fit in its slice.
+
+     Controller changes are made by the scheduler's thread using makeActive, so they are queued
+     with any others on the port. Controllers that aren't registered can still use the port, but
+     the scheduler takes it back at the next slice boundary. A registered controller should not
+     refuse to become inactive (e.g. by being locked, so an HSerial shouldn't use
+     makeLockedActive) -- if it does, the waiting controller is tried again a quantum later.
+
+     All functions are thread-safe. Controllers must be removed before they are destroyed.
+     */
+    class HSerialScheduler {
+
+    public:
+
+        explicit HSerialScheduler(const HSerialSchedulerOptions& options = HSerialSchedulerOptions());
+
+        HSerialScheduler(const HSerialScheduler&) = delete;
+        HSerialScheduler& operator=(const HSerialScheduler&) = delete;
+
+        /*!
+         \brief Stops the scheduler. Threads waiting in acquire() return `false`.
+
+         The controllers are left as they are (so one of them may still be active).
+         */
+        ~HSerialScheduler();
+
+        /*!
+         \brief Registers a controller.
+
+         All controllers of a scheduler must use the same port.
+
+         \param weight The controller's slices are `weight` quanta long.
+         \throws std::invalid_argument Thrown if the controller is already registered, if
+         `weight` is zero, or if the controller uses a different port than the others.
+         */
+        void add(HSerialController& controller, unsigned weight = 1);
+
+        /*!
+         \brief Unregisters a controller. Threads waiting in acquire() for it return `false`.
+
+         If the controller is not registered this function does nothing.
+         */
+        void remove(HSerialController& controller);
+
+        /*!
+         \brief Waits until the controller has a slice.
+
+         Returns immediately if the controller already has one.
+
+         \returns `true` if the controller has a slice (and is active), or `false` if the timeout
+         passed first, or if the controller was removed or the scheduler is being destroyed.
+         \throws std::invalid_argument Thrown if the controller is not registered.
+         */
+        bool acquire(HSerialController& controller, const std::chrono::milliseconds& timeout);
+
+        /*!
+         \brief Ends the controller's slice (or its wait for one).
+
+         The controller stays active until another controller gets a slice.
+         */
+        void release(HSerialController& controller);
+
+        /*!
+         \brief Returns the time left in the controller's slice, or zero if it doesn't have one.
+
+         A slice is extended while no other controller is waiting, so this is a lower bound.
+         */
+        std::chrono::microseconds getSliceRemaining(const HSerialController& controller) const;
+
+        /*!
+         \brief Returns the controller's statistics.
+         \throws std::invalid_argument Thrown if the controller is not registered.
+         */
+        HSerialSchedulerStats getStats(const HSerialController& controller) const;
+
+    private:
+
+        typedef std::chrono::steady_clock Clock;
+
+        struct Entry {
+            HSerialController* controller;
+            unsigned weight;
+            bool isWaiting = false;
+            Clock::time_point waitStart;
+            Clock::time_point addTime;
+            HSerialSchedulerStats stats;
+            bool isRemoved = false;
+        };
+
+        const std::chrono::milliseconds quantum;
+
+        /*!
+         \brief [Internal] Protects everything below.
+         */
+        mutable std::mutex mutex;
+
+        /*!
+         \brief [Internal] The port shared by the registered controllers (set by the first add).
+         */
+        std::shared_ptr<HSerialAccess> access;
+
+        /*!
+         \brief [Internal] Notified when the scheduler's thread has something to do.
+         */
+        std::condition_variable workCondition;
+
+        /*!
+         \brief [Internal] Notified when a slice starts, and when an entry is removed.
+         */
+        std::condition_variable sliceCondition;
+
+        /*!
+         \brief [Internal] The registered controllers, in round-robin order.
+         */
+        std::vector<std::shared_ptr<Entry>> entries;
+
+        /*!
+         \brief [Internal] The index of the entry to consider first for the next slice.
+         */
+        size_t nextIndex = 0;
+
+        /*!
+         \brief [Internal] The entry with the current slice, or `nullptr`.
+         */
+        Entry* owner = nullptr;
+        Clock::time_point sliceStart;
+        Clock::time_point sliceEnd;
+
+        /*!
+         \brief [Internal] The entry the scheduler's thread is making active (with the mutex
+         unlocked), or `nullptr`. remove waits for it.
+         */
+        Entry* switchingTo = nullptr;
+
+        bool isStopping = false;
+
+        std::thread worker;
+
+        /*!
+         \brief [Internal] Finds the entry for a controller, or throws std::invalid_argument.
+         Assumes mutex is locked.
+         */
+        Entry& getEntry(const HSerialController& controller) const;
+
+        /*!
+         \brief [Internal] Ends the current slice, recording its length. Assumes mutex is locked.
+         */
+        void endSlice(Clock::time_point now);
+
+        /*!
+         \brief [Internal] Returns the index of the next waiting entry (other than `except`) in
+         round-robin order, or `entries.size()` if there is none. Assumes mutex is locked.
+         */
+        size_t findNextWaiting(const Entry* except) const;
+
+        void runWorker();
+    };
+
+}
+
+#endif /* HSerialScheduler_hpp */
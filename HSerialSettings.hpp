@@ -0,0 +1,110 @@
+//
+//  HSerialSettings.hpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+
+#ifndef HSerialSettings_hpp
+#define HSerialSettings_hpp
+
+#include <chrono>
+#include <cstdint>
+
+#include <serial/serial.h>
+
+
+namespace hserial {
+
+    /*!
+     \brief The configurable properties of a serial port, as one value.
+
+     The defaults are the same as the defaults of HSerial::setSettings.
+
+     \see HSerialController::getSettings
+     */
+    struct HSerialSettings {
+        uint32_t baudrate = 9600;
+        serial::Timeout timeout = serial::Timeout::simpleTimeout(500);
+        serial::bytesize_t bytesize = serial::eightbits;
+        serial::parity_t parity = serial::parity_none;
+        serial::stopbits_t stopbits = serial::stopbits_one;
+        serial::flowcontrol_t flowcontrol = serial::flowcontrol_none;
+
+        bool operator==(const HSerialSettings& other) const {
+            return baudrate == other.baudrate
+                && timeout.inter_byte_timeout == other.timeout.inter_byte_timeout
+                && timeout.read_timeout_constant == other.timeout.read_timeout_constant
+                && timeout.read_timeout_multiplier == other.timeout.read_timeout_multiplier
+                && timeout.write_timeout_constant == other.timeout.write_timeout_constant
+                && timeout.write_timeout_multiplier == other.timeout.write_timeout_multiplier
+                && bytesize == other.bytesize
+                && parity == other.parity
+                && stopbits == other.stopbits
+                && flowcontrol == other.flowcontrol;
+        }
+
+        bool operator!=(const HSerialSettings& other) const {
+            return !(*this == other);
+        }
+    };
+
+    /*!
+     \brief Options for HSerialController::applySettings.
+     */
+    struct HSerialSettingsOptions {
+
+        /*!
+         \brief Wait for queued and buffered output to be transmitted before changing the
+         settings, so the last bytes of the old profile aren't sent with the new one.
+         */
+        bool drainOutput = false;
+
+        /*!
+         \brief Close and reopen the port if more than one line setting (baudrate, bytesize,
+         parity, stopbits or flowcontrol) changes.
+
+         serial::Serial reconfigures an open port once per setter, and does not let the settings
+         be changed together. A closed port is configured once, when it is opened, so reopening
+         applies all the changes with one reconfiguration and no intermediate configurations.
+         The cost is that the port is briefly closed, which may drop DTR and RTS (and reset
+         some devices), and bytes that arrive while the port is closed are lost. With read
+         buffering enabled, reopening also waits (for up to the read timeout) for the read pump
+         to leave serial::Serial.
+         */
+        bool reopenForMultipleChanges = false;
+    };
+
+    /*!
+     \brief Describes a settings change made by HSerialController::applySettings.
+     */
+    struct HSerialSettingsReport {
+
+        /*!
+         \brief The number of times the port was reconfigured. Zero if nothing changed or the
+         port is closed.
+         */
+        unsigned numReconfigurations = 0;
+
+        /*!
+         \brief Whether the port was closed and reopened to apply the changes.
+         */
+        bool didReopen = false;
+
+        /*!
+         \brief How long it took to drain the output (if requested) and prepare to reopen the
+         port (if reopening).
+         */
+        std::chrono::microseconds drainDuration {0};
+
+        /*!
+         \brief How long the switch took, from the start of the reconfiguration to the moment
+         the port was using the new settings. Doesn't include drainDuration.
+         */
+        std::chrono::microseconds switchDuration {0};
+    };
+
+}
+
+#endif /* HSerialSettings_hpp */
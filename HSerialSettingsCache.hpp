@@ -0,0 +1,122 @@
+//
+//  HSerialSettingsCache.hpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+
+#ifndef HSerialSettingsCache_hpp
+#define HSerialSettingsCache_hpp
+
+#include <atomic>
+#include <cstdint>
+
+#include "HSerialSettings.hpp"
+
+
+/// \cond internal_docs
+
+namespace hserial {
+
+    /*!
+     \brief An internal copy of a port's settings that can be read without locking.
+
+     HSerialAccess publishes the port's settings here whenever a setter reconfigures the port, so
+     the getters (and the `onlyIfDifferent` comparisons) don't have to go through serial::Serial
+     and accessSerializingMutex.
+
+     This is a seqlock. The writer makes the sequence number odd, stores the words, then makes
+     it even again. A reader retries if it saw an odd number or if the number changed while it
+     was loading the words. The words are relaxed atomics so that a torn read is a retry, not
+     undefined behavior. Readers never block the writer.
+
+     There must be only one writer at a time (HSerialAccess uses accessSerializingMutex).
+     */
+    class HSerialSettingsCache {
+
+    public:
+
+        HSerialSettingsCache() {
+            store(HSerialSettings());
+        }
+
+        HSerialSettingsCache(const HSerialSettingsCache&) = delete;
+        HSerialSettingsCache& operator=(const HSerialSettingsCache&) = delete;
+
+        HSerialSettings load() const {
+            uint32_t copy[numWords];
+            uint32_t before;
+            uint32_t after;
+            do {
+                before = sequence.load(std::memory_order_acquire);
+                for (size_t i = 0; i < numWords; ++i) {
+                    copy[i] = words[i].load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                after = sequence.load(std::memory_order_relaxed);
+            } while ((before & 1) != 0 || before != after);
+            return unpack(copy);
+        }
+
+        void store(const HSerialSettings& settings) {
+            uint32_t copy[numWords];
+            pack(settings, copy);
+            uint32_t current = sequence.load(std::memory_order_relaxed);
+            sequence.store(current + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for (size_t i = 0; i < numWords; ++i) {
+                words[i].store(copy[i], std::memory_order_relaxed);
+            }
+            sequence.store(current + 2, std::memory_order_release);
+        }
+
+        /*!
+         \brief Returns just the baudrate. A single word can't be torn, so this skips the retry
+         loop.
+         */
+        uint32_t getBaudrate() const {
+            return words[0].load(std::memory_order_acquire);
+        }
+
+    private:
+
+        static const size_t numWords = 10;
+
+        std::atomic<uint32_t> sequence {0};
+        std::atomic<uint32_t> words[numWords];
+
+        static void pack(const HSerialSettings& settings, uint32_t* out) {
+            out[0] = settings.baudrate;
+            out[1] = settings.timeout.inter_byte_timeout;
+            out[2] = settings.timeout.read_timeout_constant;
+            out[3] = settings.timeout.read_timeout_multiplier;
+            out[4] = settings.timeout.write_timeout_constant;
+            out[5] = settings.timeout.write_timeout_multiplier;
+            out[6] = static_cast<uint32_t>(settings.bytesize);
+            out[7] = static_cast<uint32_t>(settings.parity);
+            out[8] = static_cast<uint32_t>(settings.stopbits);
+            out[9] = static_cast<uint32_t>(settings.flowcontrol);
+        }
+
+        static HSerialSettings unpack(const uint32_t* in) {
+            HSerialSettings settings;
+            settings.baudrate = in[0];
+            settings.timeout.inter_byte_timeout = in[1];
+            settings.timeout.read_timeout_constant = in[2];
+            settings.timeout.read_timeout_multiplier = in[3];
+            settings.timeout.write_timeout_constant = in[4];
+            settings.timeout.write_timeout_multiplier = in[5];
+            settings.bytesize = static_cast<serial::bytesize_t>(in[6]);
+            settings.parity = static_cast<serial::parity_t>(in[7]);
+            settings.stopbits = static_cast<serial::stopbits_t>(in[8]);
+            settings.flowcontrol = static_cast<serial::flowcontrol_t>(in[9]);
+            return settings;
+        }
+    };
+
+}
+
+/// \endcond internal_docs
+
+#endif /* HSerialSettingsCache_hpp */
@@ -0,0 +1,421 @@
+//
+//  HSerialSimulatedLink.cpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+
+#include "HSerialSimulatedLink.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+
+namespace hserial {
+
+#pragma mark - HSerialSimulatedTransport
+
+    /*
+     The transport for one end of a link. All the state lives in the link, under its mutex.
+     */
+    class HSerialSimulatedTransport : public HSerialTransport {
+
+    public:
+
+        typedef HSerialSimulatedLink::Clock Clock;
+
+        HSerialSimulatedTransport(std::shared_ptr<HSerialSimulatedLink> link, size_t end) : link(std::move(link)), end(end) {}
+
+        void open() override {
+            std::lock_guard<std::mutex> lock(link->mutex);
+            HSerialSimulatedLink::End& e = self();
+            if (e.isOpen) throw serial::SerialException("Serial port already open.");
+            // Bytes that arrived while closed are dropped before the end opens.
+            link->advance(Clock::now());
+            e.isOpen = true;
+        }
+
+        bool isOpen() const override {
+            std::lock_guard<std::mutex> lock(link->mutex);
+            return link->ends[end].isOpen;
+        }
+
+        void close() override {
+            {
+                std::lock_guard<std::mutex> lock(link->mutex);
+                HSerialSimulatedLink::End& e = self();
+                link->advance(Clock::now());
+                e.isOpen = false;
+                e.rx.clear();
+            }
+            link->condition.notify_all();
+        }
+
+        size_t available() override {
+            std::lock_guard<std::mutex> lock(link->mutex);
+            link->advance(Clock::now());
+            return self().rx.size();
+        }
+
+        bool waitReadable() override {
+            std::unique_lock<std::mutex> lock(link->mutex);
+            HSerialSimulatedLink::End& e = self();
+            Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(e.settings.timeout.read_timeout_constant);
+            while (true) {
+                Clock::time_point now = Clock::now();
+                link->advance(now);
+                if (!e.rx.empty()) return true;
+                if (!e.isOpen || now >= deadline) return false;
+                link->waitForArrival(lock, end, deadline);
+            }
+        }
+
+        void waitByteTimes(size_t count) override {
+            std::chrono::nanoseconds byteTime;
+            {
+                std::lock_guard<std::mutex> lock(link->mutex);
+                const HSerialSettings& s = self().settings;
+                byteTime = characterTime(s.baudrate, s.bytesize, s.parity, s.stopbits);
+            }
+            std::this_thread::sleep_for(byteTime * count);
+        }
+
+        size_t read(uint8_t* buffer, size_t size) override {
+            std::unique_lock<std::mutex> lock(link->mutex);
+            HSerialSimulatedLink::End& e = self();
+            if (!e.isOpen) throw serial::PortNotOpenedException("HSerialSimulatedTransport::read");
+            serial::Timeout timeout = e.settings.timeout;
+            Clock::time_point deadline = readDeadline(timeout, size);
+            // Like serial::Serial, the inter-byte timeout runs from the last byte read.
+            bool hasInterByteTimeout = timeout.inter_byte_timeout != serial::Timeout::max();
+            Clock::time_point interByteDeadline = Clock::time_point::max();
+            size_t count = 0;
+            while (true) {
+                Clock::time_point now = Clock::now();
+                link->advance(now);
+                size_t n = std::min(size - count, e.rx.size());
+                std::copy(e.rx.begin(), e.rx.begin() + n, buffer + count);
+                e.rx.erase(e.rx.begin(), e.rx.begin() + n);
+                e.statistics.bytesRead += n;
+                count += n;
+                if (n > 0 && hasInterByteTimeout) {
+                    interByteDeadline = now + std::chrono::milliseconds(timeout.inter_byte_timeout);
+                }
+                if (count == size || !e.isOpen || now >= deadline || now >= interByteDeadline) {
+                    break;
+                }
+                link->waitForArrival(lock, end, std::min(deadline, interByteDeadline));
+            }
+            return count;
+        }
+
+        size_t write(const uint8_t* data, size_t size) override {
+            std::unique_lock<std::mutex> lock(link->mutex);
+            HSerialSimulatedLink::End& e = self();
+            if (!e.isOpen) throw serial::PortNotOpenedException("HSerialSimulatedTransport::write");
+            Clock::time_point deadline = writeDeadline(e.settings.timeout, size);
+            size_t count = 0;
+            while (count < size && e.isOpen) {
+                Clock::time_point now = Clock::now();
+                link->advance(now);
+                size_t occupancy = link->txOccupancy(end, now);
+                if (occupancy < link->options.txBufferSize) {
+                    size_t n = std::min(size - count, link->options.txBufferSize - occupancy);
+                    link->transmit(end, data + count, n, now);
+                    count += n;
+                    continue;
+                }
+                if (now >= deadline) {
+                    break;
+                }
+                // Space opens up when the oldest byte still being transmitted is done.
+                Clock::time_point spaceTime = e.outgoing[e.outgoing.size() - occupancy].finish;
+                link->condition.wait_until(lock, std::min(spaceTime, deadline));
+            }
+            if (count > 0) {
+                link->condition.notify_all();
+            }
+            return count;
+        }
+
+        using HSerialTransport::read;
+        using HSerialTransport::write;
+
+        void setBaudrate(uint32_t baudrate) override {
+            std::lock_guard<std::mutex> lock(link->mutex);
+            self().settings.baudrate = baudrate;
+        }
+
+        uint32_t getBaudrate() const override {
+            std::lock_guard<std::mutex> lock(link->mutex);
+            return link->ends[end].settings.baudrate;
+        }
+
+        void setTimeout(const serial::Timeout& timeout) override {
+            std::lock_guard<std::mutex> lock(link->mutex);
+            self().settings.timeout = timeout;
+        }
+
+        serial::Timeout getTimeout() const override {
+            std::lock_guard<std::mutex> lock(link->mutex);
+            return link->ends[end].settings.timeout;
+        }
+
+        void setBytesize(serial::bytesize_t bytesize) override {
+            std::lock_guard<std::mutex> lock(link->mutex);
+            self().settings.bytesize = bytesize;
+        }
+
+        serial::bytesize_t getBytesize() const override {
+            std::lock_guard<std::mutex> lock(link->mutex);
+            return link->ends[end].settings.bytesize;
+        }
+
+        void setParity(serial::parity_t parity) override {
+            std::lock_guard<std::mutex> lock(link->mutex);
+            self().settings.parity = parity;
+        }
+
+        serial::parity_t getParity() const override {
+            std::lock_guard<std::mutex> lock(link->mutex);
+            return link->ends[end].settings.parity;
+        }
+
+        void setStopbits(serial::stopbits_t stopbits) override {
+            std::lock_guard<std::mutex> lock(link->mutex);
+            self().settings.stopbits = stopbits;
+        }
+
+        serial::stopbits_t getStopbits() const override {
+            std::lock_guard<std::mutex> lock(link->mutex);
+            return link->ends[end].settings.stopbits;
+        }
+
+        void setFlowcontrol(serial::flowcontrol_t flowcontrol) override {
+            std::lock_guard<std::mutex> lock(link->mutex);
+            self().settings.flowcontrol = flowcontrol;
+        }
+
+        serial::flowcontrol_t getFlowcontrol() const override {
+            std::lock_guard<std::mutex> lock(link->mutex);
+            return link->ends[end].settings.flowcontrol;
+        }
+
+        void flush() override {
+            // Waits for the transmitter to finish, like tcdrain.
+            std::unique_lock<std::mutex> lock(link->mutex);
+            HSerialSimulatedLink::End& e = self();
+            while (Clock::now() < e.lastFinish && e.isOpen) {
+                link->condition.wait_until(lock, e.lastFinish);
+            }
+        }
+
+        void flushInput() override {
+            std::lock_guard<std::mutex> lock(link->mutex);
+            link->advance(Clock::now());
+            self().rx.clear();
+        }
+
+        void flushOutput() override {
+            // Discards the bytes that haven't started transmitting. The byte on the wire (if any)
+            //  still goes out.
+            std::lock_guard<std::mutex> lock(link->mutex);
+            Clock::time_point now = Clock::now();
+            link->advance(now);
+            HSerialSimulatedLink::End& e = self();
+            while (!e.outgoing.empty()) {
+                const HSerialSimulatedLink::InFlight& last = e.outgoing.back();
+                const HSerialSettings& s = e.settings;
+                if (last.finish - characterTime(s.baudrate, s.bytesize, s.parity, s.stopbits) <= now) break;
+                e.outgoing.pop_back();
+            }
+            e.lastFinish = e.outgoing.empty() ? now : std::max(now, e.outgoing.back().finish);
+            e.lastArrival = e.outgoing.empty() ? now : e.outgoing.back().arrival;
+        }
+
+        void sendBreak(int duration) override {
+            std::this_thread::sleep_for(std::chrono::milliseconds(duration));
+        }
+
+        void setBreak(bool level) override {
+            // The break condition isn't modelled.
+            (void)level;
+        }
+
+        void setRTS(bool level) override {
+            setLine(&HSerialSimulatedLink::End::rts, level);
+        }
+
+        void setDTR(bool level) override {
+            setLine(&HSerialSimulatedLink::End::dtr, level);
+        }
+
+        bool waitForChange() override {
+            std::unique_lock<std::mutex> lock(link->mutex);
+            HSerialSimulatedLink::End& e = self();
+            uint64_t startCount = e.lineChangeCount;
+            link->condition.wait(lock, [&e, startCount]() {return e.lineChangeCount != startCount || !e.isOpen;});
+            return e.lineChangeCount != startCount;
+        }
+
+        bool getCTS() override {
+            std::lock_guard<std::mutex> lock(link->mutex);
+            return peer().rts;
+        }
+
+        bool getDSR() override {
+            std::lock_guard<std::mutex> lock(link->mutex);
+            return peer().dtr;
+        }
+
+        bool getRI() override {
+            return false;
+        }
+
+        bool getCD() override {
+            std::lock_guard<std::mutex> lock(link->mutex);
+            return peer().dtr;
+        }
+
+    private:
+
+        std::shared_ptr<HSerialSimulatedLink> link;
+        const size_t end;
+
+        HSerialSimulatedLink::End& self() const {
+            return link->ends[end];
+        }
+
+        HSerialSimulatedLink::End& peer() const {
+            return link->ends[link->peerOf(end)];
+        }
+
+        void setLine(bool HSerialSimulatedLink::End::* line, bool level) {
+            {
+                std::lock_guard<std::mutex> lock(link->mutex);
+                HSerialSimulatedLink::End& e = self();
+                if (e.*line == level) return;
+                e.*line = level;
+                ++peer().lineChangeCount;
+            }
+            link->condition.notify_all();
+        }
+    };
+
+
+#pragma mark - HSerialSimulatedLink
+
+    HSerialSimulatedLink::HSerialSimulatedLink(const HSerialSimulationOptions& options, bool isLoopback) : options(options), isLoopback(isLoopback), random(options.seed) {
+        // write indexes the transmit buffer by its free space, and the jitter distribution needs
+        //  a non-negative upper bound.
+        if (options.txBufferSize == 0) {
+            throw std::invalid_argument("The simulated link's txBufferSize must be at least 1.");
+        }
+        if (options.latency.count() < 0 || options.pollInterval.count() < 0 || options.jitter.count() < 0) {
+            throw std::invalid_argument("The simulated link's latency, pollInterval, and jitter must not be negative.");
+        }
+        for (End& e : ends) {
+            // The same initial timeout as serial::Serial.
+            e.settings.timeout = serial::Timeout();
+        }
+    }
+
+    std::shared_ptr<HSerialSimulatedLink> HSerialSimulatedLink::createPair(const HSerialSimulationOptions& options) {
+        return std::shared_ptr<HSerialSimulatedLink>(new HSerialSimulatedLink(options, false));
+    }
+
+    std::shared_ptr<HSerialSimulatedLink> HSerialSimulatedLink::createLoopback(const HSerialSimulationOptions& options) {
+        return std::shared_ptr<HSerialSimulatedLink>(new HSerialSimulatedLink(options, true));
+    }
+
+    HSerialTransportFactory HSerialSimulatedLink::factory(size_t end) {
+        if (end >= numEnds()) throw std::out_of_range("The simulated link doesn't have that end.");
+        // The transports keep the link alive.
+        std::shared_ptr<HSerialSimulatedLink> self(shared_from_this());
+        return [self, end](const std::string&) {
+            return std::unique_ptr<HSerialTransport>(new HSerialSimulatedTransport(self, end));
+        };
+    }
+
+    HSerialSimulationStatistics HSerialSimulatedLink::getStatistics(size_t end) {
+        if (end >= numEnds()) throw std::out_of_range("The simulated link doesn't have that end.");
+        std::lock_guard<std::mutex> lock(mutex);
+        advance(Clock::now());
+        return ends[end].statistics;
+    }
+
+    void HSerialSimulatedLink::advance(Clock::time_point now) {
+        for (size_t i = 0; i < numEnds(); ++i) {
+            End& sender = ends[i];
+            End& receiver = ends[peerOf(i)];
+            while (!sender.outgoing.empty() && sender.outgoing.front().arrival <= now) {
+                if (!receiver.isOpen) {
+                    ++receiver.statistics.bytesDroppedWhileClosed;
+                } else if (receiver.rx.size() >= options.rxBufferSize) {
+                    ++receiver.statistics.overruns;
+                } else {
+                    receiver.rx.push_back(sender.outgoing.front().byte);
+                    ++receiver.statistics.bytesReceived;
+                }
+                sender.outgoing.pop_front();
+            }
+        }
+    }
+
+    HSerialSimulatedLink::Clock::time_point HSerialSimulatedLink::nextArrival(size_t end) const {
+        Clock::time_point next = Clock::time_point::max();
+        for (size_t i = 0; i < numEnds(); ++i) {
+            if (peerOf(i) == end && !ends[i].outgoing.empty()) {
+                next = std::min(next, ends[i].outgoing.front().arrival);
+            }
+        }
+        return next;
+    }
+
+    size_t HSerialSimulatedLink::txOccupancy(size_t end, Clock::time_point now) const {
+        // Finish times increase, so the bytes still being transmitted are at the back.
+        const std::deque<InFlight>& outgoing = ends[end].outgoing;
+        size_t count = 0;
+        for (auto it = outgoing.rbegin(); it != outgoing.rend() && it->finish > now; ++it) {
+            ++count;
+        }
+        return count;
+    }
+
+    void HSerialSimulatedLink::transmit(size_t end, const uint8_t* data, size_t size, Clock::time_point now) {
+        End& e = ends[end];
+        std::chrono::nanoseconds byteTime = HSerialTransport::characterTime(e.settings.baudrate, e.settings.bytesize, e.settings.parity, e.settings.stopbits);
+        Clock::duration pollInterval = options.pollInterval;
+        std::uniform_int_distribution<int64_t> jitterDistribution(0, options.jitter.count());
+        for (size_t i = 0; i < size; ++i) {
+            InFlight f;
+            f.byte = data[i];
+            f.finish = std::max(now, e.lastFinish) + std::chrono::duration_cast<Clock::duration>(byteTime);
+            f.arrival = f.finish + options.latency;
+            if (pollInterval.count() > 0) {
+                Clock::duration remainder = f.arrival.time_since_epoch() % pollInterval;
+                if (remainder.count() != 0) {
+                    f.arrival += pollInterval - remainder;
+                }
+            }
+            if (options.jitter.count() > 0) {
+                f.arrival += std::chrono::microseconds(jitterDistribution(random));
+            }
+            f.arrival = std::max(f.arrival, e.lastArrival);
+            e.lastFinish = f.finish;
+            e.lastArrival = f.arrival;
+            e.outgoing.push_back(f);
+        }
+        e.statistics.bytesWritten += size;
+    }
+
+    void HSerialSimulatedLink::waitForArrival(std::unique_lock<std::mutex>& lock, size_t end, Clock::time_point deadline) {
+        // Capped so that a distant deadline can't overflow the wait.
+        Clock::time_point wake = std::min(deadline, nextArrival(end));
+        wake = std::min(wake, Clock::now() + std::chrono::hours(1));
+        condition.wait_until(lock, wake);
+    }
+
+}
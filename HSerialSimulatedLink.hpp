@@ -0,0 +1,244 @@
+//
+//  HSerialSimulatedLink.hpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+
+#ifndef HSerialSimulatedLink_hpp
+#define HSerialSimulatedLink_hpp
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+
+#include "HSerialTransport.hpp"
+#include "HSerialSettings.hpp"
+
+
+namespace hserial {
+
+    class HSerialSimulatedTransport; // the transport for one end, defined in the implementation
+
+    /*!
+     \brief Options for HSerialSimulatedLink.
+
+     The defaults model a plain UART with 4 KiB driver buffers. For a typical USB-serial adapter
+     use a `pollInterval` of 1 ms and some `jitter`.
+     */
+    struct HSerialSimulationOptions {
+
+        /*!
+         \brief The receive buffer size of each end, in bytes. A byte that arrives when the buffer
+         is full is lost and counted as an overrun.
+         */
+        size_t rxBufferSize = 4096;
+
+        /*!
+         \brief The transmit buffer size of each end, in bytes. Writing blocks (subject to the
+         write timeout) while the buffer is full. Must be at least 1.
+         */
+        size_t txBufferSize = 4096;
+
+        /*!
+         \brief A fixed delay between a byte leaving the transmitter and becoming readable at the
+         other end. This and the other durations must not be negative.
+         */
+        std::chrono::microseconds latency {0};
+
+        /*!
+         \brief If not zero, bytes become readable only at multiples of this interval, like an
+         adapter that is polled by the USB host (full speed devices are polled every 1 ms).
+         */
+        std::chrono::microseconds pollInterval {0};
+
+        /*!
+         \brief The maximum of a random extra delay added to each delivery. Bytes are never
+         reordered.
+         */
+        std::chrono::microseconds jitter {0};
+
+        /*!
+         \brief The seed for the jitter, so runs are repeatable.
+         */
+        uint32_t seed = 1;
+    };
+
+    /*!
+     \brief Counters for one end of an HSerialSimulatedLink.
+     */
+    struct HSerialSimulationStatistics {
+
+        /*!
+         \brief Bytes accepted by write.
+         */
+        uint64_t bytesWritten = 0;
+
+        /*!
+         \brief Bytes that arrived and were stored in the receive buffer.
+         */
+        uint64_t bytesReceived = 0;
+
+        /*!
+         \brief Bytes returned by read.
+         */
+        uint64_t bytesRead = 0;
+
+        /*!
+         \brief Bytes lost because the receive buffer was full.
+         */
+        uint64_t overruns = 0;
+
+        /*!
+         \brief Bytes lost because the end was closed when they arrived.
+         */
+        uint64_t bytesDroppedWhileClosed = 0;
+    };
+
+    /*!
+     \brief A simulated serial line with realistic timing.
+
+     A link has two ends connected by a null modem cable (TX to RX, RTS to CTS, DTR to DSR and
+     CD), or one end connected to itself like a loopback plug. Each end is used as a port by
+     registering its transport factory:
+
+         std::shared_ptr<HSerialSimulatedLink> link = HSerialSimulatedLink::createPair();
+         HSerialPortsManager& manager = HSerialPortsManager::getInstance();
+         manager.registerTransport("simA", link->factory(0));
+         manager.registerTransport("simB", link->factory(1));
+
+     Unlike a pseudoterminal, the link takes time to move bytes. Each byte occupies the line for
+     one character time, computed from the sending end's baudrate, bytesize, parity, and
+     stopbits (a baudrate of zero means no delay). The ends' settings aren't compared, so
+     mismatched settings don't corrupt data. The receive and transmit buffers are finite (see
+     HSerialSimulationOptions), and delivery can be delayed and batched like a USB adapter's.
+     Flow control is not modeled.
+
+     Time is simulated lazily (there are no threads): the state is brought up to date whenever an
+     end is used.
+     */
+    class HSerialSimulatedLink : public std::enable_shared_from_this<HSerialSimulatedLink> {
+
+    public:
+
+        /*!
+         \brief Creates a link with two ends, 0 and 1.
+         \throws std::invalid_argument if `txBufferSize` is zero, or if `latency`, `pollInterval`,
+         or `jitter` is negative.
+         */
+        static std::shared_ptr<HSerialSimulatedLink> createPair(const HSerialSimulationOptions& options = HSerialSimulationOptions());
+
+        /*!
+         \brief Creates a link with one end, 0, whose output is its own input.
+         \throws std::invalid_argument for the same options as createPair.
+         */
+        static std::shared_ptr<HSerialSimulatedLink> createLoopback(const HSerialSimulationOptions& options = HSerialSimulationOptions());
+
+        /*!
+         \brief Returns a factory for the transport of an end. Only one transport should exist
+         for an end at a time.
+         \throws std::out_of_range if the end doesn't exist.
+         */
+        HSerialTransportFactory factory(size_t end);
+
+        /*!
+         \brief Returns the counters for an end.
+         \throws std::out_of_range if the end doesn't exist.
+         */
+        HSerialSimulationStatistics getStatistics(size_t end);
+
+        HSerialSimulatedLink(const HSerialSimulatedLink&) = delete;
+        HSerialSimulatedLink& operator=(const HSerialSimulatedLink&) = delete;
+
+    private:
+
+        friend class HSerialSimulatedTransport;
+
+        typedef std::chrono::steady_clock Clock;
+
+        HSerialSimulatedLink(const HSerialSimulationOptions& options, bool isLoopback);
+
+        /*!
+         \brief A byte on its way to the other end.
+         */
+        struct InFlight {
+            uint8_t byte;
+            Clock::time_point finish; // when the transmitter is done with it
+            Clock::time_point arrival; // when it becomes readable
+        };
+
+        struct End {
+            bool isOpen = false;
+            HSerialSettings settings;
+            std::deque<InFlight> outgoing;
+            Clock::time_point lastFinish;
+            Clock::time_point lastArrival;
+            std::deque<uint8_t> rx;
+            bool rts = false;
+            bool dtr = false;
+            uint64_t lineChangeCount = 0; // incremented when this end's CTS, DSR, or CD changes
+            HSerialSimulationStatistics statistics;
+        };
+
+        const HSerialSimulationOptions options;
+        const bool isLoopback;
+
+        /*!
+         \brief Protects everything below.
+         */
+        std::mutex mutex;
+
+        /*!
+         \brief Notified whenever the state changes in a way a waiting end might care about.
+         Waits also time out at the next arrival, since arrivals don't notify.
+         */
+        std::condition_variable condition;
+
+        End ends[2];
+
+        std::mt19937 random;
+
+        size_t numEnds() const {
+            return isLoopback ? 1 : 2;
+        }
+
+        size_t peerOf(size_t end) const {
+            return isLoopback ? end : 1 - end;
+        }
+
+        // These assume mutex is locked.
+
+        /*!
+         \brief Delivers the bytes that have arrived by `now`.
+         */
+        void advance(Clock::time_point now);
+
+        /*!
+         \brief Returns when the next byte will arrive at `end` (or the max time point).
+         */
+        Clock::time_point nextArrival(size_t end) const;
+
+        /*!
+         \brief Returns the number of bytes `end` is still transmitting at `now`.
+         */
+        size_t txOccupancy(size_t end, Clock::time_point now) const;
+
+        /*!
+         \brief Queues bytes for transmission from `end`.
+         */
+        void transmit(size_t end, const uint8_t* data, size_t size, Clock::time_point now);
+
+        /*!
+         \brief Waits until `deadline` or the next arrival at `end`, whichever comes first, or
+         until notified.
+         */
+        void waitForArrival(std::unique_lock<std::mutex>& lock, size_t end, Clock::time_point deadline);
+    };
+
+}
+
+#endif /* HSerialSimulatedLink_hpp */
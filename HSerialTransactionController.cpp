@@ -0,0 +1,243 @@
+//
+//  HSerialTransactionController.cpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+
+#include "HSerialTransactionController.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "HSerialExceptions.hpp"
+
+
+namespace hserial {
+
+    namespace {
+
+        // A finished transaction, completed after the mutex is unlocked.
+        struct Completion {
+            HSerialTransactionCallback callback;
+            HSerialFrame response;
+            std::exception_ptr error;
+        };
+
+        void complete(std::vector<Completion>& completions) {
+            for (Completion& completion : completions) {
+                // A callback that throws would take down the worker, so the exception is dropped.
+                try {
+                    completion.callback(std::move(completion.response), completion.error);
+                } catch (...) {}
+            }
+            completions.clear();
+        }
+    }
+
+
+#pragma mark - Construction/Destruction
+
+    HSerialTransactionController::HSerialTransactionController(const std::string& deviceName, HSerialTagExtractor _tagExtractor, const HSerialTransactionOptions& options)
+    : HSerialTransactionController(HSerialPort(deviceName), std::move(_tagExtractor), options) {}
+
+    HSerialTransactionController::HSerialTransactionController(HSerialPort port, HSerialTagExtractor _tagExtractor, const HSerialTransactionOptions& options)
+    : HSerialController(port), tagExtractor(std::move(_tagExtractor)), window(std::max<size_t>(options.window, 1)),
+    readFramer(*this, options.codec, options.maxFrameSize), writeFramer(*this, options.codec, options.maxFrameSize) {
+        if (!tagExtractor) {
+            throw std::invalid_argument("A tag extractor is required.");
+        }
+        worker = std::thread(&HSerialTransactionController::runWorker, this);
+    }
+
+    HSerialTransactionController::~HSerialTransactionController() {
+        std::vector<Completion> completions;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            isStopping = true;
+            std::exception_ptr error = std::make_exception_ptr(std::runtime_error("The transaction controller was destroyed."));
+            for (auto& entry : outstanding) {
+                completions.push_back(Completion {std::move(entry.second.callback), HSerialFrame(), error});
+            }
+            outstanding.clear();
+        }
+        workCondition.notify_all();
+        slotCondition.notify_all();
+        worker.join();
+        complete(completions);
+        try {
+            removeFromAccess();
+        } catch (...) {
+            close();
+            removeFromAccess();
+        }
+    }
+
+    std::string HSerialTransactionController::getControllerType() const {
+        return "HSerialTransactionController";
+    }
+
+
+#pragma mark - Transactions
+
+    std::future<HSerialFrame> HSerialTransactionController::transact(uint64_t tag, const HSerialByteView& request, const std::chrono::milliseconds& timeout) {
+        std::shared_ptr<std::promise<HSerialFrame>> promise = std::make_shared<std::promise<HSerialFrame>>();
+        std::future<HSerialFrame> future = promise->get_future();
+        submit(tag, request, timeout, [promise](HSerialFrame&& response, std::exception_ptr error) {
+            if (error) {
+                promise->set_exception(error);
+            } else {
+                promise->set_value(std::move(response));
+            }
+        });
+        return future;
+    }
+
+    void HSerialTransactionController::transact(uint64_t tag, const HSerialByteView& request, const std::chrono::milliseconds& timeout, HSerialTransactionCallback callback) {
+        if (!callback) {
+            throw std::invalid_argument("The callback is empty.");
+        }
+        submit(tag, request, timeout, std::move(callback));
+    }
+
+    void HSerialTransactionController::submit(uint64_t tag, const HSerialByteView& request, const std::chrono::milliseconds& timeout, HSerialTransactionCallback callback) {
+        Clock::time_point deadline = Clock::now() + timeout;
+        uint64_t serial;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            auto hasSlot = [this]() {
+                return outstanding.size() < window || isStopping;
+            };
+            if (!hasSlot()) {
+                // The worker can't free a slot while it is running this callback.
+                if (std::this_thread::get_id() == worker.get_id()
+                    || !slotCondition.wait_until(lock, deadline, hasSlot)) {
+                    throw TransactionTimeout("No transaction slot became free before the timeout.");
+                }
+            }
+            if (isStopping) {
+                throw std::logic_error("The transaction controller is being destroyed.");
+            }
+            if (outstanding.count(tag) != 0) {
+                throw std::invalid_argument("The tag belongs to an outstanding transaction.");
+            }
+            // Registered before writing, so a quick response isn't missed.
+            serial = nextSerial++;
+            outstanding.emplace(tag, Transaction {serial, deadline, std::move(callback)});
+        }
+        workCondition.notify_one();
+
+        try {
+            std::lock_guard<std::mutex> lock(writeMutex);
+            if (!writeFramer.writeFrame(request)) {
+                throw TransactionTimeout("The request could not be written before the write timeout.");
+            }
+        } catch (...) {
+            {
+                // Unless the worker already timed it out (and the tag was reused).
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = outstanding.find(tag);
+                if (it != outstanding.end() && it->second.serial == serial) {
+                    outstanding.erase(it);
+                }
+            }
+            slotCondition.notify_all();
+            throw;
+        }
+    }
+
+    size_t HSerialTransactionController::getNumOutstanding() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return outstanding.size();
+    }
+
+    uint64_t HSerialTransactionController::getNumUnmatchedFrames() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return numUnmatchedFrames;
+    }
+
+    uint64_t HSerialTransactionController::getNumDroppedFrames() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return numDroppedFrames;
+    }
+
+
+#pragma mark - Transition Callbacks
+
+    void HSerialTransactionController::willMakeInactive() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!outstanding.empty()) {
+                throw ControllerRefuses(*this, "Transactions are outstanding.");
+            }
+        }
+        HSerialController::willMakeInactive();
+    }
+
+
+#pragma mark - Worker
+
+    void HSerialTransactionController::runWorker() {
+        std::vector<Completion> completions;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            workCondition.wait(lock, [this]() {
+                return isStopping || !outstanding.empty();
+            });
+            if (isStopping) {
+                break;
+            }
+            lock.unlock();
+
+            HSerialFrame frame;
+            std::exception_ptr error;
+            bool hasTag = false;
+            uint64_t tag = 0;
+            try {
+                frame = readFramer.readFrame();
+                if (frame) {
+                    hasTag = tagExtractor(frame.view(), tag);
+                }
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            lock.lock();
+            numDroppedFrames = readFramer.getNumDroppedFrames();
+            if (error) {
+                for (auto& entry : outstanding) {
+                    completions.push_back(Completion {std::move(entry.second.callback), HSerialFrame(), error});
+                }
+                outstanding.clear();
+            } else if (frame) {
+                auto it = hasTag ? outstanding.find(tag) : outstanding.end();
+                if (it != outstanding.end()) {
+                    completions.push_back(Completion {std::move(it->second.callback), std::move(frame), nullptr});
+                    outstanding.erase(it);
+                } else {
+                    numUnmatchedFrames += 1;
+                }
+            }
+            Clock::time_point now = Clock::now();
+            for (auto it = outstanding.begin(); it != outstanding.end(); ) {
+                if (it->second.deadline <= now) {
+                    std::exception_ptr timeout = std::make_exception_ptr(TransactionTimeout("The response did not arrive before the timeout."));
+                    completions.push_back(Completion {std::move(it->second.callback), HSerialFrame(), timeout});
+                    it = outstanding.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+
+            if (!completions.empty()) {
+                slotCondition.notify_all();
+                lock.unlock();
+                complete(completions);
+                lock.lock();
+            }
+        }
+    }
+
+}
@@ -0,0 +1,277 @@
+//
+//  HSerialTransactionController.hpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+
+#ifndef HSerialTransactionController_hpp
+#define HSerialTransactionController_hpp
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "HSerialController.hpp"
+#include "HSerialFramer.hpp"
+
+
+namespace hserial {
+
+    /*!
+     \brief Finds the tag of a received frame.
+
+     Returns `false` if the frame isn't a response (it is then ignored).
+     */
+    typedef std::function<bool(const HSerialByteView& frame, uint64_t& tag)> HSerialTagExtractor;
+
+    /*!
+     \brief Called when a transaction completes. Exactly one of `response` (which is non-empty)
+     and `error` is set.
+     */
+    typedef std::function<void(HSerialFrame&& response, std::exception_ptr error)> HSerialTransactionCallback;
+
+    /*!
+     \brief Options for HSerialTransactionController.
+     */
+    struct HSerialTransactionOptions {
+
+        /*!
+         \brief The most transactions that may be outstanding at once. Submitting another waits
+         for one to complete.
+         */
+        size_t window = 8;
+
+        /*!
+         \brief The framing used for requests and responses.
+         */
+        HSerialFramer::Codec codec = HSerialFramer::Codec::cobs;
+
+        /*!
+         \brief The largest response frame that will be accepted.
+         */
+        size_t maxFrameSize = 4096;
+    };
+
+    /*!
+     \brief A controller that keeps several tagged request/response transactions in flight.
+
+     With write() followed by read() only one request is on the line at a time, so the link sits
+     idle for each device's turnaround time. This controller writes requests as they are
+     submitted, up to a window of outstanding transactions, and matches each response to its
+     request by tag, so the turnaround times overlap.
+
+     Requests and responses are framed with HSerialFramer. The tag of a request is given when it
+     is submitted, and the tag of a response is found by the tag extractor passed to the
+     constructor. Received frames that have no tag, or whose tag isn't outstanding, are counted
+     and ignored (see getNumUnmatchedFrames).
+
+         HSerialTransactionController device("/dev/ttyUSB0", [](const HSerialByteView& frame, uint64_t& tag) {
+             if (frame.size < 1) return false;
+             tag = frame.data[0];
+             return true;
+         });
+         device.makeActive();
+         device.open();
+         std::future<HSerialFrame> reply = device.transact(7, request, std::chrono::milliseconds(100));
+
+     Requests are written by the submitting thread, so write errors are thrown from transact.
+     Responses are read by a worker thread owned by the controller, which reads only while
+     transactions are outstanding. The worker completes futures and calls callbacks. A read
+     error fails every outstanding transaction.
+
+     Deadlines are checked each time a read returns, so they are enforced to within the port's
+     read timeout. A short read timeout (e.g. 10 ms) is recommended, as is read buffering (see
+     enableReadBuffering), which lets transitions interrupt the worker's reads.
+
+     All functions are thread-safe.
+     */
+    class HSerialTransactionController : public HSerialController {
+
+    public:
+
+        HSerialTransactionController(const std::string& deviceName, HSerialTagExtractor tagExtractor, const HSerialTransactionOptions& options = HSerialTransactionOptions());
+
+        HSerialTransactionController(HSerialPort port, HSerialTagExtractor tagExtractor, const HSerialTransactionOptions& options = HSerialTransactionOptions());
+
+        /*!
+         \brief Stops the worker and fails the outstanding transactions with
+         std::runtime_error.
+         */
+        virtual ~HSerialTransactionController();
+
+        /*!
+         \brief Returns `"HSerialTransactionController"`.
+         */
+        virtual std::string getControllerType() const;
+
+#pragma mark - Transactions
+
+        /*!
+         \name Transactions
+         */
+        /// \{
+
+        /*!
+         \brief Writes a request and returns a future for its response.
+
+         If the window is full this function waits for a slot, for at most `timeout`. The
+         timeout also applies to the response: if it hasn't arrived `timeout` after this function
+         was called, the future fails with TransactionTimeout.
+
+         \param tag The tag that the response will have. It must not belong to an outstanding
+         transaction.
+         \throws hserial::TransactionTimeout Thrown if no slot became free in time, or if the
+         request couldn't be written before the write timeout.
+         \throws std::invalid_argument Thrown if `tag` is already outstanding.
+         \throws (the exceptions of HSerialController::write)
+         */
+        std::future<HSerialFrame> transact(uint64_t tag, const HSerialByteView& request, const std::chrono::milliseconds& timeout);
+
+        /*!
+         \brief Writes a request and calls `callback` when its response arrives.
+
+         The callback is called on the worker thread, so it should return quickly. It may submit
+         another transaction, but if the window is full that submission fails immediately with
+         TransactionTimeout, since no slot can free up while the worker is busy.
+
+         \see transact(uint64_t tag, const HSerialByteView& request, const std::chrono::milliseconds& timeout)
+         */
+        void transact(uint64_t tag, const HSerialByteView& request, const std::chrono::milliseconds& timeout, HSerialTransactionCallback callback);
+
+        /*!
+         \brief Returns the number of outstanding transactions.
+         */
+        size_t getNumOutstanding() const;
+
+        /*!
+         \brief Returns the number of received frames that didn't match an outstanding
+         transaction (including late responses to transactions that timed out).
+         */
+        uint64_t getNumUnmatchedFrames() const;
+
+        /*!
+         \brief Returns the number of received frames dropped by the framer because they were
+         malformed or too long.
+         */
+        uint64_t getNumDroppedFrames() const;
+
+        /// \} /Transactions
+
+
+#pragma mark - Access Management
+
+        /*!
+         \name Access Management
+
+         The controller refuses to become inactive while transactions are outstanding.
+         */
+        /// \{
+
+        using HSerialController::isActive;
+        using HSerialController::makeActive;
+        using HSerialController::tryMakeActive;
+        using HSerialController::makeActiveFor;
+        using HSerialController::makeInactive;
+        using HSerialController::isTransitionRequested;
+        using HSerialController::yieldIfRequested;
+
+        /// \} /Access Management
+
+
+#pragma mark - Port Functions
+
+        /*!
+         \name Port Functions
+
+         These access functions may throw NotActiveController. Reading and writing are done by
+         the transaction functions.
+         */
+        /// \{
+
+        using HSerialController::open;
+        using HSerialController::ensureOpen;
+        using HSerialController::isOpen;
+        using HSerialController::close;
+        using HSerialController::applySettings;
+        using HSerialController::getSettings;
+        using HSerialController::setBaudrate;
+        using HSerialController::getBaudrate;
+        using HSerialController::setTimeout;
+        using HSerialController::getTimeout;
+        using HSerialController::enableReadBuffering;
+        using HSerialController::disableReadBuffering;
+        using HSerialController::isReadBufferingEnabled;
+        using HSerialController::flushInput;
+
+        /// \} /Port Functions
+
+
+    protected:
+
+        /*!
+         \brief Refuses while transactions are outstanding, then does the default.
+         */
+        virtual void willMakeInactive();
+
+    private:
+
+        typedef std::chrono::steady_clock Clock;
+
+        struct Transaction {
+            uint64_t serial; // distinguishes reuses of a tag
+            Clock::time_point deadline;
+            HSerialTransactionCallback callback;
+        };
+
+        const HSerialTagExtractor tagExtractor;
+        const size_t window;
+
+        /*!
+         \brief Used only by the worker.
+         */
+        HSerialFramer readFramer;
+
+        /*!
+         \brief Used by submitters with writeMutex locked.
+         */
+        HSerialFramer writeFramer;
+        std::mutex writeMutex;
+
+        /*!
+         \brief Protects everything below.
+         */
+        mutable std::mutex mutex;
+
+        /*!
+         \brief Notified when the worker has something to do.
+         */
+        std::condition_variable workCondition;
+
+        /*!
+         \brief Notified when transactions complete (freeing slots).
+         */
+        std::condition_variable slotCondition;
+
+        std::unordered_map<uint64_t, Transaction> outstanding;
+        uint64_t nextSerial = 0;
+        uint64_t numUnmatchedFrames = 0;
+        uint64_t numDroppedFrames = 0; // copied from readFramer by the worker
+        bool isStopping = false;
+
+        std::thread worker;
+
+        void submit(uint64_t tag, const HSerialByteView& request, const std::chrono::milliseconds& timeout, HSerialTransactionCallback callback);
+
+        void runWorker();
+    };
+
+}
+
+#endif /* HSerialTransactionController_hpp */
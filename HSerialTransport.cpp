@@ -0,0 +1,207 @@
+//
+//  HSerialTransport.cpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+
+#include "HSerialTransport.hpp"
+
+
+namespace hserial {
+
+#pragma mark - HSerialTransport
+
+    size_t HSerialTransport::read(std::vector<uint8_t>& buffer, size_t size) {
+        size_t oldSize = buffer.size();
+        buffer.resize(oldSize + size);
+        size_t count = read(buffer.data() + oldSize, size);
+        buffer.resize(oldSize + count);
+        return count;
+    }
+
+    size_t HSerialTransport::read(std::string& buffer, size_t size) {
+        size_t oldSize = buffer.size();
+        buffer.resize(oldSize + size);
+        size_t count = read(reinterpret_cast<uint8_t*>(&buffer[0]) + oldSize, size);
+        buffer.resize(oldSize + count);
+        return count;
+    }
+
+    std::string HSerialTransport::read(size_t size) {
+        std::string buffer;
+        read(buffer, size);
+        return buffer;
+    }
+
+    size_t HSerialTransport::write(const std::vector<uint8_t>& data) {
+        return write(data.data(), data.size());
+    }
+
+    size_t HSerialTransport::write(const std::string& data) {
+        return write(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    }
+
+    std::chrono::steady_clock::time_point HSerialTransport::readDeadline(const serial::Timeout& timeout, size_t size) {
+        uint64_t ms = uint64_t(timeout.read_timeout_constant) + uint64_t(timeout.read_timeout_multiplier) * size;
+        return std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+    }
+
+    std::chrono::steady_clock::time_point HSerialTransport::writeDeadline(const serial::Timeout& timeout, size_t size) {
+        uint64_t ms = uint64_t(timeout.write_timeout_constant) + uint64_t(timeout.write_timeout_multiplier) * size;
+        return std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+    }
+
+    std::chrono::nanoseconds HSerialTransport::characterTime(uint32_t baudrate, serial::bytesize_t bytesize, serial::parity_t parity, serial::stopbits_t stopbits) {
+        if (baudrate == 0) {
+            return std::chrono::nanoseconds(0);
+        }
+        // In half bits, so that 1.5 stop bits is exact.
+        uint64_t halfBits = 2 * (1 + uint64_t(bytesize));
+        if (parity != serial::parity_none) halfBits += 2;
+        if (stopbits == serial::stopbits_one) halfBits += 2;
+        else if (stopbits == serial::stopbits_two) halfBits += 4;
+        else halfBits += 3;
+        return std::chrono::nanoseconds(halfBits * 500000000 / baudrate);
+    }
+
+
+#pragma mark - HSerialSerialTransport
+
+    HSerialSerialTransport::HSerialSerialTransport(const std::string& deviceName) {
+        // Setting the port here (instead of passing it to the serial object's constructor) means
+        //  that the port stays closed until explicitly opened.
+        serial.setPort(deviceName);
+    }
+
+    void HSerialSerialTransport::open() {
+        serial.open();
+    }
+
+    bool HSerialSerialTransport::isOpen() const {
+        return serial.isOpen();
+    }
+
+    void HSerialSerialTransport::close() {
+        serial.close();
+    }
+
+    size_t HSerialSerialTransport::available() {
+        return serial.available();
+    }
+
+    bool HSerialSerialTransport::waitReadable() {
+        return serial.waitReadable();
+    }
+
+    void HSerialSerialTransport::waitByteTimes(size_t count) {
+        serial.waitByteTimes(count);
+    }
+
+    size_t HSerialSerialTransport::read(uint8_t* buffer, size_t size) {
+        return serial.read(buffer, size);
+    }
+
+    size_t HSerialSerialTransport::write(const uint8_t* data, size_t size) {
+        return serial.write(data, size);
+    }
+
+    void HSerialSerialTransport::setBaudrate(uint32_t baudrate) {
+        serial.setBaudrate(baudrate);
+    }
+
+    uint32_t HSerialSerialTransport::getBaudrate() const {
+        return serial.getBaudrate();
+    }
+
+    void HSerialSerialTransport::setTimeout(const serial::Timeout& timeout) {
+        serial::Timeout copy = timeout;
+        serial.setTimeout(copy);
+    }
+
+    serial::Timeout HSerialSerialTransport::getTimeout() const {
+        return serial.getTimeout();
+    }
+
+    void HSerialSerialTransport::setBytesize(serial::bytesize_t bytesize) {
+        serial.setBytesize(bytesize);
+    }
+
+    serial::bytesize_t HSerialSerialTransport::getBytesize() const {
+        return serial.getBytesize();
+    }
+
+    void HSerialSerialTransport::setParity(serial::parity_t parity) {
+        serial.setParity(parity);
+    }
+
+    serial::parity_t HSerialSerialTransport::getParity() const {
+        return serial.getParity();
+    }
+
+    void HSerialSerialTransport::setStopbits(serial::stopbits_t stopbits) {
+        serial.setStopbits(stopbits);
+    }
+
+    serial::stopbits_t HSerialSerialTransport::getStopbits() const {
+        return serial.getStopbits();
+    }
+
+    void HSerialSerialTransport::setFlowcontrol(serial::flowcontrol_t flowcontrol) {
+        serial.setFlowcontrol(flowcontrol);
+    }
+
+    serial::flowcontrol_t HSerialSerialTransport::getFlowcontrol() const {
+        return serial.getFlowcontrol();
+    }
+
+    void HSerialSerialTransport::flush() {
+        serial.flush();
+    }
+
+    void HSerialSerialTransport::flushInput() {
+        serial.flushInput();
+    }
+
+    void HSerialSerialTransport::flushOutput() {
+        serial.flushOutput();
+    }
+
+    void HSerialSerialTransport::sendBreak(int duration) {
+        serial.sendBreak(duration);
+    }
+
+    void HSerialSerialTransport::setBreak(bool level) {
+        serial.setBreak(level);
+    }
+
+    void HSerialSerialTransport::setRTS(bool level) {
+        serial.setRTS(level);
+    }
+
+    void HSerialSerialTransport::setDTR(bool level) {
+        serial.setDTR(level);
+    }
+
+    bool HSerialSerialTransport::waitForChange() {
+        return serial.waitForChange();
+    }
+
+    bool HSerialSerialTransport::getCTS() {
+        return serial.getCTS();
+    }
+
+    bool HSerialSerialTransport::getDSR() {
+        return serial.getDSR();
+    }
+
+    bool HSerialSerialTransport::getRI() {
+        return serial.getRI();
+    }
+
+    bool HSerialSerialTransport::getCD() {
+        return serial.getCD();
+    }
+
+}
@@ -0,0 +1,221 @@
+//
+//  HSerialTransport.hpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+
+#ifndef HSerialTransport_hpp
+#define HSerialTransport_hpp
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <serial/serial.h>
+
+
+namespace hserial {
+
+    /*!
+     \brief The byte stream behind a port.
+
+     HSerialAccess (and so every controller for a port) uses the port through a transport. The
+     default transport is HSerialSerialTransport, which uses `serial::Serial`. Other transports
+     let the access machinery (arbitration, transitions, buffering) sit in front of something
+     that isn't a serial port, such as an in-memory loopback (HSerialLoopbackTransport) or a
+     pseudoterminal (HSerialPtyTransport). A transport is installed for a device name with
+     HSerialPortsManager::registerTransport.
+
+     The functions have the same semantics as the `serial::Serial` functions of the same names,
+     including the timeout rules and the exceptions thrown. In particular, reading and writing
+     functions may be called concurrently with each other and with the waiting functions, and
+     `read` and `write` throw `serial::PortNotOpenedException` if the transport is closed.
+     HSerialAccess serializes the remaining functions.
+
+     A transport is created when the access object for its port is created, and is destroyed
+     with it (when the port's last controller is destroyed).
+     */
+    class HSerialTransport {
+
+    public:
+
+        virtual ~HSerialTransport() {}
+
+        /// \name Opening and Closing
+        /// \{
+
+        virtual void open() = 0;
+        virtual bool isOpen() const = 0;
+        virtual void close() = 0;
+
+        /// \}
+
+        /// \name Reading, Writing, and Waiting
+        /// \{
+
+        virtual size_t available() = 0;
+        virtual bool waitReadable() = 0;
+        virtual void waitByteTimes(size_t count) = 0;
+        virtual size_t read(uint8_t* buffer, size_t size) = 0;
+        virtual size_t write(const uint8_t* data, size_t size) = 0;
+
+        /*!
+         \brief Appends up to `size` bytes to `buffer`.
+         */
+        size_t read(std::vector<uint8_t>& buffer, size_t size);
+
+        /*!
+         \brief Appends up to `size` bytes to `buffer`.
+         */
+        size_t read(std::string& buffer, size_t size);
+
+        std::string read(size_t size);
+        size_t write(const std::vector<uint8_t>& data);
+        size_t write(const std::string& data);
+
+        /// \}
+
+        /// \name Settings
+        /// \{
+
+        virtual void setBaudrate(uint32_t baudrate) = 0;
+        virtual uint32_t getBaudrate() const = 0;
+        virtual void setTimeout(const serial::Timeout& timeout) = 0;
+        virtual serial::Timeout getTimeout() const = 0;
+        virtual void setBytesize(serial::bytesize_t bytesize) = 0;
+        virtual serial::bytesize_t getBytesize() const = 0;
+        virtual void setParity(serial::parity_t parity) = 0;
+        virtual serial::parity_t getParity() const = 0;
+        virtual void setStopbits(serial::stopbits_t stopbits) = 0;
+        virtual serial::stopbits_t getStopbits() const = 0;
+        virtual void setFlowcontrol(serial::flowcontrol_t flowcontrol) = 0;
+        virtual serial::flowcontrol_t getFlowcontrol() const = 0;
+
+        /// \}
+
+        /// \name Buffers and Lines
+        /// \{
+
+        virtual void flush() = 0;
+        virtual void flushInput() = 0;
+        virtual void flushOutput() = 0;
+        virtual void sendBreak(int duration) = 0;
+        virtual void setBreak(bool level) = 0;
+        virtual void setRTS(bool level) = 0;
+        virtual void setDTR(bool level) = 0;
+        virtual bool waitForChange() = 0;
+        virtual bool getCTS() = 0;
+        virtual bool getDSR() = 0;
+        virtual bool getRI() = 0;
+        virtual bool getCD() = 0;
+
+        /// \}
+
+        /// \name Readiness
+        /// \{
+
+        /*!
+         \brief Returns a descriptor that polls readable (`POLLIN`) whenever `read` would return
+         bytes without waiting, or -1 if the transport has none.
+
+         The descriptor belongs to the transport and must not be read, written, or closed by the
+         caller; it is only for `poll`, `select`, or `epoll`. It stays the same for the life of the
+         transport, including while the transport is closed, when it may poll readable even though
+         there is nothing to read (open() discards those bytes).
+
+         HSerialReactor watches this descriptor instead of relying on a read pump thread. The
+         default returns -1.
+         */
+        virtual int getNativeHandle() const { return -1; }
+
+        /// \}
+
+        /*!
+         \brief Returns the time it takes to transmit one character with the given settings
+         (start bit, data bits, parity bit, and stop bits).
+         */
+        static std::chrono::nanoseconds characterTime(uint32_t baudrate, serial::bytesize_t bytesize, serial::parity_t parity, serial::stopbits_t stopbits);
+
+    protected:
+
+        /*!
+         \brief Returns the deadline for reading `size` bytes, following the `serial::Serial`
+         rule: the read timeout constant plus the multiplier for each byte.
+         */
+        static std::chrono::steady_clock::time_point readDeadline(const serial::Timeout& timeout, size_t size);
+
+        /*!
+         \brief Returns the deadline for writing `size` bytes (see readDeadline).
+         */
+        static std::chrono::steady_clock::time_point writeDeadline(const serial::Timeout& timeout, size_t size);
+    };
+
+    /*!
+     \brief Creates the transport for a device name.
+     \see HSerialPortsManager::registerTransport
+     */
+    typedef std::function<std::unique_ptr<HSerialTransport>(const std::string& deviceName)> HSerialTransportFactory;
+
+    /*!
+     \brief The default transport, which uses `serial::Serial`.
+
+     The port is not opened until open() is called. `serial::Serial` doesn't expose its file
+     descriptor, so getNativeHandle returns -1 and readiness comes from the read pump.
+     */
+    class HSerialSerialTransport : public HSerialTransport {
+
+    public:
+
+        explicit HSerialSerialTransport(const std::string& deviceName);
+
+        void open() override;
+        bool isOpen() const override;
+        void close() override;
+
+        size_t available() override;
+        bool waitReadable() override;
+        void waitByteTimes(size_t count) override;
+        size_t read(uint8_t* buffer, size_t size) override;
+        size_t write(const uint8_t* data, size_t size) override;
+
+        using HSerialTransport::read;
+        using HSerialTransport::write;
+
+        void setBaudrate(uint32_t baudrate) override;
+        uint32_t getBaudrate() const override;
+        void setTimeout(const serial::Timeout& timeout) override;
+        serial::Timeout getTimeout() const override;
+        void setBytesize(serial::bytesize_t bytesize) override;
+        serial::bytesize_t getBytesize() const override;
+        void setParity(serial::parity_t parity) override;
+        serial::parity_t getParity() const override;
+        void setStopbits(serial::stopbits_t stopbits) override;
+        serial::stopbits_t getStopbits() const override;
+        void setFlowcontrol(serial::flowcontrol_t flowcontrol) override;
+        serial::flowcontrol_t getFlowcontrol() const override;
+
+        void flush() override;
+        void flushInput() override;
+        void flushOutput() override;
+        void sendBreak(int duration) override;
+        void setBreak(bool level) override;
+        void setRTS(bool level) override;
+        void setDTR(bool level) override;
+        bool waitForChange() override;
+        bool getCTS() override;
+        bool getDSR() override;
+        bool getRI() override;
+        bool getCD() override;
+
+    private:
+
+        serial::Serial serial;
+    };
+
+}
+
+#endif /* HSerialTransport_hpp */
@@ -0,0 +1,80 @@
+//
+//  FramerBenchmark.cpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+//  Measures the encode and decode throughput of the COBS and SLIP codecs used by HSerialFramer,
+//  for a few frame sizes, with random data and with data that is all delimiters (the worst
+//  case for SLIP, and a short run per code byte for COBS). Build from this directory with, e.g.:
+//
+//      g++ -std=c++11 -O2 -pthread -I.. ../*.cpp FramerBenchmark.cpp -lserial -o FramerBenchmark
+//
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "HSerialFramer.hpp"
+
+using namespace hserial;
+
+namespace {
+
+    const size_t totalBytes = 256 << 20; // decoded bytes per measurement
+
+    typedef size_t (*CodecFunction)(const uint8_t* in, size_t size, uint8_t* out);
+
+    struct Codec {
+        const char* name;
+        CodecFunction encode;
+        CodecFunction decode;
+        size_t (*maxEncodedSize)(size_t size);
+        uint8_t delimiter;
+    };
+
+    // Returns MB/s of decoded data.
+    double measure(CodecFunction function, const std::vector<uint8_t>& in, size_t size, std::vector<uint8_t>& out) {
+        size_t iterations = totalBytes / size;
+        volatile size_t sink = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            sink = sink + function(in.data(), in.size(), out.data());
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return double(iterations * size) / seconds / 1e6;
+    }
+
+    void run(const Codec& codec, size_t size, bool isWorstCase) {
+        std::vector<uint8_t> data(size);
+        std::mt19937 random(1);
+        for (uint8_t& byte : data) {
+            byte = isWorstCase ? codec.delimiter : uint8_t(random());
+        }
+        // The encoder may write up to maxEncodedSize bytes.
+        std::vector<uint8_t> encodeBuffer(codec.maxEncodedSize(size));
+        std::vector<uint8_t> encoded(encodeBuffer.begin(), encodeBuffer.begin() + codec.encode(data.data(), size, encodeBuffer.data()));
+        std::vector<uint8_t> decoded(size);
+
+        double encodeRate = measure(codec.encode, data, size, encodeBuffer);
+        double decodeRate = measure(codec.decode, encoded, size, decoded);
+        std::printf("%-4s %6zu bytes %-10s encode %8.1f MB/s   decode %8.1f MB/s\n",
+                    codec.name, size, isWorstCase ? "delimiters" : "random", encodeRate, decodeRate);
+    }
+}
+
+int main() {
+    const Codec codecs[] = {
+        {"COBS", cobs::encode, cobs::decode, cobs::maxEncodedSize, 0},
+        {"SLIP", slip::encode, slip::decode, slip::maxEncodedSize, slip::END}
+    };
+    for (const Codec& codec : codecs) {
+        for (size_t size : {64, 256, 4096}) {
+            run(codec, size, false);
+            run(codec, size, true);
+        }
+    }
+    return 0;
+}
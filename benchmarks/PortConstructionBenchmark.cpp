@@ -0,0 +1,72 @@
+//
+//  PortConstructionBenchmark.cpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+//  Measures concurrent HSerialPort construction, which looks up (or creates) the device in the
+//  ports manager's sharded registry. Each thread constructs ports for a shared set of names, so
+//  the first round creates the devices and the rest are lookups. Nothing is opened, so the names
+//  don't need to exist. Build from this directory with, e.g.:
+//
+//      g++ -std=c++11 -O2 -pthread -I.. ../*.cpp PortConstructionBenchmark.cpp -lserial -o PortConstructionBenchmark
+//
+//  Run with the number of threads as the argument (the default is the hardware concurrency).
+//
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "HSerialPort.hpp"
+
+using namespace hserial;
+
+namespace {
+
+    const size_t numNames = 4000;
+    const size_t numRounds = 50;
+
+    double run(const std::vector<std::string>& names, size_t numThreads) {
+        std::atomic_bool start(false);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < numThreads; ++t) {
+            threads.emplace_back([&names, &start, t]() {
+                while (!start) std::this_thread::yield();
+                // Each thread starts at a different name, so they don't move in lockstep.
+                size_t offset = t * 997;
+                for (size_t round = 0; round < numRounds; ++round) {
+                    for (size_t i = 0; i < names.size(); ++i) {
+                        HSerialPort port(names[(i + offset) % names.size()]);
+                        (void)port;
+                    }
+                }
+            });
+        }
+        auto begin = std::chrono::steady_clock::now();
+        start = true;
+        for (std::thread& thread : threads) thread.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        return double(numThreads * numRounds * names.size()) / seconds;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t maxThreads = argc > 1 ? size_t(std::atoi(argv[1])) : size_t(std::thread::hardware_concurrency());
+    if (maxThreads == 0) maxThreads = 1;
+
+    std::vector<std::string> names;
+    for (size_t i = 0; i < numNames; ++i) {
+        names.push_back("/dev/ttyBENCH" + std::to_string(i));
+    }
+
+    for (size_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+        std::printf("%3zu threads: %10.0f constructions/s\n", numThreads, run(names, numThreads));
+    }
+    return 0;
+}
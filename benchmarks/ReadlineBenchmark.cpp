@@ -0,0 +1,109 @@
+//
+//  ReadlineBenchmark.cpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+//  Compares HSerial's chunked readline with reading a byte at a time (which is what
+//  serial::Serial::readline does) on a pseudoterminal pair. Build from this directory with,
+//  e.g.:
+//
+//      g++ -std=c++11 -O2 -pthread -I.. ../*.cpp ReadlineBenchmark.cpp -lserial -o ReadlineBenchmark
+//
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "HSerial.hpp"
+#include "HSerialPortsManager.hpp"
+#include "HSerialPtyTransport.hpp"
+
+using namespace hserial;
+
+namespace {
+
+    const size_t numLines = 200000;
+    const size_t lineLength = 64; // including the eol
+
+    // Writes the lines to the slave side, as the device would.
+    void writeLines(const std::string& slavePath) {
+        int fd = open(slavePath.c_str(), O_RDWR | O_NOCTTY);
+        if (fd < 0) {
+            perror("open");
+            return;
+        }
+        termios attributes;
+        tcgetattr(fd, &attributes);
+        cfmakeraw(&attributes);
+        tcsetattr(fd, TCSANOW, &attributes);
+
+        std::string line(lineLength - 1, 'x');
+        line += '\n';
+        std::string block;
+        for (size_t i = 0; i < 64; ++i) block += line;
+        for (size_t i = 0; i < numLines / 64; ++i) {
+            size_t written = 0;
+            while (written < block.size()) {
+                ssize_t count = write(fd, block.data() + written, block.size() - written);
+                if (count <= 0) break;
+                written += size_t(count);
+            }
+        }
+        close(fd);
+    }
+
+    double run(HSerial& serial, const std::string& slavePath, bool byteAtATime) {
+        serial.flushInput();
+        std::thread writer(writeLines, slavePath);
+        auto start = std::chrono::steady_clock::now();
+        size_t lines = 0;
+        std::string line;
+        while (lines < numLines / 64 * 64) {
+            if (byteAtATime) {
+                uint8_t byte = 0;
+                line.clear();
+                while (byte != '\n' && serial.read(&byte, 1) == 1) line += char(byte);
+            } else {
+                line.clear();
+                serial.readline(line);
+            }
+            if (line.empty()) break;
+            lines += 1;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        writer.join();
+        return double(lines * lineLength) / seconds / 1e6;
+    }
+}
+
+int main() {
+    std::string linkPath = "/tmp/hserial-readline-benchmark-" + std::to_string(getpid());
+    HSerialPortsManager::getInstance().registerTransport("bench", HSerialPtyTransport::factory(linkPath));
+
+    HSerial serial("bench");
+    serial.makeActive();
+    serial::Timeout timeout = serial::Timeout::simpleTimeout(1000);
+    serial.setTimeout(timeout);
+    serial.open();
+
+    double byteRate = run(serial, linkPath, true);
+    double chunkRate = run(serial, linkPath, false);
+    serial.enableReadBuffering(1 << 16);
+    double pumpRate = run(serial, linkPath, false);
+
+    std::printf("%zu lines of %zu bytes\n", numLines, lineLength);
+    std::printf("byte at a time:          %8.1f MB/s\n", byteRate);
+    std::printf("readline:                %8.1f MB/s\n", chunkRate);
+    std::printf("readline, read buffering: %7.1f MB/s\n", pumpRate);
+
+    serial.close();
+    serial.makeInactive();
+    return 0;
+}
@@ -0,0 +1,112 @@
+//
+//  TransitionCoalescingBenchmark.cpp
+//  HSerial
+//
+//  Created by admin on 10/16/26.
+//  Copyright © 2026 Chris Siedell. All rights reserved.
+//
+//  A ping-pong benchmark for transition coalescing (see HSerialPort::setTransitionCoalescing).
+//  Several controllers on one port repeatedly call makeActive and, if they got the port, make a
+//  couple of access calls. Each deactivation costs a little time (as a controller finishing its
+//  work in willMakeInactive would), so requests pile up in the transition queue. Build from this
+//  directory with, e.g.:
+//
+//      g++ -std=c++11 -O2 -pthread -I.. ../*.cpp TransitionCoalescingBenchmark.cpp -lserial -o TransitionCoalescingBenchmark
+//
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "HSerial.hpp"
+#include "HSerialExceptions.hpp"
+#include "HSerialLoopbackTransport.hpp"
+#include "HSerialPort.hpp"
+#include "HSerialPortsManager.hpp"
+
+using namespace hserial;
+
+namespace {
+
+    const size_t numControllers = 8;
+    const std::chrono::milliseconds runTime(2000);
+    const std::chrono::microseconds deactivationCost(50);
+
+    std::atomic<uint64_t> numTransitions(0);
+
+    class PingPongController : public HSerial {
+    public:
+        PingPongController() : HSerial("bench") {}
+    protected:
+        void willMakeActive() noexcept override {
+            numTransitions++;
+            HSerial::willMakeActive();
+        }
+        void willMakeInactive() override {
+            std::this_thread::sleep_for(deactivationCost);
+            HSerial::willMakeInactive();
+        }
+    };
+
+    void run(HSerialPort& port, bool isCoalescing) {
+        port.setTransitionCoalescing(isCoalescing);
+        std::vector<std::unique_ptr<PingPongController>> controllers;
+        for (size_t i = 0; i < numControllers; ++i) {
+            controllers.emplace_back(new PingPongController());
+        }
+
+        numTransitions = 0;
+        std::atomic_bool stop(false);
+        std::atomic<uint64_t> numRequests(0), numSkipped(0), numUses(0);
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < numControllers; ++i) {
+            PingPongController& controller = *controllers[i];
+            threads.emplace_back([&]() {
+                while (!stop) {
+                    if (controller.isActive()) {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    numRequests++;
+                    try {
+                        controller.makeActive();
+                    } catch (const ActivationSuperseded&) {
+                        numSkipped++;
+                        continue;
+                    }
+                    try {
+                        controller.isOpen();
+                        controller.available();
+                        numUses++;
+                    } catch (const NotActiveController&) {
+                        // Lost the port already.
+                    }
+                }
+            });
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::this_thread::sleep_for(runTime);
+        stop = true;
+        for (std::thread& thread : threads) thread.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::printf("coalescing %s: %8.0f requests/s, %8.0f transitions/s, %8.0f skipped/s, %8.0f port uses/s\n",
+                    isCoalescing ? "on " : "off", numRequests / seconds, numTransitions / seconds, numSkipped / seconds, numUses / seconds);
+
+        for (auto& controller : controllers) {
+            controller->makeInactive();
+        }
+    }
+}
+
+int main() {
+    HSerialPortsManager::getInstance().registerTransport("bench", HSerialLoopbackTransport::factory());
+    HSerialPort port("bench");
+    run(port, false);
+    run(port, true);
+    return 0;
+}